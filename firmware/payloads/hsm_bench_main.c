@@ -0,0 +1,149 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * HART bring-up benchmark payload
+ *
+ * The boot HART repeatedly starts all other HARTs and waits until each
+ * of them reached the payload, once with one HSM HART start call per
+ * HART and once with the OpenSBI specific HSM HART start many call per
+ * group of XLEN HARTs. Started HARTs check in and stop themselves again
+ * right away. The average bring-up time of both ways is printed for
+ * scripts/hsm_bench.sh.
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#include <sbi/sbi_ecall_interface.h>
+#include "smp_test.h"
+
+#define HSM_BENCH_ROUNDS	20
+
+static unsigned long hsm_bench_arrived;
+
+static struct sbiret hsm_bench_start_many(unsigned long hmask,
+					  unsigned long hbase,
+					  const unsigned long *arg1s)
+{
+	register unsigned long a0 asm("a0") = hmask;
+	register unsigned long a1 asm("a1") = hbase;
+	register unsigned long a2 asm("a2") = (unsigned long)_start_secondary;
+	register unsigned long a3 asm("a3") = (unsigned long)arg1s;
+	register unsigned long a4 asm("a4") = 0;
+	register unsigned long a6 asm("a6") = SBI_EXT_OPENSBI_HSM_HART_START_MANY;
+	register unsigned long a7 asm("a7") = SBI_EXT_OPENSBI;
+
+	asm volatile("ecall"
+		     : "+r"(a0), "+r"(a1)
+		     : "r"(a2), "r"(a3), "r"(a4), "r"(a6), "r"(a7)
+		     : "memory");
+
+	return (struct sbiret){ .error = a0, .value = a1 };
+}
+
+/* Wait until all started HARTs checked in and stopped again */
+static void hsm_bench_wait(unsigned long hartid, const unsigned long *mask,
+			   unsigned long count)
+{
+	unsigned long i;
+	struct sbiret ret;
+
+	while (__atomic_load_n(&hsm_bench_arrived, __ATOMIC_ACQUIRE) < count)
+		;
+
+	for (i = 0; i < SMP_TEST_MAX_HARTS; i++) {
+		if (i == hartid ||
+		    !((mask[i / __riscv_xlen] >> (i % __riscv_xlen)) & 1))
+			continue;
+		do {
+			ret = SBI_ECALL(SBI_EXT_HSM,
+					SBI_EXT_HSM_HART_GET_STATUS, i, 0, 0);
+		} while (!ret.error && ret.value != SBI_HSM_STATE_STOPPED);
+	}
+
+	__atomic_store_n(&hsm_bench_arrived, 0, __ATOMIC_RELAXED);
+}
+
+/* Bring-up time of all HARTs with one start call per HART */
+static u64 hsm_bench_single(unsigned long hartid, const unsigned long *mask,
+			    unsigned long count)
+{
+	unsigned long i;
+	u64 start;
+
+	start = smp_time();
+	for (i = 0; i < SMP_TEST_MAX_HARTS; i++) {
+		if (i == hartid ||
+		    !((mask[i / __riscv_xlen] >> (i % __riscv_xlen)) & 1))
+			continue;
+		SBI_ECALL(SBI_EXT_HSM, SBI_EXT_HSM_HART_START,
+			  i, _start_secondary, 0);
+	}
+	while (__atomic_load_n(&hsm_bench_arrived, __ATOMIC_ACQUIRE) < count)
+		;
+
+	return smp_time() - start;
+}
+
+/* Bring-up time of all HARTs with one start many call per XLEN HARTs */
+static u64 hsm_bench_many(unsigned long hartid, const unsigned long *mask,
+			  unsigned long count)
+{
+	unsigned long arg1s[__riscv_xlen] = { 0 };
+	unsigned long base, hmask;
+	u64 start;
+
+	start = smp_time();
+	for (base = 0; base < SMP_TEST_MAX_HARTS; base += __riscv_xlen) {
+		hmask = mask[base / __riscv_xlen];
+		if (base <= hartid && hartid < base + __riscv_xlen)
+			hmask &= ~(1UL << (hartid - base));
+		if (hmask)
+			hsm_bench_start_many(hmask, base, arg1s);
+	}
+	while (__atomic_load_n(&hsm_bench_arrived, __ATOMIC_ACQUIRE) < count)
+		;
+
+	return smp_time() - start;
+}
+
+void smp_secondary(unsigned long hartid, unsigned long arg)
+{
+	__atomic_add_fetch(&hsm_bench_arrived, 1, __ATOMIC_RELEASE);
+
+	SBI_ECALL(SBI_EXT_HSM, SBI_EXT_HSM_HART_STOP, 0, 0, 0);
+
+	smp_hang();
+}
+
+void smp_main(unsigned long hartid, unsigned long fdt)
+{
+	unsigned long mask[SMP_TEST_MAX_HARTS / __riscv_xlen];
+	unsigned long i, count;
+	u64 single = 0, many = 0;
+	char line[96], *p;
+
+	/* The first bring-up finds the HARTs and is not measured */
+	count = smp_start_harts(hartid, 0, mask) - 1;
+	hsm_bench_wait(hartid, mask, count);
+
+	for (i = 0; i < HSM_BENCH_ROUNDS; i++) {
+		single += hsm_bench_single(hartid, mask, count);
+		hsm_bench_wait(hartid, mask, count);
+		many += hsm_bench_many(hartid, mask, count);
+		hsm_bench_wait(hartid, mask, count);
+	}
+
+	p = smp_put_str(line, "hsm bench: ");
+	p = smp_put_num(p, count, 1);
+	p = smp_put_str(p, " harts single ");
+	p = smp_put_num(p, single / HSM_BENCH_ROUNDS, 1);
+	p = smp_put_str(p, " ticks many ");
+	p = smp_put_num(p, many / HSM_BENCH_ROUNDS, 1);
+	p = smp_put_str(p, " ticks\n");
+	smp_write(line, p - line);
+
+	smp_shutdown();
+}
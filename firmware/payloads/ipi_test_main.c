@@ -0,0 +1,162 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * IPI delivery test payload
+ *
+ * Every HART sends an IPI to every other HART in each round, both as
+ * single target and as multicast IPIs, and then waits until all IPIs of
+ * the round aimed at itself were delivered. A sender counts each event
+ * in the pending counter of the target before sending the IPI, and the
+ * target reads the counter after clearing sip.SSIP. The target thus sees
+ * every event unless an IPI sent after the count was lost, which is
+ * reported after a timeout. The outcome is checked by
+ * scripts/ipi_test.sh.
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#include <sbi/riscv_asm.h>
+#include <sbi/riscv_encoding.h>
+#include <sbi/sbi_ecall_interface.h>
+#include "smp_test.h"
+
+#define IPI_TEST_ROUNDS		200
+
+/* Ten seconds of the 10 MHz timer of QEMU virt */
+#define IPI_TEST_TIMEOUT	100000000ULL
+
+static unsigned long ipi_test_mask[SMP_TEST_MAX_HARTS / __riscv_xlen];
+static unsigned long ipi_test_harts;
+static unsigned long ipi_test_go;
+static unsigned long ipi_test_pending[SMP_TEST_MAX_HARTS];
+static unsigned long ipi_test_done;
+static unsigned long ipi_test_failed;
+
+static bool ipi_test_running(unsigned long hartid)
+{
+	return (ipi_test_mask[hartid / __riscv_xlen] >>
+		(hartid % __riscv_xlen)) & 1;
+}
+
+/* Number of events delivered to the calling HART so far */
+static unsigned long ipi_test_poll(unsigned long hartid, unsigned long seen)
+{
+	if (!(csr_read(CSR_SIP) & SIP_SSIP))
+		return seen;
+
+	csr_clear(CSR_SIP, SIP_SSIP);
+	return __atomic_load_n(&ipi_test_pending[hartid], __ATOMIC_ACQUIRE);
+}
+
+static void ipi_test_send(unsigned long hartid, unsigned long round)
+{
+	unsigned long i, base, mask;
+
+	if (round & 1) {
+		/* One multicast IPI per group of XLEN HARTs */
+		for (base = 0; base < SMP_TEST_MAX_HARTS;
+		     base += __riscv_xlen) {
+			mask = ipi_test_mask[base / __riscv_xlen];
+			if (base <= hartid && hartid < base + __riscv_xlen)
+				mask &= ~(1UL << (hartid - base));
+			if (!mask)
+				continue;
+			for (i = 0; i < __riscv_xlen; i++) {
+				if ((mask >> i) & 1)
+					__atomic_add_fetch(
+						&ipi_test_pending[base + i], 1,
+						__ATOMIC_RELEASE);
+			}
+			SBI_ECALL(SBI_EXT_IPI, SBI_EXT_IPI_SEND_IPI,
+				  mask, base, 0);
+		}
+		return;
+	}
+
+	/* One IPI per target HART */
+	for (i = 0; i < SMP_TEST_MAX_HARTS; i++) {
+		if (i == hartid || !ipi_test_running(i))
+			continue;
+		__atomic_add_fetch(&ipi_test_pending[i], 1, __ATOMIC_RELEASE);
+		SBI_ECALL(SBI_EXT_IPI, SBI_EXT_IPI_SEND_IPI, 1, i, 0);
+	}
+}
+
+static unsigned long ipi_test_run(unsigned long hartid)
+{
+	unsigned long round, seen = 0, need;
+	char line[80], *p;
+	u64 start;
+
+	while (!__atomic_load_n(&ipi_test_go, __ATOMIC_ACQUIRE))
+		;
+
+	for (round = 1; round <= IPI_TEST_ROUNDS; round++) {
+		ipi_test_send(hartid, round);
+
+		/* Every other HART sends one event per round */
+		need = round * (ipi_test_harts - 1);
+		start = smp_time();
+		while ((seen = ipi_test_poll(hartid, seen)) < need) {
+			if (smp_time() - start < IPI_TEST_TIMEOUT)
+				continue;
+
+			p = smp_put_str(line, "ipi test: hart ");
+			p = smp_put_num(p, hartid, 2);
+			p = smp_put_str(p, " lost wakeup in round ");
+			p = smp_put_num(p, round, 1);
+			p = smp_put_str(p, " (");
+			p = smp_put_num(p, seen, 1);
+			p = smp_put_str(p, " of ");
+			p = smp_put_num(p, need, 1);
+			p = smp_put_str(p, " events)\n");
+			smp_write(line, p - line);
+
+			__atomic_add_fetch(&ipi_test_failed, 1,
+					   __ATOMIC_RELAXED);
+			goto done;
+		}
+	}
+
+done:
+	__atomic_add_fetch(&ipi_test_done, 1, __ATOMIC_RELEASE);
+
+	return seen;
+}
+
+void smp_secondary(unsigned long hartid, unsigned long arg)
+{
+	unsigned long seen = ipi_test_run(hartid);
+
+	/* Keep taking IPIs of slower HARTs */
+	while (1)
+		seen = ipi_test_poll(hartid, seen);
+}
+
+void smp_main(unsigned long hartid, unsigned long fdt)
+{
+	unsigned long seen;
+	char line[80], *p;
+
+	/* IPIs are polled in sip with all interrupts disabled in sie */
+	ipi_test_harts = smp_start_harts(hartid, 0, ipi_test_mask);
+	__atomic_store_n(&ipi_test_go, 1, __ATOMIC_RELEASE);
+
+	seen = ipi_test_run(hartid);
+	while (__atomic_load_n(&ipi_test_done, __ATOMIC_ACQUIRE) <
+	       ipi_test_harts)
+		seen = ipi_test_poll(hartid, seen);
+
+	p = smp_put_str(line, "ipi test: ");
+	p = smp_put_num(p, ipi_test_harts, 2);
+	p = smp_put_str(p, " harts ");
+	p = smp_put_num(p, IPI_TEST_ROUNDS, 1);
+	p = smp_put_str(p, " rounds ");
+	p = smp_put_str(p, ipi_test_failed ? "FAILED\n" : "passed\n");
+	smp_write(line, p - line);
+
+	smp_shutdown();
+}
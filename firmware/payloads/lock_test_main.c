@@ -0,0 +1,109 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Spinlock contention test payload
+ *
+ * The boot HART starts all other HARTs and then every HART writes lines
+ * to the debug console as fast as it can. OpenSBI writes each line while
+ * holding its console spinlock so all HARTs keep contending for the same
+ * lock. A broken lock shows up as mixed up lines or as a hang, which is
+ * checked by scripts/lock_test.sh.
+ *
+ * All HARTs then take the console spinlock together with empty console
+ * writes, which hold the lock only briefly, and the boot HART reports
+ * the time taken so that the MCS and the ticket spinlock can be compared
+ * for different numbers of HARTs.
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#include <sbi/sbi_ecall_interface.h>
+#include "smp_test.h"
+
+#define LOCK_TEST_LINES		500
+#define LOCK_TEST_ROUNDS	2000
+
+static unsigned long lock_test_started;
+static unsigned long lock_test_done;
+static unsigned long lock_test_ready;
+static unsigned long lock_test_go;
+static unsigned long lock_test_bench_done;
+
+static void lock_test_run(unsigned long hartid)
+{
+	char line[80], *p;
+	unsigned long i;
+
+	for (i = 0; i < LOCK_TEST_LINES; i++) {
+		p = smp_put_str(line, "lock test: hart ");
+		p = smp_put_num(p, hartid, 2);
+		p = smp_put_str(p, " line ");
+		p = smp_put_num(p, i, 4);
+		p = smp_put_str(p, " abcdefghijklmnopqrstuvwxyz\n");
+		smp_write(line, p - line);
+	}
+
+	__atomic_add_fetch(&lock_test_done, 1, __ATOMIC_RELEASE);
+}
+
+static void lock_test_bench(void)
+{
+	unsigned long i;
+
+	for (i = 0; i < LOCK_TEST_ROUNDS; i++)
+		SBI_ECALL(SBI_EXT_DBCN, SBI_EXT_DBCN_CONSOLE_WRITE,
+			  0, &lock_test_go, 0);
+
+	__atomic_add_fetch(&lock_test_bench_done, 1, __ATOMIC_RELEASE);
+}
+
+static void lock_test_wait(unsigned long *count, unsigned long val)
+{
+	while (__atomic_load_n(count, __ATOMIC_ACQUIRE) < val)
+		;
+}
+
+void smp_secondary(unsigned long hartid, unsigned long arg)
+{
+	lock_test_run(hartid);
+
+	__atomic_add_fetch(&lock_test_ready, 1, __ATOMIC_RELEASE);
+	lock_test_wait(&lock_test_go, 1);
+	lock_test_bench();
+
+	smp_hang();
+}
+
+void smp_main(unsigned long hartid, unsigned long fdt)
+{
+	unsigned long mask[SMP_TEST_MAX_HARTS / __riscv_xlen];
+	char line[80], *p;
+	u64 start, ticks;
+
+	lock_test_started = smp_start_harts(hartid, 0, mask);
+
+	lock_test_run(hartid);
+	lock_test_wait(&lock_test_done, lock_test_started);
+
+	/* All HARTs start taking the lock at the same time */
+	lock_test_wait(&lock_test_ready, lock_test_started - 1);
+	start = smp_time();
+	__atomic_store_n(&lock_test_go, 1, __ATOMIC_RELEASE);
+	lock_test_bench();
+	lock_test_wait(&lock_test_bench_done, lock_test_started);
+	ticks = smp_time() - start;
+
+	p = smp_put_str(line, "lock test: ");
+	p = smp_put_num(p, lock_test_started, 1);
+	p = smp_put_str(p, " harts done ");
+	p = smp_put_num(p, LOCK_TEST_ROUNDS, 1);
+	p = smp_put_str(p, " rounds ");
+	p = smp_put_num(p, ticks, 1);
+	p = smp_put_str(p, " ticks\n");
+	smp_write(line, p - line);
+
+	smp_shutdown();
+}
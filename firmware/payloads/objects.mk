@@ -17,3 +17,40 @@ test-y += test_main.o
 
 %/test.dep: $(foreach dep,$(test-y:.o=.dep),%/$(dep))
 	$(call merge_deps,$@,$^)
+
+# SMP test payloads for QEMU virt, see scripts/lock_test.sh and friends
+smp-test-y += smp_head.o
+smp-test-y += smp_lib.o
+
+firmware-bins-$(FW_PAYLOAD) += payloads/lock_test.bin
+
+lock_test-y += $(smp-test-y)
+lock_test-y += lock_test_main.o
+
+%/lock_test.o: $(foreach obj,$(lock_test-y),%/$(obj))
+	$(call merge_objs,$@,$^)
+
+%/lock_test.dep: $(foreach dep,$(lock_test-y:.o=.dep),%/$(dep))
+	$(call merge_deps,$@,$^)
+
+firmware-bins-$(FW_PAYLOAD) += payloads/ipi_test.bin
+
+ipi_test-y += $(smp-test-y)
+ipi_test-y += ipi_test_main.o
+
+%/ipi_test.o: $(foreach obj,$(ipi_test-y),%/$(obj))
+	$(call merge_objs,$@,$^)
+
+%/ipi_test.dep: $(foreach dep,$(ipi_test-y:.o=.dep),%/$(dep))
+	$(call merge_deps,$@,$^)
+
+firmware-bins-$(FW_PAYLOAD) += payloads/hsm_bench.bin
+
+hsm_bench-y += $(smp-test-y)
+hsm_bench-y += hsm_bench_main.o
+
+%/hsm_bench.o: $(foreach obj,$(hsm_bench-y),%/$(obj))
+	$(call merge_objs,$@,$^)
+
+%/hsm_bench.dep: $(foreach dep,$(hsm_bench-y:.o=.dep),%/$(dep))
+	$(call merge_deps,$@,$^)
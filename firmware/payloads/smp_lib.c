@@ -0,0 +1,111 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Helpers shared by the SMP test payloads
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#include <sbi/riscv_asm.h>
+#include <sbi/riscv_encoding.h>
+#include <sbi/sbi_ecall_interface.h>
+#include "smp_test.h"
+
+unsigned char smp_stacks[SMP_TEST_MAX_HARTS << SMP_TEST_STACK_SHIFT]
+	__aligned(16);
+
+unsigned long smp_start_harts(unsigned long hartid, unsigned long arg,
+			      unsigned long *mask)
+{
+	unsigned long i, count = 1;
+	struct sbiret ret;
+
+	for (i = 0; i < SMP_TEST_MAX_HARTS; i++)
+		mask[i / __riscv_xlen] = 0;
+	mask[hartid / __riscv_xlen] |= 1UL << (hartid % __riscv_xlen);
+
+	for (i = 0; i < SMP_TEST_MAX_HARTS; i++) {
+		if (i == hartid)
+			continue;
+		ret = SBI_ECALL(SBI_EXT_HSM, SBI_EXT_HSM_HART_START,
+				i, _start_secondary, arg);
+		if (ret.error)
+			continue;
+		mask[i / __riscv_xlen] |= 1UL << (i % __riscv_xlen);
+		count++;
+	}
+
+	return count;
+}
+
+u64 smp_time(void)
+{
+#if __riscv_xlen == 32
+	u32 hi, lo;
+
+	do {
+		hi = csr_read(CSR_TIMEH);
+		lo = csr_read(CSR_TIME);
+	} while (hi != csr_read(CSR_TIMEH));
+
+	return ((u64)hi << 32) | lo;
+#else
+	return csr_read(CSR_TIME);
+#endif
+}
+
+void smp_write(const char *str, unsigned long len)
+{
+	struct sbiret ret;
+
+	while (len) {
+		ret = SBI_ECALL(SBI_EXT_DBCN, SBI_EXT_DBCN_CONSOLE_WRITE,
+				len, str, 0);
+		if (ret.error)
+			return;
+		str += ret.value;
+		len -= ret.value;
+	}
+}
+
+char *smp_put_str(char *p, const char *str)
+{
+	while (*str)
+		*p++ = *str++;
+
+	return p;
+}
+
+char *smp_put_num(char *p, u64 num, int digits)
+{
+	char tmp[20];
+	int i = 0;
+
+	do {
+		tmp[i++] = '0' + num % 10;
+		num /= 10;
+	} while (num);
+	while (i < digits--)
+		*p++ = '0';
+	while (i)
+		*p++ = tmp[--i];
+
+	return p;
+}
+
+void smp_shutdown(void)
+{
+	SBI_ECALL(SBI_EXT_SRST, SBI_EXT_SRST_RESET,
+		  SBI_SRST_RESET_TYPE_SHUTDOWN, SBI_SRST_RESET_REASON_NONE, 0);
+
+	smp_hang();
+}
+
+void smp_hang(void)
+{
+	while (1)
+		wfi();
+}
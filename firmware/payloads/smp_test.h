@@ -0,0 +1,95 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Helpers shared by the SMP test payloads
+ *
+ * The boot HART enters smp_main() and every HART it starts with
+ * smp_start_harts() enters smp_secondary(), both with the HART ID and
+ * the start argument in a0 and a1.
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#ifndef __SMP_TEST_H__
+#define __SMP_TEST_H__
+
+/** Highest HART ID plus one that the payloads can run on */
+#define SMP_TEST_MAX_HARTS	128
+
+/** Stack size of each HART as a power of two */
+#define SMP_TEST_STACK_SHIFT	12
+
+#ifndef __ASSEMBLER__
+
+#include <sbi/sbi_types.h>
+
+struct sbiret {
+	long error;
+	long value;
+};
+
+#define SBI_ECALL(__eid, __fid, __a0, __a1, __a2)                             \
+	({                                                                    \
+		register unsigned long a0 asm("a0") = (unsigned long)(__a0);  \
+		register unsigned long a1 asm("a1") = (unsigned long)(__a1);  \
+		register unsigned long a2 asm("a2") = (unsigned long)(__a2);  \
+		register unsigned long a6 asm("a6") = (unsigned long)(__fid); \
+		register unsigned long a7 asm("a7") = (unsigned long)(__eid); \
+		asm volatile("ecall"                                          \
+			     : "+r"(a0), "+r"(a1)                             \
+			     : "r"(a2), "r"(a6), "r"(a7)                      \
+			     : "memory");                                     \
+		(struct sbiret){ .error = a0, .value = a1 };                  \
+	})
+
+#define wfi()                                             \
+	do {                                              \
+		__asm__ __volatile__("wfi" ::: "memory"); \
+	} while (0)
+
+/** Entry of HARTs started by smp_start_harts() */
+extern char _start_secondary[];
+
+/** Test entry of the boot HART */
+void smp_main(unsigned long hartid, unsigned long arg);
+
+/** Test entry of the other HARTs */
+void smp_secondary(unsigned long hartid, unsigned long arg);
+
+/**
+ * Start all HARTs except the calling one at smp_secondary()
+ *
+ * @param hartid HART ID of the calling HART
+ * @param arg argument passed to smp_secondary()
+ * @param mask bitmap of SMP_TEST_MAX_HARTS bits set for every HART
+ * running the payload, including the calling HART
+ *
+ * @return number of HARTs running the payload, including the calling HART
+ */
+unsigned long smp_start_harts(unsigned long hartid, unsigned long arg,
+			      unsigned long *mask);
+
+/** Read the time CSR */
+u64 smp_time(void);
+
+/** Write a string to the debug console in one piece if possible */
+void smp_write(const char *str, unsigned long len);
+
+/** Append a string and return the end of the output */
+char *smp_put_str(char *p, const char *str);
+
+/** Append a decimal number of at least digits digits */
+char *smp_put_num(char *p, u64 num, int digits);
+
+/** Power off the machine */
+void __noreturn smp_shutdown(void);
+
+/** Wait for interrupts forever */
+void __noreturn smp_hang(void);
+
+#endif
+
+#endif
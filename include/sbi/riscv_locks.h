@@ -8,8 +8,21 @@
 #ifndef __RISCV_LOCKS_H__
 #define __RISCV_LOCKS_H__
 
+#include <sbi/riscv_atomic.h>
 #include <sbi/sbi_types.h>
 
+#ifdef CONFIG_SBI_MCS_SPINLOCK
+
+typedef struct {
+	/* Queue node of the last HART in the queue or 0 if unlocked */
+	atomic_t tail;
+} spinlock_t;
+
+#define __SPIN_LOCK_UNLOCKED	\
+	(spinlock_t) { ATOMIC_INITIALIZER(0) }
+
+#else
+
 #define TICKET_SHIFT	16
 
 typedef struct {
@@ -25,6 +38,8 @@ typedef struct {
 #define __SPIN_LOCK_UNLOCKED	\
 	(spinlock_t) { 0, 0 }
 
+#endif
+
 #define SPIN_LOCK_INIT(x)	\
 	x = __SPIN_LOCK_UNLOCKED
 
@@ -89,7 +89,7 @@ struct sbi_domain_memregion {
 };
 
 /** Maximum number of domains */
-#define SBI_DOMAIN_MAX_INDEX			32
+#define SBI_DOMAIN_MAX_INDEX			CONFIG_SBI_DOMAIN_MAX_COUNT
 
 /** Representation of OpenSBI domain */
 struct sbi_domain {
@@ -122,6 +122,10 @@ struct sbi_domain {
 	bool system_reset_allowed;
 	/** Is domain allowed to suspend the system */
 	bool system_suspend_allowed;
+	/** Is domain allowed to delegate emulated traps to S-mode */
+	bool trap_delegation_allowed;
+	/** Is domain allowed to switch its HARTs to other domains */
+	bool domain_switch_allowed;
 	/** Identifies whether to include the firmware region */
 	bool fw_region_inited;
 };
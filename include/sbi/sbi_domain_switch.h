@@ -0,0 +1,73 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Runtime switching of HARTs between domains
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#ifndef __SBI_DOMAIN_SWITCH_H__
+#define __SBI_DOMAIN_SWITCH_H__
+
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_types.h>
+
+struct sbi_trap_regs;
+
+#ifdef CONFIG_SBI_DOMAIN_SWITCH
+
+/**
+ * Initialize domain switching
+ *
+ * @param cold_boot true if cold booting
+ *
+ * @return 0 on success and negative error code on failure
+ */
+int sbi_domain_switch_init(bool cold_boot);
+
+/**
+ * Switch the current HART to another domain
+ *
+ * The S-mode context of the current domain is saved and the S-mode
+ * context last saved for the target domain is restored, including the
+ * S-mode timer and the firmware features. A HART entering a domain for
+ * the first time starts at the next address of the domain which is only
+ * allowed while no other HART runs in the target domain or holds a saved
+ * context of it. FP and vector
+ * registers are cleared instead of being preserved. The PMP entries of
+ * the target domain come from a PMP image prepared once per domain.
+ *
+ * The trap registers are replaced afterwards by sbi_domain_switch_jump().
+ *
+ * @param regs trap registers of the calling HART
+ * @param dom_index index of the target domain
+ *
+ * @return SBI_EJUMP on success and negative error code on failure
+ */
+int sbi_domain_switch(const struct sbi_trap_regs *regs, u32 dom_index);
+
+/**
+ * Replace the trap registers after a successful sbi_domain_switch()
+ *
+ * @param regs trap registers of the calling HART
+ */
+void sbi_domain_switch_jump(struct sbi_trap_regs *regs);
+
+#else
+
+static inline int sbi_domain_switch_init(bool cold_boot) { return 0; }
+
+static inline int sbi_domain_switch(const struct sbi_trap_regs *regs,
+				    u32 dom_index)
+{
+	return SBI_ENOTSUPP;
+}
+
+static inline void sbi_domain_switch_jump(struct sbi_trap_regs *regs) { }
+
+#endif
+
+#endif
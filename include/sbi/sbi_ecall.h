@@ -29,6 +29,12 @@ struct sbi_ecall_extension {
 		       const struct sbi_trap_regs *regs,
 		       unsigned long *out_val,
 		       struct sbi_trap_info *out_trap);
+	/*
+	 * Called when handle() returns SBI_EJUMP to replace the trap
+	 * registers before returning to them.
+	 */
+	void (* jump)(unsigned long extid, unsigned long funcid,
+		      struct sbi_trap_regs *regs);
 };
 
 u16 sbi_ecall_version_major(void);
@@ -32,6 +32,8 @@
 #define SBI_EXT_DBCN				0x4442434E
 #define SBI_EXT_SUSP				0x53555350
 #define SBI_EXT_CPPC				0x43505043
+#define SBI_EXT_FWFT				0x46574654
+#define SBI_EXT_OPENSBI				0x0A000001
 
 /* SBI function IDs for BASE extension*/
 #define SBI_EXT_BASE_GET_SPEC_VERSION		0x0
@@ -199,6 +201,45 @@ enum sbi_pmu_fw_event_code_id {
 	SBI_PMU_FW_PLATFORM = 0xFFFF,
 };
 
+/**
+ * OpenSBI specific firmware events which count the time spent by a hart
+ * in M-mode. These are encoded at the top of the range of SBI
+ * implementation specific custom firmware events, away from event codes
+ * which future SBI versions may allocate, as SBI_PMU_FW_MMODE_CYCLES(class)
+ * for cycles and SBI_PMU_FW_MMODE_INSTRET(class) for retired instructions.
+ */
+enum sbi_pmu_mmode_class {
+	SBI_PMU_MMODE_ALL		= 0,
+	SBI_PMU_MMODE_ECALL_BASE	= 1,
+	SBI_PMU_MMODE_ECALL_TIME	= 2,
+	SBI_PMU_MMODE_ECALL_IPI		= 3,
+	SBI_PMU_MMODE_ECALL_RFENCE	= 4,
+	SBI_PMU_MMODE_ECALL_HSM		= 5,
+	SBI_PMU_MMODE_ECALL_SRST	= 6,
+	SBI_PMU_MMODE_ECALL_PMU		= 7,
+	SBI_PMU_MMODE_ECALL_DBCN	= 8,
+	SBI_PMU_MMODE_ECALL_SUSP	= 9,
+	SBI_PMU_MMODE_ECALL_CPPC	= 10,
+	SBI_PMU_MMODE_ECALL_LEGACY	= 11,
+	SBI_PMU_MMODE_ECALL_VENDOR	= 12,
+	SBI_PMU_MMODE_ECALL_OTHER	= 13,
+	SBI_PMU_MMODE_IRQ_TIMER		= 14,
+	SBI_PMU_MMODE_IRQ_IPI		= 15,
+	SBI_PMU_MMODE_IRQ_EXT		= 16,
+	SBI_PMU_MMODE_EMUL_ILLEGAL_INSN	= 17,
+	SBI_PMU_MMODE_EMUL_MISALIGNED_LOAD = 18,
+	SBI_PMU_MMODE_EMUL_MISALIGNED_STORE = 19,
+	SBI_PMU_MMODE_REDIRECT		= 20,
+	SBI_PMU_MMODE_CLASS_MAX,
+};
+
+#define SBI_PMU_FW_MMODE_CYCLES_BASE	0xFF00
+#define SBI_PMU_FW_MMODE_INSTRET_BASE	0xFF80
+#define SBI_PMU_FW_MMODE_CYCLES(__class)	\
+	(SBI_PMU_FW_MMODE_CYCLES_BASE + (__class))
+#define SBI_PMU_FW_MMODE_INSTRET(__class)	\
+	(SBI_PMU_FW_MMODE_INSTRET_BASE + (__class))
+
 /** SBI PMU event idx type */
 enum sbi_pmu_event_type_id {
 	SBI_PMU_EVENT_TYPE_HW				= 0x0,
@@ -290,6 +331,48 @@ enum sbi_cppc_reg_id {
 	SBI_CPPC_NON_ACPI_LAST		= SBI_CPPC_TRANSITION_LATENCY,
 };
 
+/* SBI function IDs for FWFT extension */
+#define SBI_EXT_FWFT_SET			0x0
+#define SBI_EXT_FWFT_GET			0x1
+
+enum sbi_fwft_feature_t {
+	SBI_FWFT_MISALIGNED_EXC_DELEG		= 0x0,
+	SBI_FWFT_FEATURE_MAX
+};
+
+/* Flags defined for FWFT set function */
+#define SBI_FWFT_SET_FLAG_LOCK			(1 << 0)
+
+/* SBI function IDs for OpenSBI firmware specific extension */
+#define SBI_EXT_OPENSBI_PMU_SAMPLE_START	0x0
+#define SBI_EXT_OPENSBI_PMU_SAMPLE_STOP		0x1
+#define SBI_EXT_OPENSBI_PMU_SAMPLE_READ		0x2
+#define SBI_EXT_OPENSBI_TRAP_HOTSPOT_READ	0x3
+#define SBI_EXT_OPENSBI_HSM_HART_START_MANY	0x4
+#define SBI_EXT_OPENSBI_HSM_SUSPEND_STATS_READ	0x5
+#define SBI_EXT_OPENSBI_DOMAIN_SWITCH		0x6
+#define SBI_EXT_OPENSBI_LOCKSTAT_READ		0x7
+
+/* Flags defined for PMU sample start function */
+#define SBI_PMU_SAMPLE_FLAG_NO_IRQ		(1 << 0)
+
+/* Privilege mode encoding of PMU samples */
+#define SBI_PMU_SAMPLE_MODE_MASK		0x3
+#define SBI_PMU_SAMPLE_MODE_VIRT		(1 << 2)
+
+/* Flags defined for trap hotspot read function */
+#define SBI_TRAP_HOTSPOT_FLAG_RESET		(1 << 0)
+
+/* Privilege mode encoding of trap hotspots */
+#define SBI_TRAP_HOTSPOT_MODE_MASK		0x3
+#define SBI_TRAP_HOTSPOT_MODE_VIRT		(1 << 2)
+
+/* Flags defined for HSM suspend stats read function */
+#define SBI_HSM_SUSPEND_STATS_FLAG_RESET	(1 << 0)
+
+/* Flags defined for lockstat read function */
+#define SBI_LOCKSTAT_FLAG_RESET			(1 << 0)
+
 /* SBI base specification related macros */
 #define SBI_SPEC_VERSION_MAJOR_OFFSET		24
 #define SBI_SPEC_VERSION_MAJOR_MASK		0x7f
@@ -34,6 +34,7 @@
 #define SBI_ETRAP		-1007
 #define SBI_EUNKNOWN		-1008
 #define SBI_ENOENT		-1009
+#define SBI_EJUMP		-1010
 
 /* clang-format on */
 
@@ -0,0 +1,56 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Firmware features of the current HART
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#ifndef __SBI_FWFT_H__
+#define __SBI_FWFT_H__
+
+#include <sbi/sbi_ecall_interface.h>
+#include <sbi/sbi_types.h>
+
+struct sbi_scratch;
+
+/** Per-HART state of firmware features */
+struct sbi_fwft_state {
+	/** Current value of each firmware feature */
+	unsigned long values[SBI_FWFT_FEATURE_MAX];
+	/** Bitmap of firmware features locked by supervisor software */
+	unsigned long locked;
+};
+
+/** Set value of a firmware feature on current HART */
+int sbi_fwft_set(u32 feature, unsigned long value, unsigned long flags);
+
+/** Get value of a firmware feature on current HART */
+int sbi_fwft_get(u32 feature, unsigned long *out_val);
+
+/** Re-apply firmware features of current HART after losing HART state */
+void sbi_fwft_reinit(struct sbi_scratch *scratch);
+
+/** Save firmware feature state of current HART */
+void sbi_fwft_save(struct sbi_scratch *scratch, struct sbi_fwft_state *st);
+
+/**
+ * Replace firmware feature state of current HART
+ *
+ * Every feature is applied again including the ones with default
+ * value. Features not supported by the domain of the HART get their
+ * default value.
+ *
+ * @param scratch scratch space of current HART
+ * @param st state to restore or NULL for default values
+ */
+void sbi_fwft_restore(struct sbi_scratch *scratch,
+		      const struct sbi_fwft_state *st);
+
+/** Initialize firmware features of current HART */
+int sbi_fwft_init(struct sbi_scratch *scratch, bool cold_boot);
+
+#endif
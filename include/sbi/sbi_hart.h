@@ -36,6 +36,10 @@ enum sbi_hart_extensions {
 	SBI_HART_EXT_SMSTATEEN,
 	/** HART has Sstc extension */
 	SBI_HART_EXT_SSTC,
+	/** HART has Smcdeleg extension */
+	SBI_HART_EXT_SMCDELEG,
+	/** HART has Ssccfg extension */
+	SBI_HART_EXT_SSCCFG,
 
 	/** Maximum index of Hart extension */
 	SBI_HART_EXT_MAX,
@@ -57,6 +61,26 @@ struct sbi_scratch;
 int sbi_hart_reinit(struct sbi_scratch *scratch);
 int sbi_hart_init(struct sbi_scratch *scratch, bool cold_boot);
 
+/**
+ * Save HART context (M-mode CSRs and PMP) before non-retentive suspend
+ *
+ * @param scratch scratch space of current HART
+ */
+void sbi_hart_context_save(struct sbi_scratch *scratch);
+
+/**
+ * Restore HART context saved by sbi_hart_context_save()
+ *
+ * This replaces sbi_hart_reinit() and sbi_hart_pmp_configure() when
+ * resuming from non-retentive suspend. The saved context is consumed.
+ *
+ * @param scratch scratch space of current HART
+ *
+ * @return 0 on success, SBI_ENOENT if no context was saved and
+ * other error code if the HART could not be restored
+ */
+int sbi_hart_context_restore(struct sbi_scratch *scratch);
+
 extern void (*sbi_hart_expected_trap)(void);
 static inline ulong sbi_hart_expected_trap_addr(void)
 {
@@ -71,6 +95,33 @@ unsigned long sbi_hart_pmp_granularity(struct sbi_scratch *scratch);
 unsigned int sbi_hart_pmp_addrbits(struct sbi_scratch *scratch);
 unsigned int sbi_hart_mhpm_bits(struct sbi_scratch *scratch);
 int sbi_hart_pmp_configure(struct sbi_scratch *scratch);
+
+struct sbi_hart_pmp_plan;
+
+/** Get the number of PMP entries programmed on a HART */
+unsigned int sbi_hart_pmp_configured(struct sbi_scratch *scratch);
+
+/**
+ * Program the PMP entries of a plan on the current HART
+ *
+ * The caller must flush cached translations using sbi_hart_pmp_flush()
+ * afterwards.
+ *
+ * @param scratch scratch space of current HART
+ * @param plan pointer to the plan
+ */
+void sbi_hart_pmp_load(struct sbi_scratch *scratch,
+		       const struct sbi_hart_pmp_plan *plan);
+
+/**
+ * Clear floating-point and vector registers of the current HART
+ *
+ * @param scratch scratch space of current HART
+ */
+void sbi_hart_fp_vector_reset(struct sbi_scratch *scratch);
+
+/** Flush address translations cached along with PMP state */
+void sbi_hart_pmp_flush(void);
 int sbi_hart_priv_version(struct sbi_scratch *scratch);
 void sbi_hart_get_priv_version_str(struct sbi_scratch *scratch,
 				   char *version_str, int nvstr);
@@ -0,0 +1,94 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * PMP entry planning for domain memory regions
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#ifndef __SBI_HART_PMP_H__
+#define __SBI_HART_PMP_H__
+
+#include <sbi/riscv_encoding.h>
+#include <sbi/sbi_types.h>
+
+struct sbi_domain;
+
+/**
+ * Maximum number of address ranges merged at a time by the PMP planner
+ *
+ * The ranges live on the stack of the trap handler. All memory regions
+ * are planned but once more ranges than this remain after merging, the
+ * highest priority ones are planned without being merged further.
+ */
+#define SBI_HART_PMP_PLAN_MAX_RANGES	32
+
+/** PMP entries planned for the memory regions of a domain */
+struct sbi_hart_pmp_plan {
+	/** Number of PMP entries to program */
+	unsigned int count;
+	/** Number of PMP entries needed to cover all memory regions */
+	unsigned int needed;
+	/** Some ranges were planned before all memory regions were merged */
+	bool unmerged;
+	/** pmpcfg byte of each PMP entry */
+	u8 cfg[PMP_COUNT];
+	/** pmpaddr value of each PMP entry */
+	unsigned long addr[PMP_COUNT];
+};
+
+/**
+ * Plan PMP entries for the memory regions of a domain
+ *
+ * Adjacent memory regions with identical permissions are merged and
+ * memory regions hidden by higher priority ones are dropped. Each
+ * resulting address range is encoded with NAPOT entries or as a TOR
+ * pair, whichever needs fewer PMP entries. PMP entries keep the order
+ * of memory regions so the first matching memory region still wins.
+ *
+ * When the PMP entries don't fit, the plan holds the PMP entries of the
+ * highest priority memory regions which fit.
+ *
+ * @param dom pointer to the domain
+ * @param pmp_count number of PMP entries implemented by the HART
+ * @param pmp_gran PMP granularity of the HART in bytes
+ * @param pmp_addr_bits number of implemented PMP address bits
+ * @param plan pointer to the plan to fill
+ *
+ * @return 0 if all memory regions fit, SBI_ENOSPC if they don't fit and
+ * other negative error code on failure
+ */
+int sbi_hart_pmp_plan(const struct sbi_domain *dom, unsigned int pmp_count,
+		      unsigned long pmp_gran, unsigned int pmp_addr_bits,
+		      struct sbi_hart_pmp_plan *plan);
+
+/**
+ * Check whether a plan can replace the PMP entries of the current HART
+ *
+ * Locked PMP entries can't be changed so they must be part of the plan
+ * as-is.
+ *
+ * @param plan pointer to the plan
+ * @param prev_count number of PMP entries currently programmed
+ *
+ * @return 0 if the plan can be programmed and SBI_EDENIED otherwise
+ */
+int sbi_hart_pmp_plan_check(const struct sbi_hart_pmp_plan *plan,
+			    unsigned int prev_count);
+
+/**
+ * Program the PMP entries of a plan on the current HART
+ *
+ * PMP entries programmed before which are not part of the plan are
+ * turned off and PMP entries after them are left untouched.
+ *
+ * @param plan pointer to the plan
+ * @param prev_count number of PMP entries currently programmed
+ */
+void sbi_hart_pmp_plan_write(const struct sbi_hart_pmp_plan *plan,
+			     unsigned int prev_count);
+
+#endif
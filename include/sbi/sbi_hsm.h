@@ -51,6 +51,25 @@ struct sbi_hsm_device {
 	void (*hart_resume)(void);
 };
 
+/** Maximum number of suspend types tracked per HART */
+#define SBI_HSM_SUSPEND_STATS_MAX	4
+
+/** Suspend statistics of a HART for one suspend type (times in ticks) */
+struct sbi_hsm_suspend_stats {
+	/** suspend_type Suspend type requested by the supervisor */
+	u32 suspend_type;
+	/** demoted Number of suspends demoted to retentive suspend */
+	u32 demoted;
+	/** count Number of completed suspends */
+	u64 count;
+	/** residency Cumulative time from suspend entry to wake-up */
+	u64 residency;
+	/** exit_latency Cumulative time from wake-up to supervisor resume */
+	u64 exit_latency;
+	/** max_exit_latency Worst-case time from wake-up to supervisor resume */
+	u64 max_exit_latency;
+};
+
 struct sbi_domain;
 struct sbi_scratch;
 
@@ -64,6 +83,10 @@ void __noreturn sbi_hsm_exit(struct sbi_scratch *scratch);
 int sbi_hsm_hart_start(struct sbi_scratch *scratch,
 		       const struct sbi_domain *dom,
 		       u32 hartid, ulong saddr, ulong smode, ulong arg1);
+int sbi_hsm_hart_start_many(struct sbi_scratch *scratch,
+			    const struct sbi_domain *dom,
+			    ulong hmask, ulong hbase, ulong saddr,
+			    ulong smode, const ulong *arg1s);
 int sbi_hsm_hart_stop(struct sbi_scratch *scratch, bool exitnow);
 void sbi_hsm_hart_resume_start(struct sbi_scratch *scratch);
 void __noreturn sbi_hsm_hart_resume_finish(struct sbi_scratch *scratch,
@@ -77,6 +100,18 @@ int sbi_hsm_hart_get_state(const struct sbi_domain *dom, u32 hartid);
 int sbi_hsm_hart_interruptible_mask(const struct sbi_domain *dom,
 				    ulong hbase, ulong *out_hmask);
 void __sbi_hsm_suspend_non_ret_save(struct sbi_scratch *scratch);
+
+/**
+ * Copy suspend statistics of current HART
+ *
+ * @param out array of statistics to fill-up
+ * @param num maximum number of entries to copy
+ * @param reset clear the statistics after copying
+ *
+ * @return number of entries copied
+ */
+unsigned long sbi_hsm_suspend_stats_read(struct sbi_hsm_suspend_stats *out,
+					 unsigned long num, bool reset);
 void __noreturn sbi_hsm_hart_start_finish(struct sbi_scratch *scratch,
 					  u32 hartid);
 
@@ -23,11 +23,31 @@ struct sbi_ipi_device {
 	/** Name of the IPI device */
 	char name[32];
 
-	/** Send IPI to a target HART */
-	void (*ipi_send)(u32 target_hart);
+	/**
+	 * Send IPI to a target HART
+	 * Note: Returns zero on success and SBI_ENODEV when the device
+	 * does not serve the target HART.
+	 */
+	int (*ipi_send)(u32 target_hart);
 
 	/** Clear IPI for a target HART */
 	void (*ipi_clear)(u32 target_hart);
+
+	/**
+	 * Send IPI for a particular IPI event to a target HART (optional)
+	 * Note: This is used instead of the shared IPI event bitmask and
+	 * ipi_send() when it returns zero. The receiving HART must call
+	 * sbi_ipi_process_event() for such IPIs.
+	 */
+	int (*ipi_send_event)(u32 target_hart, u32 event);
+};
+
+/** Precomputed IPI doorbell of a target HART */
+struct sbi_ipi_doorbell {
+	/** MMIO address to be written for triggering IPI */
+	volatile u32 *addr;
+	/** Value to be written at MMIO address */
+	u32 value;
 };
 
 struct sbi_scratch;
@@ -75,14 +95,31 @@ int sbi_ipi_send_halt(ulong hmask, ulong hbase);
 
 void sbi_ipi_process(void);
 
+void sbi_ipi_process_event(u32 event);
+
 int sbi_ipi_raw_send(u32 target_hart);
 
+/**
+ * Ring the IPI doorbells of multiple HARTs in one pass
+ * @param hmask the ulong HART mask of target HARTs
+ * @param hbase the HART base ID of hmask
+ * @return mask (relative to hbase) of HARTs which could not be signaled
+ */
+ulong sbi_ipi_raw_send_many(ulong hmask, ulong hbase);
+
 void sbi_ipi_raw_clear(u32 target_hart);
 
 const struct sbi_ipi_device *sbi_ipi_get_device(void);
 
 void sbi_ipi_set_device(const struct sbi_ipi_device *dev);
 
+const struct sbi_ipi_device *sbi_ipi_get_smode_device(void);
+
+void sbi_ipi_set_smode_device(const struct sbi_ipi_device *dev);
+
+int sbi_ipi_set_doorbell(const struct sbi_ipi_device *dev, u32 target_hart,
+			 volatile u32 *addr, u32 value);
+
 int sbi_ipi_init(struct sbi_scratch *scratch, bool cold_boot);
 
 void sbi_ipi_exit(struct sbi_scratch *scratch);
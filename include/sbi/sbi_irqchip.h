@@ -41,4 +41,10 @@ int sbi_irqchip_init(struct sbi_scratch *scratch, bool cold_boot);
 /** Exit interrupt controllers */
 void sbi_irqchip_exit(struct sbi_scratch *scratch);
 
+/** Save interrupt controller state before system suspend */
+int sbi_irqchip_suspend(struct sbi_scratch *scratch);
+
+/** Restore interrupt controller state after system suspend */
+void sbi_irqchip_resume(struct sbi_scratch *scratch);
+
 #endif
@@ -0,0 +1,101 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Spinlock statistics
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#ifndef __SBI_LOCKSTAT_H__
+#define __SBI_LOCKSTAT_H__
+
+#include <sbi/riscv_locks.h>
+#include <sbi/sbi_types.h>
+
+/** Maximum number of lock sites tracked per HART */
+#ifdef CONFIG_SBI_LOCKSTAT_SITES
+#define SBI_LOCKSTAT_MAX		CONFIG_SBI_LOCKSTAT_SITES
+#else
+#define SBI_LOCKSTAT_MAX		8
+#endif
+
+/** Statistics of a lock site */
+struct sbi_lockstat {
+	/** lock Address of the spinlock */
+	unsigned long lock;
+	/** site Return address of the call taking the spinlock */
+	unsigned long site;
+	/** acquired Number of times the spinlock was taken */
+	unsigned long acquired;
+	/** contended Number of times the spinlock was taken after waiting */
+	unsigned long contended;
+	/** wait_cycles Cumulative cycles spent waiting for the spinlock */
+	uint64_t wait_cycles;
+	/** wait_max Maximum cycles spent waiting for the spinlock */
+	uint64_t wait_max;
+	/** hold_cycles Cumulative cycles the spinlock was held */
+	uint64_t hold_cycles;
+};
+
+#ifdef CONFIG_SBI_LOCKSTAT
+
+/**
+ * Account a spinlock taken by the current HART
+ *
+ * @param lock pointer to the spinlock
+ * @param site return address of the call taking the spinlock
+ * @param contended true if the spinlock was not free right away
+ * @param wait_cycles cycles spent waiting for the spinlock
+ */
+void sbi_lockstat_acquired(spinlock_t *lock, unsigned long site,
+			   bool contended, unsigned long wait_cycles);
+
+/**
+ * Account a spinlock released by the current HART
+ *
+ * @param lock pointer to the spinlock
+ */
+void sbi_lockstat_released(spinlock_t *lock);
+
+/**
+ * Copy lock site statistics of current HART
+ *
+ * @param out array of lock site statistics to fill-up
+ * @param num maximum number of lock sites to copy
+ * @param reset clear the statistics after copying
+ *
+ * @return number of lock sites copied
+ */
+unsigned long sbi_lockstat_read(struct sbi_lockstat *out,
+				unsigned long num, bool reset);
+
+/** Print lock site statistics of all HARTs */
+void sbi_lockstat_dump(void);
+
+/**
+ * Initialize spinlock statistics
+ *
+ * @param cold_boot true if cold booting
+ *
+ * @return 0 on success and negative error code on failure
+ */
+int sbi_lockstat_init(bool cold_boot);
+
+#else
+
+static inline unsigned long sbi_lockstat_read(struct sbi_lockstat *out,
+					      unsigned long num, bool reset)
+{
+	return 0;
+}
+
+static inline void sbi_lockstat_dump(void) { }
+
+static inline int sbi_lockstat_init(bool cold_boot) { return 0; }
+
+#endif
+
+#endif
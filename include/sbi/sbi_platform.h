@@ -95,6 +95,8 @@ struct sbi_platform_operations {
 
 	/** Initialize (or populate) HART extensions for the platform */
 	int (*extensions_init)(struct sbi_hart_features *hfeatures);
+	/** Get class of a HART for sharing detected HART features */
+	unsigned long (*hart_class)(u32 hartid);
 
 	/** Initialize (or populate) domains for the platform */
 	int (*domains_init)(void);
@@ -112,6 +114,10 @@ struct sbi_platform_operations {
 	int (*irqchip_init)(bool cold_boot);
 	/** Exit the platform interrupt controller for current HART */
 	void (*irqchip_exit)(void);
+	/** Save the platform interrupt controller state for system suspend */
+	int (*irqchip_suspend)(void);
+	/** Restore the platform interrupt controller state after system suspend */
+	void (*irqchip_resume)(void);
 
 	/** Initialize IPI for current HART */
 	int (*ipi_init)(bool cold_boot);
@@ -493,6 +499,26 @@ static inline int sbi_platform_extensions_init(
 	return 0;
 }
 
+/**
+ * Get class of a HART for sharing detected HART features
+ *
+ * HARTs with the same mvendorid, marchid, mimpid and class share the
+ * features detected on the first of them.
+ *
+ * @param plat pointer to struct sbi_platform
+ * @param hartid HART ID
+ *
+ * @return platform specific class of the HART and 0 if unknown
+ */
+static inline unsigned long sbi_platform_hart_class(
+					const struct sbi_platform *plat,
+					u32 hartid)
+{
+	if (plat && sbi_platform_ops(plat)->hart_class)
+		return sbi_platform_ops(plat)->hart_class(hartid);
+	return 0;
+}
+
 /**
  * Initialize (or populate) domains for the platform
  *
@@ -581,6 +607,31 @@ static inline void sbi_platform_irqchip_exit(const struct sbi_platform *plat)
 		sbi_platform_ops(plat)->irqchip_exit();
 }
 
+/**
+ * Save the platform interrupt controller state before system suspend
+ *
+ * @param plat pointer to struct sbi_platform
+ *
+ * @return 0 on success and negative error code on failure
+ */
+static inline int sbi_platform_irqchip_suspend(const struct sbi_platform *plat)
+{
+	if (plat && sbi_platform_ops(plat)->irqchip_suspend)
+		return sbi_platform_ops(plat)->irqchip_suspend();
+	return 0;
+}
+
+/**
+ * Restore the platform interrupt controller state after system suspend
+ *
+ * @param plat pointer to struct sbi_platform
+ */
+static inline void sbi_platform_irqchip_resume(const struct sbi_platform *plat)
+{
+	if (plat && sbi_platform_ops(plat)->irqchip_resume)
+		sbi_platform_ops(plat)->irqchip_resume();
+}
+
 /**
  * Initialize the platform IPI support for current HART
  *
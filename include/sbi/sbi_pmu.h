@@ -24,6 +24,9 @@ struct sbi_scratch;
 #define SBI_PMU_CTR_MAX	   (SBI_PMU_HW_CTR_MAX + SBI_PMU_FW_CTR_MAX)
 #define SBI_PMU_FIXED_CTR_MASK 0x07
 
+/* Maximum number of PC samples buffered per HART */
+#define SBI_PMU_SAMPLE_MAX	16
+
 struct sbi_pmu_device {
 	/** Name of the PMU platform device */
 	char name[32];
@@ -91,6 +94,16 @@ struct sbi_pmu_device {
 	int (*hw_counter_irq_bit)(void);
 };
 
+/** PC sample captured by firmware assisted sampling */
+struct sbi_pmu_sample {
+	/** Program counter of the interrupted context */
+	unsigned long pc;
+	/** Privilege mode of the interrupted context (SBI_PMU_SAMPLE_MODE_xyz) */
+	unsigned long mode;
+	/** Value of the sampled counter */
+	uint64_t ctr_value;
+};
+
 /** Get the PMU platform device */
 const struct sbi_pmu_device *sbi_pmu_get_device(void);
 
@@ -100,6 +113,12 @@ void sbi_pmu_set_device(const struct sbi_pmu_device *dev);
 /** Initialize PMU */
 int sbi_pmu_init(struct sbi_scratch *scratch, bool cold_boot);
 
+/** Save PMU state of current HART before non-retentive suspend */
+void sbi_pmu_context_save(struct sbi_scratch *scratch);
+
+/** Restore PMU state of current HART after non-retentive suspend */
+void sbi_pmu_context_restore(struct sbi_scratch *scratch);
+
 /** Reset PMU during hart exit */
 void sbi_pmu_exit(struct sbi_scratch *scratch);
 
@@ -143,4 +162,44 @@ int sbi_pmu_ctr_cfg_match(unsigned long cidx_base, unsigned long cidx_mask,
 
 int sbi_pmu_ctr_incr_fw(enum sbi_pmu_fw_event_code_id fw_id);
 
+/**
+ * Begin M-mode residency accounting on current HART
+ * @param cycle   pointer to save mcycle value at M-mode entry
+ * @param instret pointer to save minstret value at M-mode entry
+ * @return true if M-mode residency needs to be accounted, false otherwise.
+ */
+bool sbi_pmu_mmode_begin(uint64_t *cycle, uint64_t *instret);
+
+/**
+ * End M-mode residency accounting on current HART
+ * @param mclass  M-mode residency class (enum sbi_pmu_mmode_class)
+ * @param cycle   mcycle value saved by sbi_pmu_mmode_begin()
+ * @param instret minstret value saved by sbi_pmu_mmode_begin()
+ */
+void sbi_pmu_mmode_end(unsigned long mclass, uint64_t cycle,
+		       uint64_t instret);
+
+/**
+ * Start firmware assisted PC sampling on current HART
+ * @param period sampling period in timer ticks
+ * @param cidx   counter index whose value is captured with each sample
+ * @param flags  sampling flags (SBI_PMU_SAMPLE_FLAG_xyz)
+ * @return 0 on success, error otherwise.
+ */
+int sbi_pmu_sample_start(unsigned long period, unsigned long cidx,
+			 unsigned long flags);
+
+/** Stop firmware assisted PC sampling on current HART */
+int sbi_pmu_sample_stop(void);
+
+/**
+ * Drain PC samples of current HART into supervisor memory
+ * @param addr    physical address of an array of struct sbi_pmu_sample
+ * @param num     maximum number of samples to copy
+ * @param out_num number of samples copied
+ * @return 0 on success, error otherwise.
+ */
+int sbi_pmu_sample_read(unsigned long addr, unsigned long num,
+			unsigned long *out_num);
+
 #endif
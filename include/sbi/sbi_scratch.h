@@ -42,6 +42,15 @@
 #define SBI_SCRATCH_EXTRA_SPACE_OFFSET		(12 * __SIZEOF_POINTER__)
 /** Maximum size of sbi_scratch (4KB) */
 #define SBI_SCRATCH_SIZE			(0x1000)
+#ifdef CONFIG_SBI_MCS_SPINLOCK
+/** Size of spinlock queue nodes at the end of sbi_scratch */
+#define SBI_SCRATCH_LOCK_NODES_SIZE		(12 * __SIZEOF_POINTER__)
+#else
+#define SBI_SCRATCH_LOCK_NODES_SIZE		0
+#endif
+/** Offset of spinlock queue nodes in sbi_scratch */
+#define SBI_SCRATCH_LOCK_NODES_OFFSET		\
+	(SBI_SCRATCH_SIZE - SBI_SCRATCH_LOCK_NODES_SIZE)
 
 /* clang-format on */
 
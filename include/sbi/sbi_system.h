@@ -13,6 +13,8 @@
 #include <sbi/sbi_types.h>
 #include <sbi/sbi_list.h>
 
+struct sbi_scratch;
+
 /** System reset hardware device */
 struct sbi_system_reset_device {
 	/** Name of the system reset device */
@@ -69,5 +71,6 @@ void sbi_system_suspend_set_device(struct sbi_system_suspend_device *dev);
 void sbi_system_suspend_test_enable(void);
 bool sbi_system_suspend_supported(u32 sleep_type);
 int sbi_system_suspend(u32 sleep_type, ulong resume_addr, ulong opaque);
+void sbi_system_resume(struct sbi_scratch *scratch);
 
 #endif
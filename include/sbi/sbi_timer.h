@@ -31,6 +31,7 @@ struct sbi_timer_device {
 };
 
 struct sbi_scratch;
+struct sbi_trap_regs;
 
 /** Generic delay loop of desired granularity */
 void sbi_timer_delay_loop(ulong units, u64 unit_freq,
@@ -84,8 +85,35 @@ void sbi_timer_set_delta_upper(ulong delta_upper);
 /** Start timer event for current HART */
 void sbi_timer_event_start(u64 next_event);
 
+/** Get the pending S-mode timer event of current HART or -1ULL */
+u64 sbi_timer_smode_event_save(void);
+
+/**
+ * Re-arm the S-mode timer event of current HART
+ *
+ * Unlike sbi_timer_event_start(), this is not accounted as a
+ * supervisor request.
+ *
+ * @param next_event the event to re-arm or -1ULL for none
+ */
+void sbi_timer_smode_event_restore(u64 next_event);
+
+/**
+ * Start M-mode timer event for current HART
+ *
+ * The M-mode timer event is multiplexed with S-mode timer event on the
+ * same timer device so the S-mode timer keeps working as before. The
+ * function is called from M-mode timer interrupt context and can re-arm
+ * the M-mode timer event.
+ */
+int sbi_timer_mmode_event_start(u64 next_event,
+				void (*fn)(struct sbi_trap_regs *regs));
+
+/** Stop M-mode timer event for current HART */
+void sbi_timer_mmode_event_stop(void);
+
 /** Process timer event for current HART */
-void sbi_timer_process(void);
+void sbi_timer_process(struct sbi_trap_regs *regs);
 
 /** Get current timer device */
 const struct sbi_timer_device *sbi_timer_get_device(void);
@@ -96,6 +124,12 @@ void sbi_timer_set_device(const struct sbi_timer_device *dev);
 /* Initialize timer */
 int sbi_timer_init(struct sbi_scratch *scratch, bool cold_boot);
 
+/** Save timer state of current HART before non-retentive suspend */
+void sbi_timer_context_save(struct sbi_scratch *scratch);
+
+/** Restore timer state of current HART after non-retentive suspend */
+void sbi_timer_context_restore(struct sbi_scratch *scratch);
+
 /* Exit timer */
 void sbi_timer_exit(struct sbi_scratch *scratch);
 
@@ -224,6 +224,43 @@ static inline unsigned long sbi_regs_gva(const struct sbi_trap_regs *regs)
 #endif
 }
 
+/** Maximum number of trap emulation hotspots tracked per HART */
+#define SBI_TRAP_HOTSPOT_MAX		16
+
+/** Representation of a trap emulation hotspot */
+struct sbi_trap_hotspot {
+	/** pc Program counter of the emulated instruction */
+	unsigned long pc;
+	/** cause Trap exception cause */
+	unsigned int cause;
+	/** mode Privilege mode of the trap (SBI_TRAP_HOTSPOT_MODE_xyz) */
+	unsigned int mode;
+	/** hits Number of times the trap was taken */
+	unsigned long hits;
+	/** cycles Cumulative M-mode cycles spent for the trap */
+	uint64_t cycles;
+};
+
+/**
+ * Copy trap emulation hotspots of current HART
+ *
+ * @param out array of hotspots to fill-up
+ * @param num maximum number of hotspots to copy
+ * @param reset clear the hotspots after copying
+ *
+ * @return number of hotspots copied
+ */
+#ifdef CONFIG_SBI_TRAP_HOTSPOT
+unsigned long sbi_trap_hotspot_read(struct sbi_trap_hotspot *out,
+				    unsigned long num, bool reset);
+#else
+static inline unsigned long sbi_trap_hotspot_read(struct sbi_trap_hotspot *out,
+						  unsigned long num, bool reset)
+{
+	return 0;
+}
+#endif
+
 int sbi_trap_redirect(struct sbi_trap_regs *regs,
 		      struct sbi_trap_info *trap);
 
@@ -231,6 +268,10 @@ struct sbi_trap_regs *sbi_trap_handler(struct sbi_trap_regs *regs);
 
 void __noreturn sbi_trap_exit(const struct sbi_trap_regs *regs);
 
+struct sbi_scratch;
+
+int sbi_trap_init(struct sbi_scratch *scratch, bool cold_boot);
+
 #endif
 
 #endif
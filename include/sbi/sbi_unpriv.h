@@ -36,6 +36,22 @@ DECLARE_UNPRIVILEGED_LOAD_FUNCTION(u64)
 DECLARE_UNPRIVILEGED_STORE_FUNCTION(u64)
 DECLARE_UNPRIVILEGED_LOAD_FUNCTION(ulong)
 
+/**
+ * Copy len bytes from unprivileged address src to M-mode buffer dst
+ *
+ * The copy uses naturally aligned accesses of up to XLEN bits with a
+ * single MTVEC switch for the whole copy. On a fault, the copy stops,
+ * trap details (including the faulting address in trap->tval) are
+ * saved in trap and the number of bytes copied before the faulting
+ * access is returned.
+ */
+ulong sbi_copy_from_unpriv(void *dst, ulong src, ulong len,
+			   struct sbi_trap_info *trap);
+
+/** Copy len bytes from M-mode buffer src to unprivileged address dst */
+ulong sbi_copy_to_unpriv(ulong dst, const void *src, ulong len,
+			 struct sbi_trap_info *trap);
+
 ulong sbi_get_insn(ulong mepc, struct sbi_trap_info *trap);
 
 #endif
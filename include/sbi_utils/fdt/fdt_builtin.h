@@ -0,0 +1,100 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * fdt_builtin.h - Pre-resolved records of a built-in device tree
+ *
+ * The records are generated at build time by scripts/fdt2rec.py and are
+ * only used when the device tree passed to the firmware is identical to
+ * the built-in one. Otherwise everything is parsed at runtime.
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#ifndef __FDT_BUILTIN_H__
+#define __FDT_BUILTIN_H__
+
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_types.h>
+
+struct fdt_builtin_reg {
+	int node;
+	int index;
+	u64 addr;
+	u64 size;
+};
+
+struct fdt_builtin_records {
+	u32 totalsize;
+	u32 checksum;
+	const u32 *hart_ids;
+	/* Negative if the device tree has no /cpus node */
+	int hart_count;
+	/* Sorted by node offset and index */
+	const struct fdt_builtin_reg *regs;
+	u32 reg_count;
+};
+
+#ifdef CONFIG_FDT_BUILTIN
+
+/**
+ * Check whether the built-in records describe a device tree
+ *
+ * The result is cached for the last blob address so a relocated copy
+ * is compared once more. Nothing is used after fdt_builtin_invalidate()
+ * is called.
+ *
+ * @param fdt device tree blob
+ *
+ * @return true if the built-in records can be used
+ */
+bool fdt_builtin_usable(const void *fdt);
+
+/**
+ * Stop using the built-in records
+ *
+ * This is called when the device tree is about to be modified because
+ * node offsets may change.
+ */
+void fdt_builtin_invalidate(void);
+
+/**
+ * Get the IDs of enabled HARTs in /cpus node order
+ *
+ * @return 0 on success and SBI_ENOENT if there are no usable records
+ */
+int fdt_builtin_hart_ids(const void *fdt, const u32 **out_ids,
+			 u32 *out_count);
+
+/**
+ * Get the translated address and size of a "reg" entry
+ *
+ * @return 0 on success and SBI_ENOENT if there is no usable record
+ */
+int fdt_builtin_node_addr_size(const void *fdt, int node, int index,
+			       uint64_t *addr, uint64_t *size);
+
+#else
+
+static inline bool fdt_builtin_usable(const void *fdt) { return false; }
+
+static inline void fdt_builtin_invalidate(void) { }
+
+static inline int fdt_builtin_hart_ids(const void *fdt, const u32 **out_ids,
+				       u32 *out_count)
+{
+	return SBI_ENOENT;
+}
+
+static inline int fdt_builtin_node_addr_size(const void *fdt, int node,
+					     int index, uint64_t *addr,
+					     uint64_t *size)
+{
+	return SBI_ENOENT;
+}
+
+#endif
+
+#endif
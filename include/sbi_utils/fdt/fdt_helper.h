@@ -18,6 +18,18 @@ struct fdt_match {
 	const void *data;
 };
 
+/**
+ * Class of FDT drivers generated at compile time from a .carray file
+ * having the "MATCH_TABLE:" key. It lists the match table of every
+ * driver in the class so that all classes can be matched in a single
+ * device tree walk.
+ */
+struct fdt_driver_class {
+	const char *name;
+	const struct fdt_match *const *const *match_tables;
+	unsigned long match_tables_size;
+};
+
 #define FDT_MAX_PHANDLE_ARGS 16
 struct fdt_phandle_args {
 	int node_offset;
@@ -98,6 +110,10 @@ int fdt_parse_aclint_node(void *fdt, int nodeoffset, bool for_timer,
 			  unsigned long *out_addr2, unsigned long *out_size2,
 			  u32 *out_first_hartid, u32 *out_hart_count);
 
+int fdt_parse_aclint_sswi_node(void *fdt, int nodeoffset,
+			       unsigned long *out_addr, unsigned long *out_size,
+			       u32 *out_first_hartid, u32 *out_hart_count);
+
 int fdt_parse_plmt_node(void *fdt, int nodeoffset, unsigned long *plmt_base,
 			  unsigned long *plmt_size, u32 *hart_count);
 
@@ -0,0 +1,127 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * fdt_index.h - Flat Device Tree lookup index
+ *
+ * The index maps phandles, compatible strings and well-known paths to
+ * node offsets so that repeated lookups done while probing drivers don't
+ * rescan the whole device tree.
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#ifndef __FDT_INDEX_H__
+#define __FDT_INDEX_H__
+
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_types.h>
+
+struct fdt_match;
+
+#ifdef CONFIG_FDT_INDEX
+
+/**
+ * Build (or rebuild) the lookup index of a device tree
+ *
+ * The index is built implicitly by the first lookup so calling this
+ * is only needed to rebuild the index after it was invalidated.
+ *
+ * @param fdt device tree blob
+ *
+ * @return 0 on success and negative error code on failure
+ */
+int fdt_index_build(const void *fdt);
+
+/**
+ * Invalidate the lookup index
+ *
+ * This must be called before modifying the device tree (i.e. before
+ * any fdt_rw operation) because node offsets may change. Lookups fall
+ * back to libfdt until the index is rebuilt.
+ */
+void fdt_index_invalidate(void);
+
+/** Indexed equivalent of fdt_node_offset_by_compatible() */
+int fdt_index_offset_by_compatible(const void *fdt, int startoffset,
+				   const char *compatible);
+
+/** Indexed equivalent of fdt_node_offset_by_phandle() */
+int fdt_index_offset_by_phandle(const void *fdt, uint32_t phandle);
+
+/** Indexed equivalent of fdt_path_offset() */
+int fdt_index_path_offset(const void *fdt, const char *path);
+
+/**
+ * Find the next node matched by a match table of an FDT driver class
+ *
+ * Matching nodes are returned in device tree order.
+ *
+ * @param fdt device tree blob
+ * @param startoff only nodes after this offset are considered
+ * @param match_table match table of the driver
+ * @param out_match pointer to the matching entry of the match table
+ *
+ * @return node offset on success, SBI_ENODEV if there are no more
+ * matching nodes and SBI_ENOSYS if the index can't answer (in which case
+ * the caller has to scan the device tree)
+ */
+int fdt_index_find_match(const void *fdt, int startoff,
+			 const struct fdt_match *match_table,
+			 const struct fdt_match **out_match);
+
+/**
+ * Check whether a node is matched by a match table of an FDT driver class
+ *
+ * @return 0 on success, SBI_ENODEV if the node doesn't match and
+ * SBI_ENOSYS if the index can't answer
+ */
+int fdt_index_match_node(const void *fdt, int nodeoff,
+			 const struct fdt_match *match_table,
+			 const struct fdt_match **out_match);
+
+#else
+
+#include <libfdt.h>
+
+static inline int fdt_index_build(const void *fdt) { return 0; }
+
+static inline void fdt_index_invalidate(void) { }
+
+static inline int fdt_index_offset_by_compatible(const void *fdt,
+						 int startoffset,
+						 const char *compatible)
+{
+	return fdt_node_offset_by_compatible(fdt, startoffset, compatible);
+}
+
+static inline int fdt_index_offset_by_phandle(const void *fdt,
+					      uint32_t phandle)
+{
+	return fdt_node_offset_by_phandle(fdt, phandle);
+}
+
+static inline int fdt_index_path_offset(const void *fdt, const char *path)
+{
+	return fdt_path_offset(fdt, path);
+}
+
+static inline int fdt_index_find_match(const void *fdt, int startoff,
+				       const struct fdt_match *match_table,
+				       const struct fdt_match **out_match)
+{
+	return SBI_ENOSYS;
+}
+
+static inline int fdt_index_match_node(const void *fdt, int nodeoff,
+				       const struct fdt_match *match_table,
+				       const struct fdt_match **out_match)
+{
+	return SBI_ENOSYS;
+}
+
+#endif
+
+#endif
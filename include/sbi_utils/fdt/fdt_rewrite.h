@@ -0,0 +1,105 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * fdt_rewrite.h - Batched Flat Device Tree edits
+ *
+ * Fixups queue their edits against the unmodified device tree and the
+ * final device tree is produced by a single streaming copy when the
+ * outermost batch ends.
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#ifndef __FDT_REWRITE_H__
+#define __FDT_REWRITE_H__
+
+#include <libfdt_env.h>
+#include <sbi/sbi_string.h>
+#include <sbi/sbi_types.h>
+
+/**
+ * Start (or nest) a batch of device tree edits
+ *
+ * Node offsets passed to the edit functions must be obtained from the
+ * device tree as it was when the outermost batch started. The device
+ * tree must not be modified by other means until the batch ends.
+ *
+ * Edits queued by batches nested in the outermost batch may be applied
+ * when such a batch ends so the outermost batch must not hold node
+ * offsets across nested batches.
+ *
+ * @param fdt device tree blob
+ */
+void fdt_rewrite_begin(void *fdt);
+
+/**
+ * End a batch of device tree edits
+ *
+ * Ending the outermost batch applies all queued edits with one pass
+ * over the device tree. The device tree grows in place so the memory
+ * after the blob must be able to hold the added nodes and properties.
+ *
+ * @param fdt device tree blob
+ *
+ * @return 0 on success and negative error code on failure including
+ * edits dropped by any batch because the queue was full
+ */
+int fdt_rewrite_end(void *fdt);
+
+/**
+ * Queue adding or replacing a property
+ *
+ * @param fdt device tree blob
+ * @param nodeoff node offset or handle returned by fdt_rewrite_add_subnode()
+ * @param name property name
+ * @param val property value
+ * @param len length of property value
+ *
+ * @return 0 on success and negative error code on failure
+ */
+int fdt_rewrite_setprop(void *fdt, int nodeoff, const char *name,
+			const void *val, int len);
+
+/** Queue deleting a property */
+int fdt_rewrite_delprop(void *fdt, int nodeoff, const char *name);
+
+/**
+ * Queue adding a subnode
+ *
+ * @param fdt device tree blob
+ * @param parentoff node offset or handle of the parent node
+ * @param name name of the new node
+ *
+ * @return handle of the new node (usable as node offset with other
+ * edit functions) on success and negative error code on failure
+ */
+int fdt_rewrite_add_subnode(void *fdt, int parentoff, const char *name);
+
+/** Queue deleting a node along with all its subnodes */
+int fdt_rewrite_del_node(void *fdt, int nodeoff);
+
+static inline int fdt_rewrite_setprop_string(void *fdt, int nodeoff,
+					     const char *name, const char *str)
+{
+	return fdt_rewrite_setprop(fdt, nodeoff, name, str,
+				   sbi_strlen(str) + 1);
+}
+
+static inline int fdt_rewrite_setprop_u32(void *fdt, int nodeoff,
+					  const char *name, u32 val)
+{
+	fdt32_t tmp = cpu_to_fdt32(val);
+
+	return fdt_rewrite_setprop(fdt, nodeoff, name, &tmp, sizeof(tmp));
+}
+
+static inline int fdt_rewrite_setprop_empty(void *fdt, int nodeoff,
+					    const char *name)
+{
+	return fdt_rewrite_setprop(fdt, nodeoff, name, NULL, 0);
+}
+
+#endif
@@ -16,6 +16,8 @@
 
 struct fdt_ipi {
 	const struct fdt_match *match_table;
+	/* Driver provides IPIs for S-mode instead of M-mode */
+	bool smode;
 	int (*cold_init)(void *fdt, int nodeoff, const struct fdt_match *match);
 	int (*warm_init)(void);
 	void (*exit)(void);
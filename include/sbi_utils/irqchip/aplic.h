@@ -44,4 +44,36 @@ struct aplic_data {
 
 int aplic_cold_irqchip_init(struct aplic_data *aplic);
 
+/**
+ * Save the APLIC domain state
+ * @param aplic the APLIC domain
+ * @param domaincfg pointer to the saved domain configuration
+ * @param sourcecfg pointer to the saved source configurations including
+ * interrupt source 0 (i.e. num + 1 entries)
+ * @param target pointer to the saved targets including interrupt source 0
+ * (i.e. num + 1 entries)
+ * @param enable pointer to the saved enable bits (i.e. num / 32 + 1 words)
+ * @param num number of interrupt sources to save
+ */
+void aplic_context_save(const struct aplic_data *aplic, u32 *domaincfg,
+			u32 *sourcecfg, u32 *target, u32 *enable, u32 num);
+
+/**
+ * Restore the APLIC domain state saved by aplic_context_save()
+ *
+ * Nothing is written if the domain is still enabled with the saved
+ * configuration. Otherwise only registers saved with a value other than
+ * their reset value are written.
+ *
+ * @param aplic the APLIC domain
+ * @param domaincfg the saved domain configuration
+ * @param sourcecfg pointer to the saved source configurations
+ * @param target pointer to the saved targets
+ * @param enable pointer to the saved enable bits
+ * @param num number of interrupt sources to restore
+ */
+void aplic_context_restore(const struct aplic_data *aplic, u32 domaincfg,
+			   const u32 *sourcecfg, const u32 *target,
+			   const u32 *enable, u32 num);
+
 #endif
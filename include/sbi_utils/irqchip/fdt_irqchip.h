@@ -19,16 +19,26 @@ struct fdt_irqchip {
 	int (*cold_init)(void *fdt, int nodeoff, const struct fdt_match *match);
 	int (*warm_init)(void);
 	void (*exit)(void);
+	int (*suspend)(void);
+	void (*resume)(void);
 };
 
 void fdt_irqchip_exit(void);
 
+int fdt_irqchip_suspend(void);
+
+void fdt_irqchip_resume(void);
+
 int fdt_irqchip_init(bool cold_boot);
 
 #else
 
 static inline void fdt_irqchip_exit(void) { }
 
+static inline int fdt_irqchip_suspend(void) { return 0; }
+
+static inline void fdt_irqchip_resume(void) { }
+
 static inline int fdt_irqchip_init(bool cold_boot) { return 0; }
 
 #endif
@@ -12,9 +12,16 @@
 
 #include <sbi/sbi_types.h>
 
+/*
+ * Priority and enable registers are zero after the PLIC loses state so
+ * restoring them can skip registers which were saved as zero.
+ */
+#define PLIC_FLAG_RESET_ZERO		(1UL << 0)
+
 struct plic_data {
 	unsigned long addr;
 	unsigned long num_src;
+	unsigned long flags;
 };
 
 /* So far, priorities on all consumers of these functions fit in 8 bits. */
@@ -5,8 +5,149 @@
  * Copyright (c) 2021 Christoph Müllner <cmuellner@linux.com>
  */
 
+#include <sbi/riscv_asm.h>
 #include <sbi/riscv_barrier.h>
 #include <sbi/riscv_locks.h>
+#include <sbi/sbi_console.h>
+#include <sbi/sbi_hart.h>
+#include <sbi/sbi_lockstat.h>
+#include <sbi/sbi_scratch.h>
+
+#ifdef CONFIG_SBI_MCS_SPINLOCK
+
+/*
+ * MCS queued spinlock: each waiting HART spins on the locked flag of its
+ * own queue node and the unlocking HART hands the lock over to the next
+ * node in the queue, so only two HARTs touch any cache line at a time.
+ *
+ * Queue nodes live at the end of the scratch space of each HART. A HART
+ * takes one node per spinlock it holds or waits for so that a few
+ * spinlocks can be nested.
+ */
+struct mcs_node {
+	struct mcs_node *volatile next;
+	volatile unsigned long locked;
+	spinlock_t *lock;
+};
+
+#define MCS_NODE_COUNT	\
+	(SBI_SCRATCH_LOCK_NODES_SIZE / sizeof(struct mcs_node))
+
+_Static_assert(MCS_NODE_COUNT >= 2, "Too few spinlock queue nodes");
+
+/*
+ * Printing takes the console spinlock which needs a queue node as well,
+ * so report the failure character by character without any lock.
+ */
+static void __noreturn mcs_node_exhausted(spinlock_t *lock)
+{
+	char msg[80];
+	unsigned int i;
+
+	sbi_snprintf(msg, sizeof(msg),
+		     "\nspin_lock: out of queue nodes for lock 0x%lx\n",
+		     (unsigned long)lock);
+	for (i = 0; msg[i]; i++)
+		sbi_putc(msg[i]);
+
+	sbi_hart_hang();
+}
+
+static struct mcs_node *mcs_node_get(spinlock_t *lock)
+{
+	struct mcs_node *nodes =
+		sbi_scratch_thishart_offset_ptr(SBI_SCRATCH_LOCK_NODES_OFFSET);
+	unsigned int i;
+
+	while (1) {
+		for (i = 0; i < MCS_NODE_COUNT; i++) {
+			if (nodes[i].lock)
+				continue;
+			nodes[i].lock = lock;
+			nodes[i].next = NULL;
+			nodes[i].locked = 1;
+			return &nodes[i];
+		}
+
+		/* Nesting deeper than the available nodes is a bug */
+		mcs_node_exhausted(lock);
+	}
+}
+
+static struct mcs_node *mcs_node_find(spinlock_t *lock)
+{
+	struct mcs_node *nodes =
+		sbi_scratch_thishart_offset_ptr(SBI_SCRATCH_LOCK_NODES_OFFSET);
+	unsigned int i;
+
+	for (i = 0; i < MCS_NODE_COUNT; i++) {
+		if (nodes[i].lock == lock)
+			return &nodes[i];
+	}
+
+	return NULL;
+}
+
+static inline void mcs_node_put(struct mcs_node *node)
+{
+	node->lock = NULL;
+}
+
+bool spin_lock_check(spinlock_t *lock)
+{
+	return atomic_read(&lock->tail) ? true : false;
+}
+
+static bool __spin_trylock(spinlock_t *lock)
+{
+	struct mcs_node *node = mcs_node_get(lock);
+
+	if (!atomic_cmpxchg(&lock->tail, 0, (long)node))
+		return true;
+
+	mcs_node_put(node);
+	return false;
+}
+
+static void __spin_lock(spinlock_t *lock)
+{
+	struct mcs_node *prev, *node = mcs_node_get(lock);
+
+	/* Full barrier so the node is initialized before it is visible */
+	prev = (struct mcs_node *)atomic_xchg(&lock->tail, (long)node);
+	if (!prev)
+		return;
+
+	prev->next = node;
+	while (__smp_load_acquire(&node->locked))
+		;
+}
+
+static void __spin_unlock(spinlock_t *lock)
+{
+	struct mcs_node *next, *node = mcs_node_find(lock);
+
+	if (!node)
+		return;
+
+	next = node->next;
+	if (!next) {
+		/* No waiter if this HART is still the tail of the queue */
+		if (atomic_cmpxchg(&lock->tail, (long)node, 0) == (long)node) {
+			mcs_node_put(node);
+			return;
+		}
+
+		/* A waiter is about to link itself after this node */
+		while (!(next = node->next))
+			;
+	}
+
+	mcs_node_put(node);
+	__smp_store_release(&next->locked, 0);
+}
+
+#else
 
 static inline bool spin_lock_unlocked(spinlock_t lock)
 {
@@ -19,7 +160,7 @@ bool spin_lock_check(spinlock_t *lock)
 	return !spin_lock_unlocked(*lock);
 }
 
-bool spin_trylock(spinlock_t *lock)
+static bool __spin_trylock(spinlock_t *lock)
 {
 	unsigned long inc = 1u << TICKET_SHIFT;
 	unsigned long mask = 0xffffu << TICKET_SHIFT;
@@ -45,7 +186,7 @@ bool spin_trylock(spinlock_t *lock)
 	return l0 == 0;
 }
 
-void spin_lock(spinlock_t *lock)
+static void __spin_lock(spinlock_t *lock)
 {
 	unsigned long inc = 1u << TICKET_SHIFT;
 	unsigned long mask = 0xffffu;
@@ -71,7 +212,48 @@ void spin_lock(spinlock_t *lock)
 		: "memory");
 }
 
-void spin_unlock(spinlock_t *lock)
+static void __spin_unlock(spinlock_t *lock)
 {
 	__smp_store_release(&lock->owner, lock->owner + 1);
 }
+
+#endif
+
+bool spin_trylock(spinlock_t *lock)
+{
+	if (!__spin_trylock(lock))
+		return false;
+
+#ifdef CONFIG_SBI_LOCKSTAT
+	sbi_lockstat_acquired(lock, (unsigned long)__builtin_return_address(0),
+			      false, 0);
+#endif
+	return true;
+}
+
+void spin_lock(spinlock_t *lock)
+{
+#ifdef CONFIG_SBI_LOCKSTAT
+	unsigned long site = (unsigned long)__builtin_return_address(0);
+	unsigned long start;
+
+	if (__spin_trylock(lock)) {
+		sbi_lockstat_acquired(lock, site, false, 0);
+		return;
+	}
+
+	start = csr_read(CSR_MCYCLE);
+	__spin_lock(lock);
+	sbi_lockstat_acquired(lock, site, true, csr_read(CSR_MCYCLE) - start);
+#else
+	__spin_lock(lock);
+#endif
+}
+
+void spin_unlock(spinlock_t *lock)
+{
+#ifdef CONFIG_SBI_LOCKSTAT
+	sbi_lockstat_released(lock);
+#endif
+	__spin_unlock(lock);
+}
@@ -28,7 +28,7 @@ static bool domain_finalized = false;
 
 static struct sbi_hartmask root_hmask = { 0 };
 
-#define ROOT_REGION_MAX	16
+#define ROOT_REGION_MAX	CONFIG_SBI_DOMAIN_ROOT_REGIONS
 static u32 root_memregs_count = 0;
 static struct sbi_domain_memregion root_memregs[ROOT_REGION_MAX + 1] = { 0 };
 
@@ -38,6 +38,7 @@ struct sbi_domain root = {
 	.regions = root_memregs,
 	.system_reset_allowed = true,
 	.system_suspend_allowed = true,
+	.trap_delegation_allowed = true,
 	.fw_region_inited = false,
 };
 
@@ -458,6 +459,12 @@ void sbi_domain_dump(const struct sbi_domain *dom, const char *suffix)
 
 	sbi_printf("Domain%d SysSuspend  %s: %s\n",
 		   dom->index, suffix, (dom->system_suspend_allowed) ? "yes" : "no");
+
+	sbi_printf("Domain%d TrapDeleg   %s: %s\n",
+		   dom->index, suffix, (dom->trap_delegation_allowed) ? "yes" : "no");
+
+	sbi_printf("Domain%d DomSwitch   %s: %s\n",
+		   dom->index, suffix, (dom->domain_switch_allowed) ? "yes" : "no");
 }
 
 void sbi_domain_dump_all(const char *suffix)
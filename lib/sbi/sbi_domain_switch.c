@@ -0,0 +1,371 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Runtime switching of HARTs between domains
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#include <sbi/riscv_asm.h>
+#include <sbi/riscv_encoding.h>
+#include <sbi/riscv_locks.h>
+#include <sbi/sbi_domain.h>
+#include <sbi/sbi_domain_switch.h>
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_fwft.h>
+#include <sbi/sbi_hart.h>
+#include <sbi/sbi_hart_pmp.h>
+#include <sbi/sbi_hartmask.h>
+#include <sbi/sbi_hsm.h>
+#include <sbi/sbi_scratch.h>
+#include <sbi/sbi_string.h>
+#include <sbi/sbi_timer.h>
+#include <sbi/sbi_trap.h>
+
+/** S-mode context of a domain saved on a HART */
+struct domain_switch_context {
+	/** Domain owning this context or NULL if unused */
+	const struct sbi_domain *dom;
+	struct sbi_trap_regs regs;
+	unsigned long sie;
+	unsigned long stvec;
+	unsigned long sscratch;
+	unsigned long sepc;
+	unsigned long scause;
+	unsigned long stval;
+	unsigned long sip;
+	unsigned long satp;
+	unsigned long scounteren;
+	unsigned long senvcfg;
+	/** Pending S-mode timer event */
+	u64 stimer;
+	/** Firmware features including trap delegation */
+	struct sbi_fwft_state fwft;
+};
+
+/** Per-HART domain switch state */
+struct domain_switch_state {
+	struct domain_switch_context ctx[CONFIG_SBI_DOMAIN_SWITCH_CONTEXTS];
+	/* Context taking the trap registers of the domain being left */
+	struct domain_switch_context *save_ctx;
+	/* Context to resume or NULL to enter jump_dom at its next address */
+	struct domain_switch_context *jump_ctx;
+	const struct sbi_domain *jump_dom;
+};
+
+/** PMP image of a domain for one kind of PMP implementation */
+struct domain_pmp_image {
+	const struct sbi_domain *dom;
+	unsigned int pmp_count;
+	unsigned long pmp_gran;
+	unsigned int pmp_addr_bits;
+	struct sbi_hart_pmp_plan plan;
+};
+
+static unsigned long domain_switch_offset;
+
+static struct domain_pmp_image
+	pmp_images[CONFIG_SBI_DOMAIN_SWITCH_PMP_IMAGES];
+static unsigned int pmp_images_count;
+static spinlock_t pmp_images_lock = SPIN_LOCK_INITIALIZER;
+
+/* Protects the HART assignment of domains */
+static spinlock_t domain_assign_lock = SPIN_LOCK_INITIALIZER;
+
+/*
+ * Get the PMP image of a domain for the current HART. Images are
+ * prepared once and never change afterwards. When there is no room
+ * left for another image, the plan is prepared in the temporary space.
+ */
+static int domain_pmp_image(struct sbi_scratch *scratch,
+			    const struct sbi_domain *dom,
+			    struct sbi_hart_pmp_plan *tmp,
+			    const struct sbi_hart_pmp_plan **out_plan)
+{
+	unsigned int i, pmp_count = sbi_hart_pmp_count(scratch);
+	unsigned int pmp_addr_bits = sbi_hart_pmp_addrbits(scratch);
+	unsigned long pmp_gran = sbi_hart_pmp_granularity(scratch);
+	struct domain_pmp_image *img = NULL;
+	int rc;
+
+	spin_lock(&pmp_images_lock);
+
+	for (i = 0; i < pmp_images_count; i++) {
+		img = &pmp_images[i];
+		if (img->dom == dom && img->pmp_count == pmp_count &&
+		    img->pmp_gran == pmp_gran &&
+		    img->pmp_addr_bits == pmp_addr_bits) {
+			spin_unlock(&pmp_images_lock);
+			*out_plan = &img->plan;
+			return 0;
+		}
+	}
+
+	img = NULL;
+	if (pmp_images_count < CONFIG_SBI_DOMAIN_SWITCH_PMP_IMAGES)
+		img = &pmp_images[pmp_images_count];
+
+	rc = sbi_hart_pmp_plan(dom, pmp_count, pmp_gran, pmp_addr_bits,
+			       (img) ? &img->plan : tmp);
+	if (!rc && img) {
+		img->dom = dom;
+		img->pmp_count = pmp_count;
+		img->pmp_gran = pmp_gran;
+		img->pmp_addr_bits = pmp_addr_bits;
+		pmp_images_count++;
+	}
+
+	spin_unlock(&pmp_images_lock);
+
+	*out_plan = (img) ? &img->plan : tmp;
+	return rc;
+}
+
+/*
+ * The trap registers are saved by sbi_domain_switch_jump() so that the
+ * context being resumed can be saved over in the meantime.
+ */
+static void domain_context_save(struct sbi_scratch *scratch,
+				struct domain_switch_context *ctx)
+{
+	ctx->sie = csr_read(CSR_SIE);
+	ctx->stvec = csr_read(CSR_STVEC);
+	ctx->sscratch = csr_read(CSR_SSCRATCH);
+	ctx->sepc = csr_read(CSR_SEPC);
+	ctx->scause = csr_read(CSR_SCAUSE);
+	ctx->stval = csr_read(CSR_STVAL);
+	ctx->sip = csr_read(CSR_SIP);
+	ctx->satp = csr_read(CSR_SATP);
+	ctx->scounteren = csr_read(CSR_SCOUNTEREN);
+	if (sbi_hart_priv_version(scratch) >= SBI_HART_PRIV_VER_1_12)
+		ctx->senvcfg = csr_read(CSR_SENVCFG);
+	ctx->stimer = sbi_timer_smode_event_save();
+	sbi_fwft_save(scratch, &ctx->fwft);
+}
+
+static void domain_context_restore(struct sbi_scratch *scratch,
+				   const struct domain_switch_context *ctx)
+{
+	csr_write(CSR_SIE, ctx->sie);
+	csr_write(CSR_STVEC, ctx->stvec);
+	csr_write(CSR_SSCRATCH, ctx->sscratch);
+	csr_write(CSR_SEPC, ctx->sepc);
+	csr_write(CSR_SCAUSE, ctx->scause);
+	csr_write(CSR_STVAL, ctx->stval);
+	csr_write(CSR_SIP, ctx->sip);
+	csr_write(CSR_SATP, ctx->satp);
+	csr_write(CSR_SCOUNTEREN, ctx->scounteren);
+	if (sbi_hart_priv_version(scratch) >= SBI_HART_PRIV_VER_1_12)
+		csr_write(CSR_SENVCFG, ctx->senvcfg);
+	sbi_timer_smode_event_restore(ctx->stimer);
+	sbi_fwft_restore(scratch, &ctx->fwft);
+}
+
+/* Reset the S-mode CSRs for entering a domain at its next address */
+static void domain_context_reset(struct sbi_scratch *scratch,
+				 const struct sbi_domain *dom)
+{
+	csr_write(CSR_SIE, 0);
+	csr_write(CSR_SIP, 0);
+	csr_write(CSR_SATP, 0);
+	csr_write(CSR_STVEC, dom->next_addr);
+	csr_write(CSR_SSCRATCH, 0);
+	csr_write(CSR_SEPC, 0);
+	csr_write(CSR_SCAUSE, 0);
+	csr_write(CSR_STVAL, 0);
+	sbi_timer_smode_event_restore(-1ULL);
+	sbi_fwft_restore(scratch, NULL);
+}
+
+/* Enter a domain at its next address like sbi_hart_switch_mode() */
+static void domain_context_enter(const struct sbi_domain *dom, u32 hartid,
+				 struct sbi_trap_regs *regs)
+{
+	unsigned long mstatus = regs->mstatus;
+
+	mstatus = INSERT_FIELD(mstatus, MSTATUS_MPP, dom->next_mode);
+	mstatus &= ~(MSTATUS_MPIE | MSTATUS_SIE | MSTATUS_SPIE |
+		     MSTATUS_SPP);
+#if __riscv_xlen == 64
+	mstatus &= ~MSTATUS_MPV;
+#endif
+
+	sbi_memset(regs, 0, sizeof(*regs));
+	regs->a0 = hartid;
+	regs->a1 = dom->next_arg1;
+	regs->mepc = dom->next_addr;
+	regs->mstatus = mstatus;
+}
+
+/*
+ * Is the domain running on any HART other than the current one or does
+ * another HART hold a saved context of it ? Called with the domain
+ * assignment lock held.
+ */
+static bool domain_is_started(const struct sbi_domain *dom, u32 hartid)
+{
+	struct domain_switch_state *ds;
+	struct sbi_scratch *scratch;
+	unsigned int j;
+	u32 i;
+
+	sbi_hartmask_for_each_hart(i, &dom->assigned_harts) {
+		if (i != hartid &&
+		    __sbi_hsm_hart_get_state(i) != SBI_HSM_STATE_STOPPED)
+			return true;
+	}
+
+	sbi_hartmask_for_each_hart(i, dom->possible_harts) {
+		scratch = sbi_hartid_to_scratch(i);
+		if (i == hartid || !scratch)
+			continue;
+		ds = sbi_scratch_offset_ptr(scratch, domain_switch_offset);
+		for (j = 0; j < CONFIG_SBI_DOMAIN_SWITCH_CONTEXTS; j++) {
+			if (ds->ctx[j].dom == dom)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+int sbi_domain_switch(const struct sbi_trap_regs *regs, u32 dom_index)
+{
+	struct domain_switch_context *ctx, *save_ctx = NULL, *load_ctx = NULL;
+	struct domain_switch_context loaded;
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+	struct sbi_domain *dom = sbi_domain_thishart_ptr();
+	const struct sbi_hart_pmp_plan *plan = NULL;
+	struct sbi_hart_pmp_plan tmp;
+	struct domain_switch_state *ds;
+	u32 hartid = current_hartid();
+	struct sbi_domain *tdom;
+	unsigned int i;
+	int rc;
+
+	if (!domain_switch_offset)
+		return SBI_ENOTSUPP;
+	ds = sbi_scratch_offset_ptr(scratch, domain_switch_offset);
+
+	if (SBI_DOMAIN_MAX_INDEX <= dom_index)
+		return SBI_EINVAL;
+	tdom = sbi_index_to_domain(dom_index);
+	if (!tdom)
+		return SBI_EINVAL;
+	if (tdom == dom)
+		return SBI_EALREADY;
+
+	/* Policy checks */
+	if (!dom->domain_switch_allowed ||
+	    !sbi_hartmask_test_hart(hartid, tdom->possible_harts))
+		return SBI_EDENIED;
+#if __riscv_xlen == 32
+	if (regs->mstatusH & MSTATUSH_MPV)
+		return SBI_EDENIED;
+#else
+	if (regs->mstatus & MSTATUS_MPV)
+		return SBI_EDENIED;
+#endif
+
+	if (sbi_hart_pmp_count(scratch)) {
+		rc = domain_pmp_image(scratch, tdom, &tmp, &plan);
+		if (rc)
+			return rc;
+		rc = sbi_hart_pmp_plan_check(plan,
+					sbi_hart_pmp_configured(scratch));
+		if (rc)
+			return rc;
+	}
+
+	/* The context being resumed is replaced by the saved one */
+	for (i = 0; i < CONFIG_SBI_DOMAIN_SWITCH_CONTEXTS; i++) {
+		ctx = &ds->ctx[i];
+		if (ctx->dom == tdom)
+			load_ctx = save_ctx = ctx;
+		else if (!save_ctx && (!ctx->dom || ctx->dom == dom))
+			save_ctx = ctx;
+	}
+	if (!save_ctx)
+		return SBI_ENOSPC;
+
+	spin_lock(&domain_assign_lock);
+
+	/*
+	 * Without a saved context the HART enters the domain at its boot
+	 * address which is only right if the domain is not running yet.
+	 */
+	if (!load_ctx && domain_is_started(tdom, hartid)) {
+		spin_unlock(&domain_assign_lock);
+		return SBI_EDENIED;
+	}
+
+	sbi_hartmask_clear_hart(hartid, &dom->assigned_harts);
+	sbi_hartmask_set_hart(hartid, &tdom->assigned_harts);
+	hartid_to_domain_table[hartid] = tdom;
+	if (load_ctx)
+		load_ctx->dom = NULL;
+	save_ctx->dom = dom;
+	spin_unlock(&domain_assign_lock);
+
+	if (load_ctx)
+		loaded = *load_ctx;
+	domain_context_save(scratch, save_ctx);
+
+	/* Firmware features depend on the domain so restore them after */
+	if (load_ctx)
+		domain_context_restore(scratch, &loaded);
+	else
+		domain_context_reset(scratch, tdom);
+
+	/* Register state is not preserved so none of it may leak */
+	sbi_hart_fp_vector_reset(scratch);
+
+	if (plan)
+		sbi_hart_pmp_load(scratch, plan);
+
+	/* One flush covers both the new satp and the new PMP entries */
+	sbi_hart_pmp_flush();
+
+	ds->save_ctx = save_ctx;
+	ds->jump_ctx = load_ctx;
+	ds->jump_dom = tdom;
+
+	return SBI_EJUMP;
+}
+
+void sbi_domain_switch_jump(struct sbi_trap_regs *regs)
+{
+	struct domain_switch_state *ds =
+		sbi_scratch_thishart_offset_ptr(domain_switch_offset);
+	struct sbi_trap_regs saved = *regs;
+
+	/* Resume after the ecall with a successful return */
+	saved.mepc += 4;
+	saved.a0 = SBI_SUCCESS;
+	saved.a1 = 0;
+
+	if (ds->jump_ctx)
+		*regs = ds->jump_ctx->regs;
+	else
+		domain_context_enter(ds->jump_dom, current_hartid(), regs);
+	ds->save_ctx->regs = saved;
+
+	ds->save_ctx = NULL;
+	ds->jump_ctx = NULL;
+	ds->jump_dom = NULL;
+}
+
+int sbi_domain_switch_init(bool cold_boot)
+{
+	if (cold_boot) {
+		domain_switch_offset = sbi_scratch_alloc_offset(
+					sizeof(struct domain_switch_state));
+		if (!domain_switch_offset)
+			return SBI_ENOMEM;
+	}
+
+	return 0;
+}
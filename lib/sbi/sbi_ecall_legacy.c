@@ -30,7 +30,7 @@ static int sbi_load_hart_mask_unpriv(ulong *pmask, ulong *hmask,
 	ulong mask = 0;
 
 	if (pmask) {
-		mask = sbi_load_ulong(pmask, uptrap);
+		sbi_copy_from_unpriv(&mask, (ulong)pmask, sizeof(mask), uptrap);
 		if (uptrap->cause)
 			return SBI_ETRAP;
 	} else {
@@ -0,0 +1,181 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#include <sbi/sbi_domain.h>
+#include <sbi/sbi_domain_switch.h>
+#include <sbi/sbi_ecall.h>
+#include <sbi/sbi_ecall_interface.h>
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_hsm.h>
+#include <sbi/sbi_lockstat.h>
+#include <sbi/sbi_pmu.h>
+#include <sbi/sbi_scratch.h>
+#include <sbi/sbi_trap.h>
+#include <sbi/riscv_asm.h>
+
+static int opensbi_hsm_hart_start_many(const struct sbi_trap_regs *regs,
+				       ulong smode)
+{
+	ulong m, count = 0;
+	const struct sbi_domain *dom = sbi_domain_thishart_ptr();
+
+	/* Refer comments in opensbi_read() below */
+#if __riscv_xlen == 32
+	if (regs->a4)
+		return SBI_ERR_FAILED;
+#endif
+
+	/* One opaque value for each HART set in the HART mask */
+	for (m = regs->a0; m; m >>= 1)
+		count += m & 1UL;
+	if (!count ||
+	    !sbi_domain_check_addr_range(dom, regs->a3,
+					 count * sizeof(ulong), smode,
+					 SBI_DOMAIN_READ))
+		return SBI_ERR_INVALID_PARAM;
+
+	return sbi_hsm_hart_start_many(sbi_scratch_thishart_ptr(), dom,
+				       regs->a0, regs->a1, regs->a2,
+				       smode, (const ulong *)regs->a3);
+}
+
+/* Copy entries of a statistics buffer to supervisor memory */
+typedef int (*opensbi_read_fn)(void *out, unsigned long num,
+			       unsigned long flags, unsigned long *out_num);
+
+static int opensbi_pmu_sample_read(void *out, unsigned long num,
+				   unsigned long flags, unsigned long *out_num)
+{
+	return sbi_pmu_sample_read((unsigned long)out, num, out_num);
+}
+
+static int opensbi_trap_hotspot_read(void *out, unsigned long num,
+				     unsigned long flags,
+				     unsigned long *out_num)
+{
+	*out_num = sbi_trap_hotspot_read(out, num,
+			(flags & SBI_TRAP_HOTSPOT_FLAG_RESET) ? true : false);
+	return 0;
+}
+
+static int opensbi_hsm_suspend_stats_read(void *out, unsigned long num,
+					  unsigned long flags,
+					  unsigned long *out_num)
+{
+	*out_num = sbi_hsm_suspend_stats_read(out, num,
+			(flags & SBI_HSM_SUSPEND_STATS_FLAG_RESET) ?
+			true : false);
+	return 0;
+}
+
+static int opensbi_lockstat_read(void *out, unsigned long num,
+				 unsigned long flags, unsigned long *out_num)
+{
+	*out_num = sbi_lockstat_read(out, num,
+			(flags & SBI_LOCKSTAT_FLAG_RESET) ? true : false);
+	return 0;
+}
+
+/*
+ * Read up to a0 entries of entry_size bytes into the supervisor buffer
+ * at a1 (a2 holds the upper address bits on RV32) with flags in a3. A
+ * count above max is either clamped to max or rejected.
+ */
+static int opensbi_read(const struct sbi_trap_regs *regs, ulong smode,
+			unsigned long max, bool clamp,
+			unsigned long entry_size, opensbi_read_fn read,
+			unsigned long *out_val)
+{
+	unsigned long num = regs->a0;
+
+	/*
+	 * On RV32, the M-mode can only access the first 4GB of
+	 * the physical address space so we simply fail if the
+	 * upper 32bits of the physical address (i.e. a2 register)
+	 * is non-zero.
+	 */
+#if __riscv_xlen == 32
+	if (regs->a2)
+		return SBI_ERR_FAILED;
+#endif
+
+	if (max < num) {
+		if (!clamp)
+			return SBI_ERR_INVALID_PARAM;
+		num = max;
+	}
+
+	if (!sbi_domain_check_addr_range(sbi_domain_thishart_ptr(),
+					 regs->a1, num * entry_size, smode,
+					 SBI_DOMAIN_READ|SBI_DOMAIN_WRITE))
+		return SBI_ERR_INVALID_PARAM;
+
+	return read((void *)regs->a1, num, regs->a3, out_val);
+}
+
+static int sbi_ecall_opensbi_handler(unsigned long extid, unsigned long funcid,
+				     const struct sbi_trap_regs *regs,
+				     unsigned long *out_val,
+				     struct sbi_trap_info *out_trap)
+{
+	ulong smode = (csr_read(CSR_MSTATUS) & MSTATUS_MPP) >>
+			MSTATUS_MPP_SHIFT;
+	int ret;
+
+	switch (funcid) {
+	case SBI_EXT_OPENSBI_PMU_SAMPLE_START:
+		return sbi_pmu_sample_start(regs->a0, regs->a1, regs->a2);
+	case SBI_EXT_OPENSBI_PMU_SAMPLE_STOP:
+		return sbi_pmu_sample_stop();
+	case SBI_EXT_OPENSBI_PMU_SAMPLE_READ:
+		/* The ring never holds more than SBI_PMU_SAMPLE_MAX samples */
+		return opensbi_read(regs, smode, SBI_PMU_SAMPLE_MAX, true,
+				    sizeof(struct sbi_pmu_sample),
+				    opensbi_pmu_sample_read, out_val);
+	case SBI_EXT_OPENSBI_TRAP_HOTSPOT_READ:
+		return opensbi_read(regs, smode, SBI_TRAP_HOTSPOT_MAX, false,
+				    sizeof(struct sbi_trap_hotspot),
+				    opensbi_trap_hotspot_read, out_val);
+	case SBI_EXT_OPENSBI_HSM_HART_START_MANY:
+		return opensbi_hsm_hart_start_many(regs, smode);
+	case SBI_EXT_OPENSBI_HSM_SUSPEND_STATS_READ:
+		return opensbi_read(regs, smode, SBI_HSM_SUSPEND_STATS_MAX, false,
+				    sizeof(struct sbi_hsm_suspend_stats),
+				    opensbi_hsm_suspend_stats_read, out_val);
+	case SBI_EXT_OPENSBI_DOMAIN_SWITCH:
+		if (smode != PRV_S)
+			return SBI_ERR_DENIED;
+		ret = sbi_domain_switch(regs, regs->a0);
+		if (ret == SBI_ENOSPC)
+			ret = SBI_ERR_FAILED;
+		return ret;
+	case SBI_EXT_OPENSBI_LOCKSTAT_READ:
+		return opensbi_read(regs, smode, SBI_LOCKSTAT_MAX, false,
+				    sizeof(struct sbi_lockstat),
+				    opensbi_lockstat_read, out_val);
+	default:
+		break;
+	}
+
+	return SBI_ENOTSUPP;
+}
+
+static void sbi_ecall_opensbi_jump(unsigned long extid, unsigned long funcid,
+				   struct sbi_trap_regs *regs)
+{
+	if (funcid == SBI_EXT_OPENSBI_DOMAIN_SWITCH)
+		sbi_domain_switch_jump(regs);
+}
+
+struct sbi_ecall_extension ecall_opensbi = {
+	.extid_start = SBI_EXT_OPENSBI,
+	.extid_end = SBI_EXT_OPENSBI,
+	.handle = sbi_ecall_opensbi_handler,
+	.jump = sbi_ecall_opensbi_jump,
+};
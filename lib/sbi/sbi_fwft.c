@@ -0,0 +1,207 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Firmware features of the current HART
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#include <sbi/riscv_asm.h>
+#include <sbi/riscv_encoding.h>
+#include <sbi/sbi_bitops.h>
+#include <sbi/sbi_domain.h>
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_fwft.h>
+#include <sbi/sbi_scratch.h>
+#include <sbi/sbi_string.h>
+
+/** Firmware feature operations */
+struct fwft_feature {
+	/** Check whether feature is supported on current HART */
+	bool (*supported)(void);
+	/**
+	 * Apply a validated feature value on current HART. Applying zero
+	 * must also work when the feature is not supported.
+	 */
+	int (*apply)(unsigned long value);
+};
+
+static unsigned long fwft_state_offset;
+
+/*
+ * Misaligned fetch is always delegated by sbi_hart_init() so only
+ * misaligned load/store which are emulated by default can be toggled.
+ */
+#define FWFT_MISALIGNED_DELEG_MASK	((1UL << CAUSE_MISALIGNED_LOAD) | \
+					 (1UL << CAUSE_MISALIGNED_STORE))
+
+static bool fwft_misaligned_deleg_supported(void)
+{
+	const struct sbi_domain *dom = sbi_domain_thishart_ptr();
+
+	/* No delegation possible without medeleg */
+	if (!misa_extension('S'))
+		return false;
+
+	return (dom && dom->trap_delegation_allowed) ? true : false;
+}
+
+static int fwft_misaligned_deleg_apply(unsigned long value)
+{
+	if (!misa_extension('S'))
+		return 0;
+
+	if (value)
+		csr_set(CSR_MEDELEG, FWFT_MISALIGNED_DELEG_MASK);
+	else
+		csr_clear(CSR_MEDELEG, FWFT_MISALIGNED_DELEG_MASK);
+
+	return 0;
+}
+
+static const struct fwft_feature features[SBI_FWFT_FEATURE_MAX] = {
+	[SBI_FWFT_MISALIGNED_EXC_DELEG] = {
+		.supported = fwft_misaligned_deleg_supported,
+		.apply = fwft_misaligned_deleg_apply,
+	},
+};
+
+static const struct fwft_feature *fwft_get_feature(u32 feature)
+{
+	const struct fwft_feature *feat;
+
+	if (SBI_FWFT_FEATURE_MAX <= feature)
+		return NULL;
+
+	feat = &features[feature];
+	if (!feat->supported || !feat->supported())
+		return NULL;
+
+	return feat;
+}
+
+int sbi_fwft_set(u32 feature, unsigned long value, unsigned long flags)
+{
+	int rc;
+	struct sbi_fwft_state *fs;
+	const struct fwft_feature *feat;
+
+	if (!fwft_state_offset)
+		return SBI_ENOTSUPP;
+
+	if (flags & ~SBI_FWFT_SET_FLAG_LOCK)
+		return SBI_EINVAL;
+
+	feat = fwft_get_feature(feature);
+	if (!feat)
+		return SBI_ENOTSUPP;
+
+	/* All features implemented so far are boolean */
+	if (value > 1)
+		return SBI_EINVAL;
+
+	fs = sbi_scratch_thishart_offset_ptr(fwft_state_offset);
+	if (fs->locked & BIT(feature))
+		return SBI_EDENIED;
+
+	rc = feat->apply(value);
+	if (rc)
+		return rc;
+
+	fs->values[feature] = value;
+	if (flags & SBI_FWFT_SET_FLAG_LOCK)
+		fs->locked |= BIT(feature);
+
+	return 0;
+}
+
+int sbi_fwft_get(u32 feature, unsigned long *out_val)
+{
+	struct sbi_fwft_state *fs;
+
+	if (!fwft_state_offset || !fwft_get_feature(feature))
+		return SBI_ENOTSUPP;
+
+	fs = sbi_scratch_thishart_offset_ptr(fwft_state_offset);
+	*out_val = fs->values[feature];
+
+	return 0;
+}
+
+void sbi_fwft_reinit(struct sbi_scratch *scratch)
+{
+	u32 i;
+	const struct fwft_feature *feat;
+	struct sbi_fwft_state *fs;
+
+	if (!fwft_state_offset)
+		return;
+
+	fs = sbi_scratch_offset_ptr(scratch, fwft_state_offset);
+	for (i = 0; i < SBI_FWFT_FEATURE_MAX; i++) {
+		feat = fwft_get_feature(i);
+		if (feat && fs->values[i])
+			feat->apply(fs->values[i]);
+	}
+}
+
+void sbi_fwft_save(struct sbi_scratch *scratch, struct sbi_fwft_state *st)
+{
+	if (!fwft_state_offset) {
+		sbi_memset(st, 0, sizeof(*st));
+		return;
+	}
+
+	sbi_memcpy(st, sbi_scratch_offset_ptr(scratch, fwft_state_offset),
+		   sizeof(*st));
+}
+
+void sbi_fwft_restore(struct sbi_scratch *scratch,
+		      const struct sbi_fwft_state *st)
+{
+	u32 i;
+	struct sbi_fwft_state *fs;
+
+	if (!fwft_state_offset)
+		return;
+
+	fs = sbi_scratch_offset_ptr(scratch, fwft_state_offset);
+	if (st)
+		sbi_memcpy(fs, st, sizeof(*fs));
+	else
+		sbi_memset(fs, 0, sizeof(*fs));
+
+	/* Unlike sbi_fwft_reinit(), default values are applied as well */
+	for (i = 0; i < SBI_FWFT_FEATURE_MAX; i++) {
+		if (!features[i].apply)
+			continue;
+		if (!fwft_get_feature(i))
+			fs->values[i] = 0;
+		features[i].apply(fs->values[i]);
+	}
+}
+
+int sbi_fwft_init(struct sbi_scratch *scratch, bool cold_boot)
+{
+	struct sbi_fwft_state *fs;
+
+	if (cold_boot) {
+		fwft_state_offset = sbi_scratch_alloc_offset(sizeof(*fs));
+		if (!fwft_state_offset)
+			return SBI_ENOMEM;
+	} else if (!fwft_state_offset) {
+		return SBI_ENOMEM;
+	}
+
+	/*
+	 * Features requested by supervisor software do not survive
+	 * a HART stop so start every HART with the default values.
+	 */
+	fs = sbi_scratch_offset_ptr(scratch, fwft_state_offset);
+	sbi_memset(fs, 0, sizeof(*fs));
+
+	return 0;
+}
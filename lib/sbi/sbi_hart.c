@@ -11,12 +11,14 @@
 #include <sbi/riscv_barrier.h>
 #include <sbi/riscv_encoding.h>
 #include <sbi/riscv_fp.h>
+#include <sbi/riscv_locks.h>
 #include <sbi/sbi_bitops.h>
 #include <sbi/sbi_console.h>
 #include <sbi/sbi_domain.h>
 #include <sbi/sbi_csr_detect.h>
 #include <sbi/sbi_error.h>
 #include <sbi/sbi_hart.h>
+#include <sbi/sbi_hart_pmp.h>
 #include <sbi/sbi_math.h>
 #include <sbi/sbi_platform.h>
 #include <sbi/sbi_pmu.h>
@@ -31,23 +33,41 @@ void (*sbi_hart_expected_trap)(void) = &__sbi_expected_trap;
 
 static unsigned long hart_features_offset;
 
-static void mstatus_init(struct sbi_scratch *scratch)
+/* Maximum number of PMP entries captured in the HART context */
+#define HART_CONTEXT_PMP_MAX		16
+#if __riscv_xlen == 32
+#define HART_CONTEXT_PMP_PER_CFG	4
+#else
+#define HART_CONTEXT_PMP_PER_CFG	8
+#endif
+#define HART_CONTEXT_PMPCFG_MAX		\
+	(HART_CONTEXT_PMP_MAX / HART_CONTEXT_PMP_PER_CFG)
+
+/** HART context saved before non-retentive suspend */
+struct hart_context {
+	bool valid;
+	unsigned long mstatus;
+	unsigned long medeleg;
+	unsigned long mideleg;
+	unsigned long menvcfg;
+#if __riscv_xlen == 32
+	unsigned long menvcfgh;
+#endif
+	uint64_t mstateen0;
+	/* Number of PMP entries programmed by sbi_hart_pmp_configure() */
+	unsigned int pmp_configured;
+	unsigned int pmp_used;
+	unsigned long pmpcfg[HART_CONTEXT_PMPCFG_MAX];
+	unsigned long pmpaddr[HART_CONTEXT_PMP_MAX];
+};
+
+static unsigned long hart_context_offset;
+
+static void mcounter_init(struct sbi_scratch *scratch)
 {
-	unsigned long menvcfg_val, mstatus_val = 0;
 	int cidx;
 	unsigned int num_mhpm = sbi_hart_mhpm_count(scratch);
 	uint64_t mhpmevent_init_val = 0;
-	uint64_t mstateen_val;
-
-	/* Enable FPU */
-	if (misa_extension('D') || misa_extension('F'))
-		mstatus_val |=  MSTATUS_FS;
-
-	/* Enable Vector context */
-	if (misa_extension('V'))
-		mstatus_val |=  MSTATUS_VS;
-
-	csr_write(CSR_MSTATUS, mstatus_val);
 
 	/* Disable user mode usage of all perf counters except default ones (CY, TM, IR) */
 	if (misa_extension('S') &&
@@ -83,6 +103,24 @@ static void mstatus_init(struct sbi_scratch *scratch)
 		csr_write_num(CSR_MHPMEVENT3 + cidx, mhpmevent_init_val);
 #endif
 	}
+}
+
+static void mstatus_init(struct sbi_scratch *scratch)
+{
+	unsigned long menvcfg_val, mstatus_val = 0;
+	uint64_t mstateen_val;
+
+	/* Enable FPU */
+	if (misa_extension('D') || misa_extension('F'))
+		mstatus_val |=  MSTATUS_FS;
+
+	/* Enable Vector context */
+	if (misa_extension('V'))
+		mstatus_val |=  MSTATUS_VS;
+
+	csr_write(CSR_MSTATUS, mstatus_val);
+
+	mcounter_init(scratch);
 
 	if (sbi_hart_has_extension(scratch, SBI_HART_EXT_SMSTATEEN)) {
 		mstateen_val = csr_read(CSR_MSTATEEN0);
@@ -158,6 +196,20 @@ static void mstatus_init(struct sbi_scratch *scratch)
 #endif
 		}
 
+		/*
+		 * Delegate counters to S-mode if Smcdeleg extension is
+		 * present in the hardware. The S-mode can then configure
+		 * and read the counters enabled in mcounteren directly
+		 * using the siselect/sireg indirect CSR access.
+		 */
+		if (sbi_hart_has_extension(scratch, SBI_HART_EXT_SMCDELEG)) {
+#if __riscv_xlen == 32
+			csr_set(CSR_MENVCFGH, ENVCFGH_CDE);
+#else
+			menvcfg_val |= ENVCFG_CDE;
+#endif
+		}
+
 		csr_write(CSR_MENVCFG, menvcfg_val);
 	}
 
@@ -190,6 +242,28 @@ static int fp_init(struct sbi_scratch *scratch)
 	return 0;
 }
 
+void sbi_hart_fp_vector_reset(struct sbi_scratch *scratch)
+{
+	fp_init(scratch);
+
+	if (!misa_extension('V') || !(csr_read(CSR_MSTATUS) & MSTATUS_VS))
+		return;
+
+	/*
+	 * vsetvli t0, zero, e8, m8, ta, ma followed by vmv.v.i with
+	 * v0, v8, v16 and v24 clears all 32 vector registers. Encoded
+	 * as words so that the compiler needs no vector support.
+	 */
+	__asm__ __volatile__(".word 0x0c3072d7\n"
+			     ".word 0x5e003057\n"
+			     ".word 0x5e003457\n"
+			     ".word 0x5e003857\n"
+			     ".word 0x5e003c57\n"
+			     : : : "t0", "memory");
+	csr_write(CSR_VSTART, 0);
+	csr_write(CSR_VCSR, 0);
+}
+
 static int delegate_traps(struct sbi_scratch *scratch)
 {
 	const struct sbi_platform *plat = sbi_platform_ptr(scratch);
@@ -284,51 +358,8 @@ unsigned int sbi_hart_mhpm_bits(struct sbi_scratch *scratch)
 	return hfeatures->mhpm_bits;
 }
 
-int sbi_hart_pmp_configure(struct sbi_scratch *scratch)
+void sbi_hart_pmp_flush(void)
 {
-	struct sbi_domain_memregion *reg;
-	struct sbi_domain *dom = sbi_domain_thishart_ptr();
-	unsigned int pmp_idx = 0, pmp_flags, pmp_bits, pmp_gran_log2;
-	unsigned int pmp_count = sbi_hart_pmp_count(scratch);
-	unsigned long pmp_addr = 0, pmp_addr_max = 0;
-
-	if (!pmp_count)
-		return 0;
-
-	pmp_gran_log2 = log2roundup(sbi_hart_pmp_granularity(scratch));
-	pmp_bits = sbi_hart_pmp_addrbits(scratch) - 1;
-	pmp_addr_max = (1UL << pmp_bits) | ((1UL << pmp_bits) - 1);
-
-	sbi_domain_for_each_memregion(dom, reg) {
-		if (pmp_count <= pmp_idx)
-			break;
-
-		pmp_flags = 0;
-
-		/*
-		 * If permissions are to be enforced for all modes on this
-		 * region, the lock bit should be set.
-		 */
-		if (reg->flags & SBI_DOMAIN_MEMREGION_ENF_PERMISSIONS)
-			pmp_flags |= PMP_L;
-
-		if (reg->flags & SBI_DOMAIN_MEMREGION_SU_READABLE)
-			pmp_flags |= PMP_R;
-		if (reg->flags & SBI_DOMAIN_MEMREGION_SU_WRITABLE)
-			pmp_flags |= PMP_W;
-		if (reg->flags & SBI_DOMAIN_MEMREGION_SU_EXECUTABLE)
-			pmp_flags |= PMP_X;
-
-		pmp_addr =  reg->base >> PMP_SHIFT;
-		if (pmp_gran_log2 <= reg->order && pmp_addr < pmp_addr_max)
-			pmp_set(pmp_idx++, pmp_flags, reg->base, reg->order);
-		else {
-			sbi_printf("Can not configure pmp for domain %s", dom->name);
-			sbi_printf(" because memory region address %lx or size %lx is not in range\n",
-				    reg->base, reg->order);
-		}
-	}
-
 	/*
 	 * As per section 3.7.2 of privileged specification v1.12,
 	 * virtual address translations can be speculatively performed
@@ -349,10 +380,66 @@ int sbi_hart_pmp_configure(struct sbi_scratch *scratch)
 		if (misa_extension('H'))
 			__sbi_hfence_gvma_all();
 	}
+}
+
+int sbi_hart_pmp_configure(struct sbi_scratch *scratch)
+{
+	struct sbi_hart_pmp_plan plan;
+	struct sbi_domain *dom = sbi_domain_thishart_ptr();
+	unsigned int pmp_count = sbi_hart_pmp_count(scratch);
+	int rc;
+
+	if (!pmp_count)
+		return 0;
+
+	rc = sbi_hart_pmp_plan(dom, pmp_count,
+			       sbi_hart_pmp_granularity(scratch),
+			       sbi_hart_pmp_addrbits(scratch), &plan);
+	if (rc == SBI_ENOSPC && plan.unmerged) {
+		sbi_printf("%s: domain %s has more than %u memory regions"
+			   " left after merging and needs %u PMP entries but"
+			   " only %u are available\n", __func__, dom->name,
+			   SBI_HART_PMP_PLAN_MAX_RANGES, plan.needed,
+			   pmp_count);
+	} else if (rc == SBI_ENOSPC) {
+		sbi_printf("%s: domain %s needs %u PMP entries but only %u"
+			   " are available\n", __func__, dom->name,
+			   plan.needed, pmp_count);
+	} else if (rc) {
+		return rc;
+	}
+
+	sbi_hart_pmp_load(scratch, &plan);
+
+	sbi_hart_pmp_flush();
 
 	return 0;
 }
 
+unsigned int sbi_hart_pmp_configured(struct sbi_scratch *scratch)
+{
+	struct hart_context *ctx;
+
+	if (!hart_context_offset)
+		return 0;
+	ctx = sbi_scratch_offset_ptr(scratch, hart_context_offset);
+
+	return ctx->pmp_configured;
+}
+
+void sbi_hart_pmp_load(struct sbi_scratch *scratch,
+		       const struct sbi_hart_pmp_plan *plan)
+{
+	struct hart_context *ctx;
+
+	sbi_hart_pmp_plan_write(plan, sbi_hart_pmp_configured(scratch));
+
+	if (hart_context_offset) {
+		ctx = sbi_scratch_offset_ptr(scratch, hart_context_offset);
+		ctx->pmp_configured = plan->count;
+	}
+}
+
 int sbi_hart_priv_version(struct sbi_scratch *scratch)
 {
 	struct sbi_hart_features *hfeatures =
@@ -453,6 +540,12 @@ static inline char *sbi_hart_extension_id2string(int ext)
 	case SBI_HART_EXT_SMSTATEEN:
 		estr = "smstateen";
 		break;
+	case SBI_HART_EXT_SMCDELEG:
+		estr = "smcdeleg";
+		break;
+	case SBI_HART_EXT_SSCCFG:
+		estr = "ssccfg";
+		break;
 	default:
 		break;
 	}
@@ -555,17 +648,10 @@ static int hart_pmu_get_allowed_bits(void)
 	return num_bits;
 }
 
-static int hart_detect_features(struct sbi_scratch *scratch)
+static void hart_probe_features(struct sbi_hart_features *hfeatures)
 {
 	struct sbi_trap_info trap = {0};
-	struct sbi_hart_features *hfeatures =
-		sbi_scratch_offset_ptr(scratch, hart_features_offset);
 	unsigned long val, oldval;
-	int rc;
-
-	/* If hart features already detected then do nothing */
-	if (hfeatures->detected)
-		return 0;
 
 	/* Clear hart features */
 	hfeatures->extensions = 0;
@@ -700,6 +786,141 @@ __mhpm_skip:
 					SBI_HART_EXT_SMSTATEEN, true);
 	}
 
+	/*
+	 * Detect if hart supports counter delegation (Smcdeleg extension)
+	 * by checking whether menvcfg.CDE bit (which is WARL) is writable.
+	 */
+	if (hfeatures->priv_version >= SBI_HART_PRIV_VER_1_12) {
+#if __riscv_xlen == 32
+		oldval = csr_read(CSR_MENVCFGH);
+		csr_write(CSR_MENVCFGH, oldval | ENVCFGH_CDE);
+		val = csr_swap(CSR_MENVCFGH, oldval);
+		if (val & ENVCFGH_CDE)
+#else
+		oldval = csr_read(CSR_MENVCFG);
+		csr_write(CSR_MENVCFG, oldval | ENVCFG_CDE);
+		val = csr_swap(CSR_MENVCFG, oldval);
+		if (val & ENVCFG_CDE)
+#endif
+			__sbi_hart_update_extension(hfeatures,
+					SBI_HART_EXT_SMCDELEG, true);
+	}
+
+	/* Detect if hart supports scountinhibit CSR (Ssccfg extension) */
+	if (hfeatures->extensions & BIT(SBI_HART_EXT_SMCDELEG)) {
+		csr_read_allowed(CSR_SCOUNTINHIBIT, (unsigned long)&trap);
+		if (!trap.cause)
+			__sbi_hart_update_extension(hfeatures,
+					SBI_HART_EXT_SSCCFG, true);
+	}
+}
+
+#ifdef CONFIG_SBI_HART_FEATURES_CACHE
+
+/* Maximum number of distinct HART classes with cached features */
+#define HART_FEATURES_CLASS_MAX		8
+
+/** Features probed once for all HARTs of the same class */
+struct hart_features_class {
+	unsigned long mvendorid;
+	unsigned long marchid;
+	unsigned long mimpid;
+	unsigned long plat_class;
+	struct sbi_hart_features features;
+};
+
+static struct hart_features_class hart_classes[HART_FEATURES_CLASS_MAX];
+static unsigned int hart_classes_count;
+static spinlock_t hart_classes_lock = SPIN_LOCK_INITIALIZER;
+
+static void hart_features_class_get(struct hart_features_class *cls)
+{
+	cls->mvendorid = csr_read(CSR_MVENDORID);
+	cls->marchid = csr_read(CSR_MARCHID);
+	cls->mimpid = csr_read(CSR_MIMPID);
+	cls->plat_class = sbi_platform_hart_class(sbi_platform_thishart_ptr(),
+						  current_hartid());
+}
+
+static bool hart_features_class_valid(const struct hart_features_class *cls)
+{
+	/*
+	 * All IDs are zero when neither the HART nor the platform can tell
+	 * HARTs apart so such HARTs are always probed.
+	 */
+	return (cls->mvendorid || cls->marchid || cls->mimpid ||
+		cls->plat_class) ? true : false;
+}
+
+static bool hart_features_class_same(const struct hart_features_class *a,
+				     const struct hart_features_class *b)
+{
+	return (a->mvendorid == b->mvendorid && a->marchid == b->marchid &&
+		a->mimpid == b->mimpid && a->plat_class == b->plat_class) ?
+		true : false;
+}
+
+static void hart_features_cached_probe(struct sbi_hart_features *hfeatures)
+{
+	struct hart_features_class cls, *c;
+	unsigned int i;
+
+	hart_features_class_get(&cls);
+	if (!hart_features_class_valid(&cls)) {
+		hart_probe_features(hfeatures);
+		return;
+	}
+
+	spin_lock(&hart_classes_lock);
+	for (i = 0; i < hart_classes_count; i++) {
+		c = &hart_classes[i];
+		if (hart_features_class_same(c, &cls)) {
+			*hfeatures = c->features;
+			spin_unlock(&hart_classes_lock);
+			return;
+		}
+	}
+	spin_unlock(&hart_classes_lock);
+
+	/* Probe outside the lock so other classes are not held up */
+	hart_probe_features(hfeatures);
+
+	spin_lock(&hart_classes_lock);
+	for (i = 0; i < hart_classes_count; i++) {
+		if (hart_features_class_same(&hart_classes[i], &cls))
+			break;
+	}
+	if (i == hart_classes_count && i < HART_FEATURES_CLASS_MAX) {
+		c = &hart_classes[i];
+		*c = cls;
+		c->features = *hfeatures;
+		hart_classes_count++;
+	}
+	spin_unlock(&hart_classes_lock);
+}
+
+#else
+
+static void hart_features_cached_probe(struct sbi_hart_features *hfeatures)
+{
+	hart_probe_features(hfeatures);
+}
+
+#endif
+
+static int hart_detect_features(struct sbi_scratch *scratch)
+{
+	struct sbi_hart_features *hfeatures =
+		sbi_scratch_offset_ptr(scratch, hart_features_offset);
+	int rc;
+
+	/* If hart features already detected then do nothing */
+	if (hfeatures->detected)
+		return 0;
+
+	/* Probe (or copy from a HART of the same class) CSR features */
+	hart_features_cached_probe(hfeatures);
+
 	/* Let platform populate extensions */
 	rc = sbi_platform_extensions_init(sbi_platform_thishart_ptr(),
 					  hfeatures);
@@ -729,6 +950,109 @@ int sbi_hart_reinit(struct sbi_scratch *scratch)
 	return 0;
 }
 
+static inline int hart_context_pmpcfg_csr(unsigned int i)
+{
+#if __riscv_xlen == 32
+	return CSR_PMPCFG0 + i;
+#else
+	return CSR_PMPCFG0 + (i << 1);
+#endif
+}
+
+void sbi_hart_context_save(struct sbi_scratch *scratch)
+{
+	struct hart_context *ctx;
+	unsigned int i;
+
+	if (!hart_context_offset)
+		return;
+	ctx = sbi_scratch_offset_ptr(scratch, hart_context_offset);
+	ctx->valid = false;
+
+	ctx->pmp_used = ctx->pmp_configured;
+	if (HART_CONTEXT_PMP_MAX < ctx->pmp_used)
+		return;
+
+	ctx->mstatus = csr_read(CSR_MSTATUS) & (MSTATUS_FS | MSTATUS_VS);
+	if (misa_extension('S')) {
+		ctx->medeleg = csr_read(CSR_MEDELEG);
+		ctx->mideleg = csr_read(CSR_MIDELEG);
+	}
+	if (sbi_hart_priv_version(scratch) >= SBI_HART_PRIV_VER_1_12) {
+		ctx->menvcfg = csr_read(CSR_MENVCFG);
+#if __riscv_xlen == 32
+		ctx->menvcfgh = csr_read(CSR_MENVCFGH);
+#endif
+	}
+	if (sbi_hart_has_extension(scratch, SBI_HART_EXT_SMSTATEEN)) {
+		ctx->mstateen0 = csr_read(CSR_MSTATEEN0);
+#if __riscv_xlen == 32
+		ctx->mstateen0 |= ((uint64_t)csr_read(CSR_MSTATEEN0H)) << 32;
+#endif
+	}
+
+	for (i = 0; i < ctx->pmp_used; i++)
+		ctx->pmpaddr[i] = csr_read_num(CSR_PMPADDR0 + i);
+	for (i = 0; i * HART_CONTEXT_PMP_PER_CFG < ctx->pmp_used; i++)
+		ctx->pmpcfg[i] = csr_read_num(hart_context_pmpcfg_csr(i));
+
+	ctx->valid = true;
+}
+
+int sbi_hart_context_restore(struct sbi_scratch *scratch)
+{
+	struct hart_context *ctx;
+	unsigned int i;
+	int rc;
+
+	if (!hart_context_offset)
+		return SBI_ENOENT;
+	ctx = sbi_scratch_offset_ptr(scratch, hart_context_offset);
+	if (!ctx->valid)
+		return SBI_ENOENT;
+	ctx->valid = false;
+
+	/* Refer sbi_hart_init() */
+	csr_write(CSR_MIP, 0);
+
+	csr_write(CSR_MSTATUS, ctx->mstatus);
+	mcounter_init(scratch);
+
+	/* FP registers are lost with the HART state so reset them */
+	rc = fp_init(scratch);
+	if (rc)
+		return rc;
+
+	if (sbi_hart_has_extension(scratch, SBI_HART_EXT_SMSTATEEN)) {
+		csr_write(CSR_MSTATEEN0, ctx->mstateen0);
+#if __riscv_xlen == 32
+		csr_write(CSR_MSTATEEN0H, ctx->mstateen0 >> 32);
+#endif
+	}
+	if (sbi_hart_priv_version(scratch) >= SBI_HART_PRIV_VER_1_12) {
+#if __riscv_xlen == 32
+		csr_write(CSR_MENVCFGH, ctx->menvcfgh);
+#endif
+		csr_write(CSR_MENVCFG, ctx->menvcfg);
+	}
+	csr_write(CSR_MIE, 0);
+	if (misa_extension('S')) {
+		csr_write(CSR_SATP, 0);
+		csr_write(CSR_MIDELEG, ctx->mideleg);
+		csr_write(CSR_MEDELEG, ctx->medeleg);
+	}
+
+	/* PMP address must be written before a locked PMP config */
+	for (i = 0; i < ctx->pmp_used; i++)
+		csr_write_num(CSR_PMPADDR0 + i, ctx->pmpaddr[i]);
+	for (i = 0; i * HART_CONTEXT_PMP_PER_CFG < ctx->pmp_used; i++)
+		csr_write_num(hart_context_pmpcfg_csr(i), ctx->pmpcfg[i]);
+	if (ctx->pmp_used)
+		sbi_hart_pmp_flush();
+
+	return 0;
+}
+
 int sbi_hart_init(struct sbi_scratch *scratch, bool cold_boot)
 {
 	int rc;
@@ -747,6 +1071,11 @@ int sbi_hart_init(struct sbi_scratch *scratch, bool cold_boot)
 					sizeof(struct sbi_hart_features));
 		if (!hart_features_offset)
 			return SBI_ENOMEM;
+
+		hart_context_offset = sbi_scratch_alloc_offset(
+					sizeof(struct hart_context));
+		if (!hart_context_offset)
+			return SBI_ENOMEM;
 	}
 
 	rc = hart_detect_features(scratch);
@@ -0,0 +1,360 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * PMP entry planning for domain memory regions
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#include <sbi/riscv_asm.h>
+#include <sbi/riscv_encoding.h>
+#include <sbi/sbi_console.h>
+#include <sbi/sbi_domain.h>
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_hart_pmp.h>
+#include <sbi/sbi_math.h>
+#include <sbi/sbi_string.h>
+
+#if __riscv_xlen == 32
+#define PMP_PER_CFG		4
+#else
+#define PMP_PER_CFG		8
+#endif
+
+/** Address range with inclusive end so the full address space fits */
+struct pmp_range {
+	unsigned long start;
+	unsigned long last;
+	u8 prot;
+};
+
+static bool pmp_range_overlap(const struct pmp_range *a,
+			      const struct pmp_range *b)
+{
+	return (a->start <= b->last && b->start <= a->last) ? true : false;
+}
+
+static bool pmp_range_covers(const struct pmp_range *a,
+			     const struct pmp_range *b)
+{
+	return (a->start <= b->start && b->last <= a->last) ? true : false;
+}
+
+static bool pmp_range_touch(const struct pmp_range *a,
+			    const struct pmp_range *b)
+{
+	if (pmp_range_overlap(a, b))
+		return true;
+	if (a->last != -1UL && a->last + 1 == b->start)
+		return true;
+	if (b->last != -1UL && b->last + 1 == a->start)
+		return true;
+	return false;
+}
+
+/*
+ * Range j can be merged into the higher priority range i when both have
+ * the same permissions, their union is contiguous and no range between
+ * them overlaps range j (which would otherwise lose priority over j).
+ */
+static bool pmp_range_mergeable(const struct pmp_range *r,
+				unsigned int i, unsigned int j)
+{
+	unsigned int k;
+
+	if (r[i].prot != r[j].prot || !pmp_range_touch(&r[i], &r[j]))
+		return false;
+
+	for (k = i + 1; k < j; k++) {
+		if (pmp_range_overlap(&r[k], &r[j]))
+			return false;
+	}
+
+	return true;
+}
+
+static unsigned int pmp_range_reduce(struct pmp_range *r, unsigned int n)
+{
+	unsigned int i, j;
+	bool changed;
+
+	do {
+		changed = false;
+		for (j = 1; j < n; ) {
+			for (i = 0; i < j; i++) {
+				/* Range j is never matched */
+				if (pmp_range_covers(&r[i], &r[j]))
+					break;
+				if (pmp_range_mergeable(r, i, j)) {
+					if (r[j].start < r[i].start)
+						r[i].start = r[j].start;
+					if (r[i].last < r[j].last)
+						r[i].last = r[j].last;
+					break;
+				}
+			}
+			if (i < j) {
+				sbi_memmove(&r[j], &r[j + 1],
+					    (n - j - 1) * sizeof(*r));
+				n--;
+				changed = true;
+			} else {
+				j++;
+			}
+		}
+	} while (changed);
+
+	return n;
+}
+
+/* Largest NAPOT order which starts the range */
+static unsigned long pmp_napot_order(unsigned long start, unsigned long last)
+{
+	unsigned long order = PMP_SHIFT;
+
+	if (!start && last == -1UL)
+		return __riscv_xlen;
+
+	while (order + 1 < __riscv_xlen &&
+	       !(start & ((1UL << (order + 1)) - 1)) &&
+	       (1UL << (order + 1)) - 1 <= last - start)
+		order++;
+
+	return order;
+}
+
+static unsigned int pmp_napot_count(unsigned long start, unsigned long last)
+{
+	unsigned int count = 0;
+	unsigned long order;
+
+	while (1) {
+		order = pmp_napot_order(start, last);
+		count++;
+		if (order == __riscv_xlen ||
+		    last - start == (1UL << order) - 1)
+			break;
+		start += 1UL << order;
+	}
+
+	return count;
+}
+
+static unsigned long pmp_napot_addr(unsigned long start, unsigned long order)
+{
+	if (order == __riscv_xlen)
+		return -1UL;
+	if (order == PMP_SHIFT)
+		return start >> PMP_SHIFT;
+	return (start >> PMP_SHIFT) | ((1UL << (order - PMP_SHIFT - 1)) - 1);
+}
+
+static void pmp_plan_add(struct sbi_hart_pmp_plan *plan, u8 cfg,
+			 unsigned long addr)
+{
+	plan->cfg[plan->count] = cfg;
+	plan->addr[plan->count] = addr;
+	plan->count++;
+}
+
+/** State carried from one planned address range to the next */
+struct pmp_plan_state {
+	unsigned int pmp_count;
+	unsigned long pmp_addr_max;
+	bool full;
+	bool tor_prev;
+	unsigned long tor_top;
+};
+
+static void pmp_plan_range(struct sbi_hart_pmp_plan *plan,
+			   struct pmp_plan_state *ps,
+			   const struct pmp_range *r)
+{
+	unsigned long order, start, top;
+	unsigned int napot, tor;
+
+	napot = pmp_napot_count(r->start, r->last);
+
+	/* A TOR entry takes its bottom from the previous entry */
+	tor = -1U;
+	top = (r->last + 1) >> PMP_SHIFT;
+	if (r->last != -1UL && top <= ps->pmp_addr_max) {
+		if ((!plan->needed && !r->start) ||
+		    (ps->tor_prev && ps->tor_top == (r->start >> PMP_SHIFT)))
+			tor = 1;
+		else
+			tor = 2;
+	}
+
+	if (!ps->full && ps->pmp_count < plan->count + ((tor < napot) ?
+							tor : napot))
+		ps->full = true;
+
+	if (tor < napot) {
+		plan->needed += tor;
+		if (!ps->full) {
+			if (tor == 2)
+				pmp_plan_add(plan, 0, r->start >> PMP_SHIFT);
+			pmp_plan_add(plan, r->prot | PMP_A_TOR, top);
+		}
+		ps->tor_prev = true;
+		ps->tor_top = top;
+		return;
+	}
+
+	plan->needed += napot;
+	ps->tor_prev = false;
+	if (ps->full)
+		return;
+	start = r->start;
+	while (1) {
+		order = pmp_napot_order(start, r->last);
+		pmp_plan_add(plan, r->prot | ((order == PMP_SHIFT) ?
+			     PMP_A_NA4 : PMP_A_NAPOT),
+			     pmp_napot_addr(start, order));
+		if (order == __riscv_xlen ||
+		    r->last - start == (1UL << order) - 1)
+			break;
+		start += 1UL << order;
+	}
+}
+
+int sbi_hart_pmp_plan(const struct sbi_domain *dom, unsigned int pmp_count,
+		      unsigned long pmp_gran, unsigned int pmp_addr_bits,
+		      struct sbi_hart_pmp_plan *plan)
+{
+	struct pmp_range ranges[SBI_HART_PMP_PLAN_MAX_RANGES], *r;
+	const struct sbi_domain_memregion *reg;
+	struct pmp_plan_state ps = { 0 };
+	unsigned long pmp_gran_log2;
+	unsigned int i, n = 0, pmp_bits;
+
+	if (!dom || !plan || !pmp_addr_bits)
+		return SBI_EINVAL;
+
+	plan->count = 0;
+	plan->needed = 0;
+	plan->unmerged = false;
+	if (PMP_COUNT < pmp_count)
+		pmp_count = PMP_COUNT;
+
+	pmp_gran_log2 = log2roundup(pmp_gran);
+	pmp_bits = pmp_addr_bits - 1;
+	ps.pmp_count = pmp_count;
+	ps.pmp_addr_max = (1UL << pmp_bits) | ((1UL << pmp_bits) - 1);
+
+	sbi_domain_for_each_memregion(dom, reg) {
+		if (reg->order < pmp_gran_log2 ||
+		    ps.pmp_addr_max <= (reg->base >> PMP_SHIFT)) {
+			sbi_printf("Can not configure pmp for domain %s",
+				   dom->name);
+			sbi_printf(" because memory region address %lx or"
+				   " size %lx is not in range\n",
+				   reg->base, reg->order);
+			continue;
+		}
+
+		/*
+		 * When the ranges don't fit even after merging, the highest
+		 * priority one is planned as-is to make room. Ranges of
+		 * lower priority can't be merged into it anymore but the
+		 * plan stays correct.
+		 */
+		if (SBI_HART_PMP_PLAN_MAX_RANGES <= n) {
+			n = pmp_range_reduce(ranges, n);
+			if (SBI_HART_PMP_PLAN_MAX_RANGES <= n) {
+				pmp_plan_range(plan, &ps, &ranges[0]);
+				sbi_memmove(&ranges[0], &ranges[1],
+					    (n - 1) * sizeof(*ranges));
+				n--;
+				plan->unmerged = true;
+			}
+		}
+
+		r = &ranges[n++];
+		r->start = reg->base;
+		r->last = (reg->order < __riscv_xlen) ?
+			  reg->base + (1UL << reg->order) - 1 : -1UL;
+		r->prot = 0;
+
+		/*
+		 * If permissions are to be enforced for all modes on this
+		 * region, the lock bit should be set.
+		 */
+		if (reg->flags & SBI_DOMAIN_MEMREGION_ENF_PERMISSIONS)
+			r->prot |= PMP_L;
+
+		if (reg->flags & SBI_DOMAIN_MEMREGION_SU_READABLE)
+			r->prot |= PMP_R;
+		if (reg->flags & SBI_DOMAIN_MEMREGION_SU_WRITABLE)
+			r->prot |= PMP_W;
+		if (reg->flags & SBI_DOMAIN_MEMREGION_SU_EXECUTABLE)
+			r->prot |= PMP_X;
+	}
+
+	n = pmp_range_reduce(ranges, n);
+	for (i = 0; i < n; i++)
+		pmp_plan_range(plan, &ps, &ranges[i]);
+
+	return (plan->needed <= pmp_count) ? 0 : SBI_ENOSPC;
+}
+
+static inline int pmp_cfg_csr(unsigned int n)
+{
+#if __riscv_xlen == 32
+	return CSR_PMPCFG0 + (n >> 2);
+#else
+	return (CSR_PMPCFG0 + (n >> 2)) & ~1;
+#endif
+}
+
+static inline u8 pmp_cfg_read(unsigned int n)
+{
+	return csr_read_num(pmp_cfg_csr(n)) >> ((n % PMP_PER_CFG) << 3);
+}
+
+int sbi_hart_pmp_plan_check(const struct sbi_hart_pmp_plan *plan,
+			    unsigned int prev_count)
+{
+	unsigned int i;
+	u8 cfg;
+
+	for (i = 0; i < prev_count; i++) {
+		cfg = pmp_cfg_read(i);
+		if (!(cfg & PMP_L))
+			continue;
+		if (plan->count <= i || plan->cfg[i] != cfg ||
+		    ((plan->addr[i] ^ csr_read_num(CSR_PMPADDR0 + i)) &
+		     PMP_ADDR_MASK))
+			return SBI_EDENIED;
+	}
+
+	return 0;
+}
+
+void sbi_hart_pmp_plan_write(const struct sbi_hart_pmp_plan *plan,
+			     unsigned int prev_count)
+{
+	unsigned int i, j, shift, count;
+	unsigned long cfg;
+
+	/* PMP address must be written before a locked PMP config */
+	for (i = 0; i < plan->count; i++)
+		csr_write_num(CSR_PMPADDR0 + i, plan->addr[i]);
+
+	/* Previously programmed PMP entries beyond the plan are turned off */
+	count = (plan->count < prev_count) ? prev_count : plan->count;
+	for (i = 0; i < count; i += PMP_PER_CFG) {
+		cfg = csr_read_num(pmp_cfg_csr(i));
+		for (j = i; j < count && j < i + PMP_PER_CFG; j++) {
+			shift = (j - i) << 3;
+			cfg &= ~(0xffUL << shift);
+			if (j < plan->count)
+				cfg |= (unsigned long)plan->cfg[j] << shift;
+		}
+		csr_write_num(pmp_cfg_csr(i), cfg);
+	}
+}
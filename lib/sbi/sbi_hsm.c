@@ -21,7 +21,9 @@
 #include <sbi/sbi_hsm.h>
 #include <sbi/sbi_init.h>
 #include <sbi/sbi_ipi.h>
+#include <sbi/sbi_pmu.h>
 #include <sbi/sbi_scratch.h>
+#include <sbi/sbi_string.h>
 #include <sbi/sbi_system.h>
 #include <sbi/sbi_timer.h>
 #include <sbi/sbi_console.h>
@@ -32,12 +34,35 @@
 	if (state != (oldstate))					\
 		sbi_printf("%s: ERR: The hart is in invalid state [%lu]\n", \
 			   __func__, state);				\
+	else								\
+		hsm_interruptible_update(hdata, oldstate, newstate);	\
 	state == (oldstate);						\
 })
 
+/* Minimum number of samples before non-retentive suspend is demoted */
+#define HSM_SUSPEND_DEMOTE_MIN_SAMPLES	8
+
+/*
+ * Non-retentive suspend is demoted when the average residency is less
+ * than this many times the average exit latency.
+ */
+#define HSM_SUSPEND_DEMOTE_FACTOR	4
+
 static const struct sbi_hsm_device *hsm_dev = NULL;
 static unsigned long hart_data_offset;
 
+/** Per hart suspend statistics **/
+struct hsm_suspend_stats {
+	struct sbi_hsm_suspend_stats ents[SBI_HSM_SUSPEND_STATS_MAX];
+	/* Moving averages (1/8 weight) used by the demotion policy */
+	u64 avg_residency[SBI_HSM_SUSPEND_STATS_MAX];
+	u64 avg_exit_latency[SBI_HSM_SUSPEND_STATS_MAX];
+	/* Entry of the suspend in progress or -1 if not tracked */
+	int cur;
+	u64 enter_time;
+	u64 wake_time;
+};
+
 /** Per hart specific data to manage state transition **/
 struct sbi_hsm_data {
 	atomic_t state;
@@ -45,8 +70,33 @@ struct sbi_hsm_data {
 	unsigned long saved_mie;
 	unsigned long saved_mip;
 	atomic_t start_ticket;
+	u32 hartid;
+	struct hsm_suspend_stats susp;
 };
 
+/** Mask of HARTs in STARTED or SUSPENDED state (i.e. interruptible) */
+static struct sbi_hartmask hsm_interruptible_harts = { 0 };
+
+static inline bool hsm_state_is_interruptible(long state)
+{
+	return (state == SBI_HSM_STATE_STARTED ||
+		state == SBI_HSM_STATE_SUSPENDED) ? true : false;
+}
+
+static void hsm_interruptible_update(struct sbi_hsm_data *hdata,
+				     long oldstate, long newstate)
+{
+	bool was = hsm_state_is_interruptible(oldstate);
+	bool is = hsm_state_is_interruptible(newstate);
+
+	if (!was && is)
+		atomic_raw_set_bit(hdata->hartid,
+			sbi_hartmask_bits(&hsm_interruptible_harts));
+	else if (was && !is)
+		atomic_raw_clear_bit(hdata->hartid,
+			sbi_hartmask_bits(&hsm_interruptible_harts));
+}
+
 bool sbi_hsm_hart_change_state(struct sbi_scratch *scratch, long oldstate,
 			       long newstate)
 {
@@ -113,26 +163,21 @@ static void hsm_start_ticket_release(struct sbi_hsm_data *hdata)
 int sbi_hsm_hart_interruptible_mask(const struct sbi_domain *dom,
 				    ulong hbase, ulong *out_hmask)
 {
-	int hstate;
-	ulong i, hmask, dmask;
-	ulong hend = sbi_scratch_last_hartid() + 1;
+	ulong bword, boff, imask;
+	const ulong *ibits = sbi_hartmask_bits(&hsm_interruptible_harts);
 
 	*out_hmask = 0;
-	if (hend <= hbase)
+	if ((sbi_scratch_last_hartid() + 1) <= hbase)
 		return SBI_EINVAL;
-	if (BITS_PER_LONG < (hend - hbase))
-		hend = hbase + BITS_PER_LONG;
-
-	dmask = sbi_domain_get_assigned_hartmask(dom, hbase);
-	for (i = hbase; i < hend; i++) {
-		hmask = 1UL << (i - hbase);
-		if (dmask & hmask) {
-			hstate = __sbi_hsm_hart_get_state(i);
-			if (hstate == SBI_HSM_STATE_STARTED ||
-			    hstate == SBI_HSM_STATE_SUSPENDED)
-				*out_hmask |= hmask;
-		}
-	}
+
+	bword = BIT_WORD(hbase);
+	boff = BIT_WORD_OFFSET(hbase);
+
+	imask = ibits[bword++] >> boff;
+	if (boff && bword < BIT_WORD(SBI_HARTMASK_MAX_BITS))
+		imask |= ibits[bword] << (BITS_PER_LONG - boff);
+
+	*out_hmask = imask & sbi_domain_get_assigned_hartmask(dom, hbase);
 
 	return 0;
 }
@@ -261,6 +306,8 @@ int sbi_hsm_init(struct sbi_scratch *scratch, u32 hartid, bool cold_boot)
 				    SBI_HSM_STATE_START_PENDING :
 				    SBI_HSM_STATE_STOPPED);
 			ATOMIC_INIT(&hdata->start_ticket, 0);
+			hdata->hartid = i;
+			hdata->susp.cur = -1;
 		}
 	} else {
 		sbi_hsm_hart_wait(scratch, hartid);
@@ -297,6 +344,17 @@ fail_exit:
 	sbi_hart_hang();
 }
 
+static int hsm_hart_start_kick(struct sbi_scratch *scratch, u32 hartid,
+			       unsigned long init_count,
+			       unsigned long entry_count)
+{
+	if ((hsm_device_has_hart_hotplug() && (entry_count == init_count)) ||
+	   (hsm_device_has_hart_secondary_boot() && !init_count))
+		return hsm_device_hart_start(hartid, scratch->warmboot_addr);
+
+	return sbi_ipi_raw_send(hartid);
+}
+
 int sbi_hsm_hart_start(struct sbi_scratch *scratch,
 		       const struct sbi_domain *dom,
 		       u32 hartid, ulong saddr, ulong smode, ulong arg1)
@@ -352,13 +410,7 @@ int sbi_hsm_hart_start(struct sbi_scratch *scratch,
 		goto err;
 	}
 
-	if ((hsm_device_has_hart_hotplug() && (entry_count == init_count)) ||
-	   (hsm_device_has_hart_secondary_boot() && !init_count)) {
-		rc = hsm_device_hart_start(hartid, scratch->warmboot_addr);
-	} else {
-		rc = sbi_ipi_raw_send(hartid);
-	}
-
+	rc = hsm_hart_start_kick(scratch, hartid, init_count, entry_count);
 	if (!rc)
 		return 0;
 err:
@@ -366,6 +418,162 @@ err:
 	return rc;
 }
 
+/**
+ * Start multiple HARTs with a common start address
+ * @param scratch the scratch space of calling HART
+ * @param dom the domain of calling HART
+ * @param hmask the ulong HART mask of HARTs to start
+ * @param hbase the HART base ID of hmask
+ * @param saddr the common start address
+ * @param smode the start privilege mode
+ * @param arg1s the arg1 (opaque) values, one per HART set in hmask in
+ * ascending order of HART id
+ * @return 0 on success and SBI_Exxx (< 0) on failure
+ *
+ * All HARTs are validated before any of them is started so either all
+ * HARTs leave STOPPED state or none of them does. HARTs which can't be
+ * kicked afterwards are moved back to STOPPED and SBI_EFAIL is returned.
+ */
+int sbi_hsm_hart_start_many(struct sbi_scratch *scratch,
+			    const struct sbi_domain *dom,
+			    ulong hmask, ulong hbase, ulong saddr,
+			    ulong smode, const ulong *arg1s)
+{
+	int rc = 0;
+	ulong i, m, pos, acquired = 0;
+	ulong ipimask = 0, kickfail = 0, failed = 0;
+	unsigned long init_count, entry_count;
+	struct sbi_scratch *rscratch;
+	struct sbi_hsm_data *hdata;
+
+	/* For now, we only allow start mode to be S-mode or U-mode. */
+	if (smode != PRV_S && smode != PRV_U)
+		return SBI_EINVAL;
+	if (!hmask || (sbi_scratch_last_hartid() + 1) <= hbase)
+		return SBI_EINVAL;
+	if (dom && !sbi_domain_check_addr(dom, saddr, smode,
+					  SBI_DOMAIN_EXECUTE))
+		return SBI_EINVALID_ADDR;
+
+	/* Acquire start tickets and validate all HARTs */
+	for (i = 0, m = hmask; m; i++, m >>= 1) {
+		if (!(m & 1UL))
+			continue;
+
+		if (sbi_scratch_last_hartid() < (hbase + i) ||
+		    (dom && !sbi_domain_is_assigned_hart(dom, hbase + i))) {
+			rc = SBI_EINVAL;
+			goto err;
+		}
+
+		rscratch = sbi_hartid_to_scratch(hbase + i);
+		if (!rscratch) {
+			rc = SBI_EINVAL;
+			goto err;
+		}
+
+		hdata = sbi_scratch_offset_ptr(rscratch, hart_data_offset);
+		if (!hsm_start_ticket_acquire(hdata)) {
+			rc = SBI_EINVAL;
+			goto err;
+		}
+		acquired |= 1UL << i;
+
+		switch (atomic_read(&hdata->state)) {
+		case SBI_HSM_STATE_STOPPED:
+			break;
+		case SBI_HSM_STATE_STARTED:
+			rc = SBI_EALREADY;
+			goto err;
+		default:
+			rc = SBI_EINVAL;
+			goto err;
+		}
+	}
+
+	/*
+	 * Setup start parameters and move all HARTs to START_PENDING
+	 * before kicking any of them. HARTs which are brought up by the
+	 * HSM device are kicked individually whereas all other HARTs are
+	 * kicked with a single pass over their IPI doorbells.
+	 */
+	for (i = 0, pos = 0, m = hmask; m; i++, m >>= 1) {
+		if (!(m & 1UL))
+			continue;
+
+		rscratch = sbi_hartid_to_scratch(hbase + i);
+		hdata = sbi_scratch_offset_ptr(rscratch, hart_data_offset);
+
+		init_count = sbi_init_count(hbase + i);
+		entry_count = sbi_entry_count(hbase + i);
+
+		rscratch->next_arg1 = arg1s[pos++];
+		rscratch->next_addr = saddr;
+		rscratch->next_mode = smode;
+
+		/* Refer comments in sbi_hsm_hart_start() */
+		if (atomic_cmpxchg(&hdata->state, SBI_HSM_STATE_STOPPED,
+				   SBI_HSM_STATE_START_PENDING) !=
+		    SBI_HSM_STATE_STOPPED) {
+			failed |= 1UL << i;
+			continue;
+		}
+
+		if ((hsm_device_has_hart_hotplug() &&
+		     (entry_count == init_count)) ||
+		    (hsm_device_has_hart_secondary_boot() && !init_count)) {
+			if (hsm_device_hart_start(hbase + i,
+						  scratch->warmboot_addr))
+				kickfail |= 1UL << i;
+		} else {
+			ipimask |= 1UL << i;
+		}
+	}
+
+	if (ipimask)
+		kickfail |= sbi_ipi_raw_send_many(ipimask, hbase);
+
+	/*
+	 * HARTs which could not be kicked go back to STOPPED and their
+	 * ticket is released as in the error path below. A HART which
+	 * left START_PENDING anyway has started and releases its ticket
+	 * itself.
+	 */
+	for (i = 0, m = kickfail; m; i++, m >>= 1) {
+		if (!(m & 1UL))
+			continue;
+
+		rscratch = sbi_hartid_to_scratch(hbase + i);
+		hdata = sbi_scratch_offset_ptr(rscratch, hart_data_offset);
+		if (atomic_cmpxchg(&hdata->state, SBI_HSM_STATE_START_PENDING,
+				   SBI_HSM_STATE_STOPPED) ==
+		    SBI_HSM_STATE_START_PENDING)
+			failed |= 1UL << i;
+	}
+
+	for (i = 0, m = failed; m; i++, m >>= 1) {
+		if (!(m & 1UL))
+			continue;
+
+		rscratch = sbi_hartid_to_scratch(hbase + i);
+		hdata = sbi_scratch_offset_ptr(rscratch, hart_data_offset);
+		hsm_start_ticket_release(hdata);
+	}
+
+	return (failed) ? SBI_EFAIL : 0;
+
+err:
+	for (i = 0, m = acquired; m; i++, m >>= 1) {
+		if (!(m & 1UL))
+			continue;
+
+		rscratch = sbi_hartid_to_scratch(hbase + i);
+		hdata = sbi_scratch_offset_ptr(rscratch, hart_data_offset);
+		hsm_start_ticket_release(hdata);
+	}
+	return rc;
+}
+
 int sbi_hsm_hart_stop(struct sbi_scratch *scratch, bool exitnow)
 {
 	const struct sbi_domain *dom = sbi_domain_thishart_ptr();
@@ -385,6 +593,146 @@ int sbi_hsm_hart_stop(struct sbi_scratch *scratch, bool exitnow)
 	return 0;
 }
 
+static inline u64 hsm_suspend_avg_update(u64 avg, u64 sample)
+{
+	return avg - (avg >> 3) + (sample >> 3);
+}
+
+static int hsm_suspend_stats_find(struct hsm_suspend_stats *st,
+				  u32 suspend_type, bool alloc)
+{
+	int i;
+
+	for (i = 0; i < SBI_HSM_SUSPEND_STATS_MAX; i++) {
+		if (st->ents[i].count || st->ents[i].demoted) {
+			if (st->ents[i].suspend_type == suspend_type)
+				return i;
+			continue;
+		}
+		if (!alloc)
+			break;
+		st->ents[i].suspend_type = suspend_type;
+		return i;
+	}
+
+	return -1;
+}
+
+/* Mark entry into suspend of given type */
+static void hsm_suspend_stats_enter(struct sbi_hsm_data *hdata,
+				    u32 suspend_type, bool demoted)
+{
+	struct hsm_suspend_stats *st = &hdata->susp;
+
+	st->cur = hsm_suspend_stats_find(st, suspend_type, true);
+	if (st->cur < 0)
+		return;
+
+	if (demoted)
+		st->ents[st->cur].demoted++;
+	st->enter_time = sbi_timer_value();
+}
+
+/* Mark wake-up from suspend (i.e. end of residency) */
+static void hsm_suspend_stats_wake(struct sbi_hsm_data *hdata)
+{
+	struct hsm_suspend_stats *st = &hdata->susp;
+	struct sbi_hsm_suspend_stats *ent;
+	u64 residency;
+
+	if (st->cur < 0)
+		return;
+	ent = &st->ents[st->cur];
+
+	st->wake_time = sbi_timer_value();
+	residency = st->wake_time - st->enter_time;
+
+	ent->count++;
+	ent->residency += residency;
+	st->avg_residency[st->cur] =
+		hsm_suspend_avg_update(st->avg_residency[st->cur], residency);
+}
+
+/*
+ * Mark resume of supervisor (i.e. end of exit latency). The exit latency
+ * of demoted suspends is not accounted so that the averages keep tracking
+ * the cost of the suspend type actually requested.
+ */
+static void hsm_suspend_stats_exit(struct sbi_hsm_data *hdata, bool account)
+{
+	struct hsm_suspend_stats *st = &hdata->susp;
+	struct sbi_hsm_suspend_stats *ent;
+	int i = st->cur;
+	u64 latency;
+
+	if (i < 0)
+		return;
+	ent = &st->ents[i];
+	st->cur = -1;
+
+	if (!account)
+		return;
+
+	latency = sbi_timer_value() - st->wake_time;
+	ent->exit_latency += latency;
+	if (ent->max_exit_latency < latency)
+		ent->max_exit_latency = latency;
+	st->avg_exit_latency[i] =
+		hsm_suspend_avg_update(st->avg_exit_latency[i], latency);
+}
+
+/* Discard the suspend in progress (i.e. suspend failed) */
+static inline void hsm_suspend_stats_abort(struct sbi_hsm_data *hdata)
+{
+	hdata->susp.cur = -1;
+}
+
+static bool hsm_suspend_should_demote(struct sbi_hsm_data *hdata,
+				      u32 suspend_type)
+{
+#ifdef CONFIG_SBI_HSM_SUSPEND_DEMOTION
+	struct hsm_suspend_stats *st = &hdata->susp;
+	int i;
+
+	if (!(suspend_type & SBI_HSM_SUSP_NON_RET_BIT))
+		return false;
+
+	i = hsm_suspend_stats_find(st, suspend_type, false);
+	if (i < 0 || st->ents[i].count < HSM_SUSPEND_DEMOTE_MIN_SAMPLES)
+		return false;
+
+	return (st->avg_residency[i] <
+		HSM_SUSPEND_DEMOTE_FACTOR * st->avg_exit_latency[i]) ?
+		true : false;
+#else
+	return false;
+#endif
+}
+
+unsigned long sbi_hsm_suspend_stats_read(struct sbi_hsm_suspend_stats *out,
+					 unsigned long num, bool reset)
+{
+	struct sbi_hsm_data *hdata;
+	unsigned long i, ret = 0;
+
+	if (!hart_data_offset)
+		return 0;
+	hdata = sbi_scratch_thishart_offset_ptr(hart_data_offset);
+
+	for (i = 0; i < SBI_HSM_SUSPEND_STATS_MAX && ret < num; i++) {
+		if (!hdata->susp.ents[i].count && !hdata->susp.ents[i].demoted)
+			continue;
+		sbi_memcpy(&out[ret++], &hdata->susp.ents[i], sizeof(*out));
+	}
+
+	if (reset) {
+		sbi_memset(&hdata->susp, 0, sizeof(hdata->susp));
+		hdata->susp.cur = -1;
+	}
+
+	return ret;
+}
+
 static int __sbi_hsm_suspend_default(struct sbi_scratch *scratch)
 {
 	/* Wait for interrupt */
@@ -414,6 +762,20 @@ void __sbi_hsm_suspend_non_ret_save(struct sbi_scratch *scratch)
 
 	hdata->saved_mie = csr_read(CSR_MIE);
 	hdata->saved_mip = csr_read(CSR_MIP) & (MIP_SSIP | MIP_STIP);
+
+	/*
+	 * Snapshot the M-mode CSRs and PMP configured by the warm-boot
+	 * sequence so that resume can restore them instead of running
+	 * the warm-boot sequence again.
+	 */
+	sbi_hart_context_save(scratch);
+
+	/*
+	 * Neither path of the resume sequence re-initializes the timer
+	 * and PMU so save the per-HART state kept in their CSRs.
+	 */
+	sbi_timer_context_save(scratch);
+	sbi_pmu_context_save(scratch);
 }
 
 static void __sbi_hsm_suspend_non_ret_restore(struct sbi_scratch *scratch)
@@ -421,6 +783,9 @@ static void __sbi_hsm_suspend_non_ret_restore(struct sbi_scratch *scratch)
 	struct sbi_hsm_data *hdata = sbi_scratch_offset_ptr(scratch,
 							    hart_data_offset);
 
+	sbi_pmu_context_restore(scratch);
+	sbi_timer_context_restore(scratch);
+
 	csr_write(CSR_MIE, hdata->saved_mie);
 	csr_set(CSR_MIP, (hdata->saved_mip & (MIP_SSIP | MIP_STIP)));
 }
@@ -435,6 +800,7 @@ void sbi_hsm_hart_resume_start(struct sbi_scratch *scratch)
 					 SBI_HSM_STATE_RESUME_PENDING))
 		sbi_hart_hang();
 
+	hsm_suspend_stats_wake(hdata);
 	hsm_device_hart_resume();
 }
 
@@ -455,6 +821,7 @@ void __noreturn sbi_hsm_hart_resume_finish(struct sbi_scratch *scratch,
 	 */
 	__sbi_hsm_suspend_non_ret_restore(scratch);
 
+	hsm_suspend_stats_exit(hdata, true);
 	sbi_hart_switch_mode(hartid, scratch->next_arg1,
 			     scratch->next_addr,
 			     scratch->next_mode, false);
@@ -506,6 +873,27 @@ int sbi_hsm_hart_suspend(struct sbi_scratch *scratch, u32 suspend_type,
 	/* Save the suspend type */
 	hdata->suspend_type = suspend_type;
 
+	/*
+	 * Recent non-retentive suspends of this type did not last long
+	 * enough to pay off the exit latency so wait in retentive suspend
+	 * instead and resume the supervisor as-if the context was lost.
+	 */
+	if (hsm_suspend_should_demote(hdata, suspend_type)) {
+		hsm_suspend_stats_enter(hdata, suspend_type, true);
+		__sbi_hsm_suspend_default(scratch);
+		hsm_suspend_stats_wake(hdata);
+		hsm_suspend_stats_exit(hdata, false);
+
+		if (!__sbi_hsm_hart_change_state(hdata,
+						 SBI_HSM_STATE_SUSPENDED,
+						 SBI_HSM_STATE_STARTED))
+			sbi_hart_hang();
+
+		sbi_hart_switch_mode(current_hartid(), scratch->next_arg1,
+				     scratch->next_addr,
+				     scratch->next_mode, false);
+	}
+
 	/*
 	 * Save context which will be restored after resuming from
 	 * non-retentive suspend.
@@ -513,6 +901,8 @@ int sbi_hsm_hart_suspend(struct sbi_scratch *scratch, u32 suspend_type,
 	if (suspend_type & SBI_HSM_SUSP_NON_RET_BIT)
 		__sbi_hsm_suspend_non_ret_save(scratch);
 
+	hsm_suspend_stats_enter(hdata, suspend_type, false);
+
 	/* Try platform specific suspend */
 	ret = hsm_device_hart_suspend(suspend_type);
 	if (ret == SBI_ENOTSUPP) {
@@ -540,6 +930,12 @@ int sbi_hsm_hart_suspend(struct sbi_scratch *scratch, u32 suspend_type,
 	 * We might have successfully resumed from retentive suspend
 	 * or suspend failed. In both cases, we restore state of hart.
 	 */
+	if (!ret) {
+		hsm_suspend_stats_wake(hdata);
+		hsm_suspend_stats_exit(hdata, true);
+	} else {
+		hsm_suspend_stats_abort(hdata);
+	}
 	if (!__sbi_hsm_hart_change_state(hdata, SBI_HSM_STATE_SUSPENDED,
 					 SBI_HSM_STATE_STARTED))
 		sbi_hart_hang();
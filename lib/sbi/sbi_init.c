@@ -14,18 +14,22 @@
 #include <sbi/sbi_console.h>
 #include <sbi/sbi_cppc.h>
 #include <sbi/sbi_domain.h>
+#include <sbi/sbi_domain_switch.h>
 #include <sbi/sbi_ecall.h>
+#include <sbi/sbi_fwft.h>
 #include <sbi/sbi_hart.h>
 #include <sbi/sbi_hartmask.h>
 #include <sbi/sbi_hsm.h>
 #include <sbi/sbi_ipi.h>
 #include <sbi/sbi_irqchip.h>
+#include <sbi/sbi_lockstat.h>
 #include <sbi/sbi_platform.h>
 #include <sbi/sbi_pmu.h>
 #include <sbi/sbi_system.h>
 #include <sbi/sbi_string.h>
 #include <sbi/sbi_timer.h>
 #include <sbi/sbi_tlb.h>
+#include <sbi/sbi_trap.h>
 #include <sbi/sbi_version.h>
 
 #define BANNER                                              \
@@ -285,6 +289,10 @@ static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
 	if (rc)
 		sbi_hart_hang();
 
+	rc = sbi_fwft_init(scratch, true);
+	if (rc)
+		sbi_hart_hang();
+
 	rc = sbi_console_init(scratch);
 	if (rc)
 		sbi_hart_hang();
@@ -293,6 +301,14 @@ static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
 	if (rc)
 		sbi_hart_hang();
 
+	rc = sbi_trap_init(scratch, true);
+	if (rc)
+		sbi_hart_hang();
+
+	rc = sbi_lockstat_init(true);
+	if (rc)
+		sbi_hart_hang();
+
 	sbi_boot_print_banner(scratch);
 
 	rc = sbi_irqchip_init(scratch, true);
@@ -339,6 +355,13 @@ static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
 		sbi_hart_hang();
 	}
 
+	rc = sbi_domain_switch_init(true);
+	if (rc) {
+		sbi_printf("%s: domain switch init failed (error %d)\n",
+			   __func__, rc);
+		sbi_hart_hang();
+	}
+
 	rc = sbi_hart_pmp_configure(scratch);
 	if (rc) {
 		sbi_printf("%s: PMP configure failed (error %d)\n",
@@ -396,10 +419,18 @@ static void __noreturn init_warm_startup(struct sbi_scratch *scratch,
 	if (rc)
 		sbi_hart_hang();
 
+	rc = sbi_fwft_init(scratch, false);
+	if (rc)
+		sbi_hart_hang();
+
 	rc = sbi_pmu_init(scratch, false);
 	if (rc)
 		sbi_hart_hang();
 
+	rc = sbi_trap_init(scratch, false);
+	if (rc)
+		sbi_hart_hang();
+
 	rc = sbi_irqchip_init(scratch, false);
 	if (rc)
 		sbi_hart_hang();
@@ -436,11 +467,21 @@ static void __noreturn init_warm_resume(struct sbi_scratch *scratch,
 	int rc;
 
 	sbi_hsm_hart_resume_start(scratch);
+	sbi_system_resume(scratch);
+
+	/*
+	 * Fast path: restore the HART context saved at suspend time
+	 * which also covers the trap delegation set up by FWFT.
+	 */
+	if (!sbi_hart_context_restore(scratch))
+		sbi_hsm_hart_resume_finish(scratch, hartid);
 
 	rc = sbi_hart_reinit(scratch);
 	if (rc)
 		sbi_hart_hang();
 
+	sbi_fwft_reinit(scratch);
+
 	rc = sbi_hart_pmp_configure(scratch);
 	if (rc)
 		sbi_hart_hang();
@@ -11,13 +11,16 @@
 #include <sbi/riscv_asm.h>
 #include <sbi/riscv_atomic.h>
 #include <sbi/riscv_barrier.h>
+#include <sbi/riscv_io.h>
 #include <sbi/sbi_bitops.h>
 #include <sbi/sbi_domain.h>
 #include <sbi/sbi_error.h>
 #include <sbi/sbi_hart.h>
+#include <sbi/sbi_hartmask.h>
 #include <sbi/sbi_hsm.h>
 #include <sbi/sbi_init.h>
 #include <sbi/sbi_ipi.h>
+#include <sbi/sbi_irqchip.h>
 #include <sbi/sbi_platform.h>
 #include <sbi/sbi_pmu.h>
 #include <sbi/sbi_string.h>
@@ -29,7 +32,20 @@ struct sbi_ipi_data {
 
 static unsigned long ipi_data_off;
 static const struct sbi_ipi_device *ipi_dev = NULL;
+static const struct sbi_ipi_device *ipi_smode_dev = NULL;
 static const struct sbi_ipi_event_ops *ipi_ops_array[SBI_IPI_EVENT_MAX];
+static struct sbi_ipi_doorbell ipi_doorbells[SBI_HARTMASK_MAX_BITS];
+static u32 ipi_smode_event = SBI_IPI_EVENT_MAX;
+
+static inline void ipi_ring_doorbell(u32 target_hart)
+{
+	const struct sbi_ipi_doorbell *db = &ipi_doorbells[target_hart];
+
+	if (db->addr)
+		writel(db->value, db->addr);
+	else if (ipi_dev && ipi_dev->ipi_send)
+		ipi_dev->ipi_send(target_hart);
+}
 
 static int sbi_ipi_send(struct sbi_scratch *scratch, u32 remote_hartid,
 			u32 event, void *data)
@@ -48,6 +64,17 @@ static int sbi_ipi_send(struct sbi_scratch *scratch, u32 remote_hartid,
 	if (!remote_scratch)
 		return SBI_EINVAL;
 
+	/*
+	 * S-mode IPIs are directly injected using the S-mode IPI device
+	 * (if it serves the remote hart) so that the remote hart does
+	 * not need to take a M-mode interrupt only to set MIP.SSIP.
+	 */
+	if (ipi_smode_dev && event == ipi_smode_event &&
+	    !ipi_smode_dev->ipi_send(remote_hartid)) {
+		sbi_pmu_ctr_incr_fw(SBI_PMU_FW_IPI_SENT);
+		return 0;
+	}
+
 	ipi_data = sbi_scratch_offset_ptr(remote_scratch, ipi_data_off);
 
 	if (ipi_ops->update) {
@@ -58,15 +85,30 @@ static int sbi_ipi_send(struct sbi_scratch *scratch, u32 remote_hartid,
 	}
 
 	/*
-	 * Set IPI type on remote hart's scratch area and
-	 * trigger the interrupt
+	 * IPI devices which can encode the IPI event in the IPI itself
+	 * don't need the shared IPI type bitmask of the remote hart.
 	 */
-	atomic_raw_set_bit(event, &ipi_data->ipi_type);
-	smp_wmb();
+	if (ipi_dev && ipi_dev->ipi_send_event &&
+	    !ipi_dev->ipi_send_event(remote_hartid, event))
+		goto done;
 
-	if (ipi_dev && ipi_dev->ipi_send)
-		ipi_dev->ipi_send(remote_hartid);
+	/*
+	 * Set IPI type on remote hart's scratch area and trigger the
+	 * interrupt only if no other IPI type was already pending. A
+	 * non-zero old value means some other sender has rung (or is
+	 * about to ring) the doorbell and the remote hart has not yet
+	 * consumed IPI types so it will also see our IPI type.
+	 *
+	 * The atomic_raw_set_bit() returns the old value of the word
+	 * truncated to an int so pending IPI types above bit 31 can at
+	 * worst cause a redundant doorbell write, never a lost one.
+	 */
+	if (!atomic_raw_set_bit(event, &ipi_data->ipi_type)) {
+		smp_wmb();
+		ipi_ring_doorbell(remote_hartid);
+	}
 
+done:
 	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_IPI_SENT);
 
 	if (ipi_ops->sync)
@@ -149,8 +191,6 @@ static struct sbi_ipi_event_ops ipi_smode_ops = {
 	.process = sbi_ipi_process_smode,
 };
 
-static u32 ipi_smode_event = SBI_IPI_EVENT_MAX;
-
 int sbi_ipi_send_smode(ulong hmask, ulong hbase)
 {
 	return sbi_ipi_send_many(hmask, hbase, ipi_smode_event, NULL);
@@ -189,8 +229,17 @@ void sbi_ipi_process(void)
 	u32 hartid = current_hartid();
 
 	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_IPI_RECVD);
-	if (ipi_dev && ipi_dev->ipi_clear)
+
+	/*
+	 * The IPI device must be cleared before consuming IPI types.
+	 * Senders only ring the doorbell when IPI types go from zero
+	 * to non-zero so clearing the device after the exchange below
+	 * could drop the doorbell of an IPI type set in between.
+	 */
+	if (ipi_dev && ipi_dev->ipi_clear) {
 		ipi_dev->ipi_clear(hartid);
+		mb();
+	}
 
 	ipi_type = atomic_raw_xchg_ulong(&ipi_data->ipi_type, 0);
 	ipi_event = 0;
@@ -208,15 +257,59 @@ skip:
 	};
 }
 
+void sbi_ipi_process_event(u32 event)
+{
+	const struct sbi_ipi_event_ops *ipi_ops;
+
+	if (SBI_IPI_EVENT_MAX <= event)
+		return;
+
+	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_IPI_RECVD);
+
+	ipi_ops = ipi_ops_array[event];
+	if (ipi_ops && ipi_ops->process)
+		ipi_ops->process(sbi_scratch_thishart_ptr());
+}
+
 int sbi_ipi_raw_send(u32 target_hart)
 {
-	if (!ipi_dev || !ipi_dev->ipi_send)
+	if (SBI_HARTMASK_MAX_BITS <= target_hart ||
+	    (!ipi_doorbells[target_hart].addr &&
+	     (!ipi_dev || !ipi_dev->ipi_send)))
 		return SBI_EINVAL;
 
-	ipi_dev->ipi_send(target_hart);
+	ipi_ring_doorbell(target_hart);
 	return 0;
 }
 
+ulong sbi_ipi_raw_send_many(ulong hmask, ulong hbase)
+{
+	const struct sbi_ipi_doorbell *db;
+	ulong i, m, failed = 0;
+
+	/* One barrier orders prior memory writes before all doorbells */
+	__io_bw();
+
+	for (i = 0, m = hmask; m; i++, m >>= 1) {
+		if (!(m & 1UL))
+			continue;
+
+		if (SBI_HARTMASK_MAX_BITS <= (hbase + i)) {
+			failed |= 1UL << i;
+			continue;
+		}
+
+		db = &ipi_doorbells[hbase + i];
+		if (db->addr)
+			__raw_writel(db->value, db->addr);
+		else if (!ipi_dev || !ipi_dev->ipi_send ||
+			 ipi_dev->ipi_send(hbase + i))
+			failed |= 1UL << i;
+	}
+
+	return failed;
+}
+
 void sbi_ipi_raw_clear(u32 target_hart)
 {
 	if (ipi_dev && ipi_dev->ipi_clear)
@@ -236,6 +329,40 @@ void sbi_ipi_set_device(const struct sbi_ipi_device *dev)
 	ipi_dev = dev;
 }
 
+const struct sbi_ipi_device *sbi_ipi_get_smode_device(void)
+{
+	return ipi_smode_dev;
+}
+
+void sbi_ipi_set_smode_device(const struct sbi_ipi_device *dev)
+{
+	if (!dev || !dev->ipi_send || ipi_smode_dev)
+		return;
+
+	ipi_smode_dev = dev;
+}
+
+/**
+ * Set precomputed IPI doorbell of a target HART
+ *
+ * IPI device drivers should call this for each HART served by them at
+ * cold boot time (after sbi_ipi_set_device()) so that sending an IPI is
+ * a single MMIO write instead of going through the ipi_send() callback
+ * of the IPI device. Doorbells of an IPI device which was not selected
+ * by sbi_ipi_set_device() are rejected.
+ */
+int sbi_ipi_set_doorbell(const struct sbi_ipi_device *dev, u32 target_hart,
+			 volatile u32 *addr, u32 value)
+{
+	if (!dev || dev != ipi_dev || SBI_HARTMASK_MAX_BITS <= target_hart)
+		return SBI_EINVAL;
+
+	ipi_doorbells[target_hart].value = value;
+	ipi_doorbells[target_hart].addr = addr;
+
+	return 0;
+}
+
 int sbi_ipi_init(struct sbi_scratch *scratch, bool cold_boot)
 {
 	int ret;
@@ -286,6 +413,14 @@ void sbi_ipi_exit(struct sbi_scratch *scratch)
 	/* Process pending IPIs */
 	sbi_ipi_process();
 
+	/*
+	 * Per-event IPIs are delivered as external interrupts so
+	 * process them as well otherwise remote HARTs waiting for
+	 * us (e.g. remote TLB flush sync) will wait forever.
+	 */
+	if (ipi_dev && ipi_dev->ipi_send_event)
+		sbi_irqchip_process(NULL);
+
 	/* Platform exit */
 	sbi_platform_ipi_exit(sbi_platform_ptr(scratch));
 }
@@ -52,3 +52,13 @@ void sbi_irqchip_exit(struct sbi_scratch *scratch)
 
 	sbi_platform_irqchip_exit(plat);
 }
+
+int sbi_irqchip_suspend(struct sbi_scratch *scratch)
+{
+	return sbi_platform_irqchip_suspend(sbi_platform_ptr(scratch));
+}
+
+void sbi_irqchip_resume(struct sbi_scratch *scratch)
+{
+	sbi_platform_irqchip_resume(sbi_platform_ptr(scratch));
+}
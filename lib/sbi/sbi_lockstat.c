@@ -0,0 +1,158 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Spinlock statistics
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#include <sbi/riscv_asm.h>
+#include <sbi/riscv_encoding.h>
+#include <sbi/sbi_bitops.h>
+#include <sbi/sbi_console.h>
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_lockstat.h>
+#include <sbi/sbi_scratch.h>
+#include <sbi/sbi_string.h>
+
+/*
+ * Per-HART table of lock sites. Each HART only updates its own table so
+ * accounting does not add contention. Lock sites beyond the table size
+ * are not accounted.
+ */
+struct lockstat_table {
+	/* Bitmap of entries whose spinlock is held by this HART */
+	unsigned long held;
+	unsigned long hold_start[SBI_LOCKSTAT_MAX];
+	struct sbi_lockstat ents[SBI_LOCKSTAT_MAX];
+};
+
+_Static_assert(SBI_LOCKSTAT_MAX <= BITS_PER_LONG,
+	       "Too many lock sites for the held bitmap");
+
+static unsigned long lockstat_off;
+
+void sbi_lockstat_acquired(spinlock_t *lock, unsigned long site,
+			   bool contended, unsigned long wait_cycles)
+{
+	struct lockstat_table *tbl;
+	struct sbi_lockstat *ent;
+	unsigned int i;
+
+	if (!lockstat_off)
+		return;
+	tbl = sbi_scratch_thishart_offset_ptr(lockstat_off);
+
+	for (i = 0; i < SBI_LOCKSTAT_MAX; i++) {
+		ent = &tbl->ents[i];
+		if (!ent->acquired) {
+			ent->lock = (unsigned long)lock;
+			ent->site = site;
+			break;
+		}
+		if (ent->lock == (unsigned long)lock && ent->site == site)
+			break;
+	}
+	if (i == SBI_LOCKSTAT_MAX)
+		return;
+
+	ent->acquired++;
+	if (contended) {
+		ent->contended++;
+		ent->wait_cycles += wait_cycles;
+		if (ent->wait_max < wait_cycles)
+			ent->wait_max = wait_cycles;
+	}
+
+	tbl->held |= 1UL << i;
+	tbl->hold_start[i] = csr_read(CSR_MCYCLE);
+}
+
+void sbi_lockstat_released(spinlock_t *lock)
+{
+	struct lockstat_table *tbl;
+	unsigned int i;
+
+	if (!lockstat_off)
+		return;
+	tbl = sbi_scratch_thishart_offset_ptr(lockstat_off);
+
+	for (i = 0; i < SBI_LOCKSTAT_MAX; i++) {
+		if (!(tbl->held & (1UL << i)) ||
+		    tbl->ents[i].lock != (unsigned long)lock)
+			continue;
+		tbl->held &= ~(1UL << i);
+		tbl->ents[i].hold_cycles +=
+			csr_read(CSR_MCYCLE) - tbl->hold_start[i];
+		break;
+	}
+}
+
+unsigned long sbi_lockstat_read(struct sbi_lockstat *out,
+				unsigned long num, bool reset)
+{
+	struct lockstat_table *tbl;
+	unsigned long i, ret = 0;
+
+	if (!lockstat_off)
+		return 0;
+	tbl = sbi_scratch_thishart_offset_ptr(lockstat_off);
+
+	for (i = 0; i < SBI_LOCKSTAT_MAX && ret < num; i++) {
+		if (!tbl->ents[i].acquired)
+			continue;
+		sbi_memcpy(&out[ret++], &tbl->ents[i], sizeof(*out));
+	}
+
+	if (reset)
+		sbi_memset(tbl, 0, sizeof(*tbl));
+
+	return ret;
+}
+
+void sbi_lockstat_dump(void)
+{
+	struct sbi_scratch *scratch;
+	struct lockstat_table *tbl;
+	struct sbi_lockstat *ent;
+	u32 hartid, i;
+
+	if (!lockstat_off)
+		return;
+
+	for (hartid = 0; hartid <= sbi_scratch_last_hartid(); hartid++) {
+		scratch = sbi_hartid_to_scratch(hartid);
+		if (!scratch)
+			continue;
+		tbl = sbi_scratch_offset_ptr(scratch, lockstat_off);
+
+		for (i = 0; i < SBI_LOCKSTAT_MAX; i++) {
+			ent = &tbl->ents[i];
+			if (!ent->acquired)
+				continue;
+			sbi_printf("Lockstat HART%u lock 0x%lx site 0x%lx: "
+				   "acquired %lu contended %lu wait %llu "
+				   "max %llu hold %llu cycles\n",
+				   hartid, ent->lock, ent->site,
+				   ent->acquired, ent->contended,
+				   (unsigned long long)ent->wait_cycles,
+				   (unsigned long long)ent->wait_max,
+				   (unsigned long long)ent->hold_cycles);
+		}
+	}
+}
+
+int sbi_lockstat_init(bool cold_boot)
+{
+	if (cold_boot) {
+		lockstat_off = sbi_scratch_alloc_offset(
+					sizeof(struct lockstat_table));
+		if (!lockstat_off)
+			return SBI_ENOMEM;
+	}
+
+	return 0;
+}
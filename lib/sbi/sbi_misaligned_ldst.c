@@ -37,10 +37,10 @@ static ulong sbi_misaligned_tinst_fixup(ulong orig_tinst, ulong new_tinst,
 int sbi_misaligned_load_handler(ulong addr, ulong tval2, ulong tinst,
 				struct sbi_trap_regs *regs)
 {
-	ulong insn, insn_len;
+	ulong insn, insn_len, done;
 	union reg_data val;
 	struct sbi_trap_info uptrap;
-	int i, fp = 0, shift = 0, len = 0;
+	int fp = 0, shift = 0, len = 0;
 
 	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_MISALIGNED_LOAD);
 
@@ -134,15 +134,12 @@ int sbi_misaligned_load_handler(ulong addr, ulong tval2, ulong tinst,
 	}
 
 	val.data_u64 = 0;
-	for (i = 0; i < len; i++) {
-		val.data_bytes[i] = sbi_load_u8((void *)(addr + i),
-						&uptrap);
-		if (uptrap.cause) {
-			uptrap.epc = regs->mepc;
-			uptrap.tinst = sbi_misaligned_tinst_fixup(
-				tinst, uptrap.tinst, i);
-			return sbi_trap_redirect(regs, &uptrap);
-		}
+	done = sbi_copy_from_unpriv(val.data_bytes, addr, len, &uptrap);
+	if (uptrap.cause) {
+		uptrap.epc = regs->mepc;
+		uptrap.tinst = sbi_misaligned_tinst_fixup(
+			tinst, uptrap.tinst, done);
+		return sbi_trap_redirect(regs, &uptrap);
 	}
 
 	if (!fp)
@@ -162,10 +159,10 @@ int sbi_misaligned_load_handler(ulong addr, ulong tval2, ulong tinst,
 int sbi_misaligned_store_handler(ulong addr, ulong tval2, ulong tinst,
 				 struct sbi_trap_regs *regs)
 {
-	ulong insn, insn_len;
+	ulong insn, insn_len, done;
 	union reg_data val;
 	struct sbi_trap_info uptrap;
-	int i, len = 0;
+	int len = 0;
 
 	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_MISALIGNED_STORE);
 
@@ -249,15 +246,12 @@ int sbi_misaligned_store_handler(ulong addr, ulong tval2, ulong tinst,
 		return sbi_trap_redirect(regs, &uptrap);
 	}
 
-	for (i = 0; i < len; i++) {
-		sbi_store_u8((void *)(addr + i), val.data_bytes[i],
-			     &uptrap);
-		if (uptrap.cause) {
-			uptrap.epc = regs->mepc;
-			uptrap.tinst = sbi_misaligned_tinst_fixup(
-				tinst, uptrap.tinst, i);
-			return sbi_trap_redirect(regs, &uptrap);
-		}
+	done = sbi_copy_to_unpriv(addr, val.data_bytes, len, &uptrap);
+	if (uptrap.cause) {
+		uptrap.epc = regs->mepc;
+		uptrap.tinst = sbi_misaligned_tinst_fixup(
+			tinst, uptrap.tinst, done);
+		return sbi_trap_redirect(regs, &uptrap);
 	}
 
 	regs->mepc += insn_len;
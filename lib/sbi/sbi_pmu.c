@@ -17,6 +17,8 @@
 #include <sbi/sbi_pmu.h>
 #include <sbi/sbi_scratch.h>
 #include <sbi/sbi_string.h>
+#include <sbi/sbi_timer.h>
+#include <sbi/sbi_trap.h>
 
 /** Information about hardware counters */
 struct sbi_pmu_hw_event {
@@ -72,6 +74,34 @@ static unsigned long fw_counters_started[SBI_HARTMASK_MAX_BITS];
  */
 static uint64_t fw_counters_data[SBI_HARTMASK_MAX_BITS][SBI_PMU_FW_CTR_MAX] = {0};
 
+/** Per-HART state of firmware assisted PC sampling */
+struct pmu_sample_state {
+	/* Sampling is active */
+	bool active;
+	/* Raise PMU interrupt to S-mode when ring is half full */
+	bool irq;
+	/* Counter whose value is captured with each sample */
+	uint32_t cidx;
+	/* Index of the oldest sample in the ring */
+	uint32_t head;
+	/* Number of samples in the ring */
+	uint32_t count;
+	/* Sampling period in timer ticks */
+	unsigned long period;
+	struct sbi_pmu_sample ring[SBI_PMU_SAMPLE_MAX];
+};
+
+static unsigned long pmu_sample_off;
+
+/* Per-HART PMU state lost across non-retentive suspend */
+struct pmu_hart_context {
+	unsigned long mcountinhibit;
+	/* Event selectors of programmable counters (i.e. cidx >= 3) */
+	uint64_t mhpmevent[];
+};
+
+static unsigned long pmu_context_off;
+
 /* Maximum number of hardware events available */
 static uint32_t num_hw_events;
 /* Maximum number of hardware counters available */
@@ -85,6 +115,35 @@ static uint32_t total_ctrs;
   (((x) & SBI_PMU_EVENT_IDX_TYPE_MASK) >> SBI_PMU_EVENT_IDX_TYPE_OFFSET)
 #define get_cidx_code(x) (x & SBI_PMU_EVENT_IDX_CODE_MASK)
 
+_Static_assert(SBI_PMU_FW_MMODE_CYCLES(SBI_PMU_MMODE_CLASS_MAX) <=
+	       SBI_PMU_FW_MMODE_INSTRET_BASE &&
+	       SBI_PMU_FW_MMODE_INSTRET(SBI_PMU_MMODE_CLASS_MAX) <=
+	       SBI_PMU_FW_RESERVED_MAX,
+	       "M-mode residency events overflow their event code range");
+
+/**
+ * Check whether a firmware event code is implemented
+ * @param event_code firmware event code
+ *
+ * Return true for SBI firmware events, OpenSBI M-mode residency events
+ * and platform firmware events, false otherwise
+ */
+static bool pmu_fw_event_code_valid(uint32_t event_code)
+{
+	if (event_code < SBI_PMU_FW_MAX || event_code == SBI_PMU_FW_PLATFORM)
+		return true;
+
+	if (SBI_PMU_FW_MMODE_CYCLES(0) <= event_code &&
+	    event_code < SBI_PMU_FW_MMODE_CYCLES(SBI_PMU_MMODE_CLASS_MAX))
+		return true;
+
+	if (SBI_PMU_FW_MMODE_INSTRET(0) <= event_code &&
+	    event_code < SBI_PMU_FW_MMODE_INSTRET(SBI_PMU_MMODE_CLASS_MAX))
+		return true;
+
+	return false;
+}
+
 /**
  * Perform a sanity check on event & counter mappings with event range overlap check
  * @param evtA Pointer to the existing hw event structure
@@ -124,9 +183,7 @@ static int pmu_event_validate(unsigned long event_idx, uint64_t edata)
 		event_idx_code_max = SBI_PMU_HW_GENERAL_MAX;
 		break;
 	case SBI_PMU_EVENT_TYPE_FW:
-		if ((event_idx_code >= SBI_PMU_FW_MAX &&
-		    event_idx_code <= SBI_PMU_FW_RESERVED_MAX) ||
-		    event_idx_code > SBI_PMU_FW_PLATFORM)
+		if (!pmu_fw_event_code_valid(event_idx_code))
 			return SBI_EINVAL;
 
 		if (SBI_PMU_FW_PLATFORM == event_idx_code &&
@@ -134,8 +191,7 @@ static int pmu_event_validate(unsigned long event_idx, uint64_t edata)
 			return pmu_dev->fw_event_validate_encoding(hartid,
 							           edata);
 		else
-			event_idx_code_max = SBI_PMU_FW_MAX;
-		break;
+			return event_idx_type;
 	case SBI_PMU_EVENT_TYPE_HW_CACHE:
 		cache_ops_result = event_idx_code &
 					SBI_PMU_EVENT_HW_CACHE_OPS_RESULT;
@@ -195,9 +251,7 @@ int sbi_pmu_ctr_fw_read(uint32_t cidx, uint64_t *cval)
 	if (event_idx_type != SBI_PMU_EVENT_TYPE_FW)
 		return SBI_EINVAL;
 
-	if ((event_code >= SBI_PMU_FW_MAX &&
-	    event_code <= SBI_PMU_FW_RESERVED_MAX) ||
-	    event_code > SBI_PMU_FW_PLATFORM)
+	if (!pmu_fw_event_code_valid(event_code))
 		return SBI_EINVAL;
 
 	if (SBI_PMU_FW_PLATFORM == event_code) {
@@ -282,6 +336,22 @@ int sbi_pmu_add_raw_event_counter_map(uint64_t select, uint64_t select_mask, u32
 				    SBI_PMU_EVENT_RAW_IDX, cmap, select, select_mask);
 }
 
+static uint64_t pmu_ctr_read_hw(uint32_t cidx)
+{
+#if __riscv_xlen == 32
+	uint32_t lo, hi;
+
+	do {
+		hi = csr_read_num(CSR_MCYCLEH + cidx);
+		lo = csr_read_num(CSR_MCYCLE + cidx);
+	} while (hi != csr_read_num(CSR_MCYCLEH + cidx));
+
+	return ((uint64_t)hi << 32) | lo;
+#else
+	return csr_read_num(CSR_MCYCLE + cidx);
+#endif
+}
+
 static int pmu_ctr_enable_irq_hw(int ctr_idx)
 {
 	unsigned long mhpmevent_csr;
@@ -382,9 +452,7 @@ static int pmu_ctr_start_fw(uint32_t cidx, uint32_t event_code,
 {
 	u32 hartid = current_hartid();
 
-	if ((event_code >= SBI_PMU_FW_MAX &&
-	    event_code <= SBI_PMU_FW_RESERVED_MAX) ||
-	    event_code > SBI_PMU_FW_PLATFORM)
+	if (!pmu_fw_event_code_valid(event_code))
 		return SBI_EINVAL;
 
 	if (SBI_PMU_FW_PLATFORM == event_code) {
@@ -475,9 +543,7 @@ static int pmu_ctr_stop_fw(uint32_t cidx, uint32_t event_code)
 	u32 hartid = current_hartid();
 	int ret;
 
-	if ((event_code >= SBI_PMU_FW_MAX &&
-	    event_code <= SBI_PMU_FW_RESERVED_MAX) ||
-	    event_code > SBI_PMU_FW_PLATFORM)
+	if (!pmu_fw_event_code_valid(event_code))
 		return SBI_EINVAL;
 
 	if (SBI_PMU_FW_PLATFORM == event_code &&
@@ -593,6 +659,31 @@ static int pmu_update_hw_mhpmevent(struct sbi_pmu_hw_event *hw_evt, int ctr_idx,
 	return 0;
 }
 
+/**
+ * Check whether a programmable hardware counter is owned by S-mode
+ *
+ * With counter delegation (Smcdeleg), the supervisor can program
+ * mhpmeventX directly via the sireg indirect CSR access. Such counters
+ * have a non-zero event selector but no event tracked by us so we must
+ * not hand them out or reset them.
+ */
+static bool pmu_ctr_is_delegated(uint32_t cidx)
+{
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+	uint64_t mhpmevent_val;
+
+	if (!sbi_hart_has_extension(scratch, SBI_HART_EXT_SMCDELEG))
+		return false;
+
+	if (cidx < 3 || cidx >= num_hw_ctrs ||
+	    active_events[current_hartid()][cidx] != SBI_PMU_EVENT_IDX_INVALID)
+		return false;
+
+	mhpmevent_val = csr_read_num(CSR_MHPMEVENT3 + cidx - 3);
+
+	return (mhpmevent_val & ~MHPMEVENT_SSCOF_MASK) ? true : false;
+}
+
 static int pmu_ctr_find_fixed_fw(unsigned long evt_idx_code)
 {
 	/* Non-programmables counters are enabled always. No need to do lookup */
@@ -652,6 +743,9 @@ static int pmu_ctr_find_hw(unsigned long cbase, unsigned long cmask, unsigned lo
 			 */
 			if (active_events[hartid][cbase] != SBI_PMU_EVENT_IDX_INVALID)
 				continue;
+			/* Counters programmed directly by S-mode are not ours */
+			if (pmu_ctr_is_delegated(cbase))
+				continue;
 			/* If mcountinhibit is supported, the bit must be enabled */
 			if ((sbi_hart_priv_version(scratch) >= SBI_HART_PRIV_VER_1_11) &&
 			    !__test_bit(cbase, &mctr_inhbt))
@@ -690,9 +784,7 @@ static int pmu_ctr_find_fw(unsigned long cbase, unsigned long cmask,
 {
 	int i, cidx;
 
-	if ((event_code >= SBI_PMU_FW_MAX &&
-	    event_code <= SBI_PMU_FW_RESERVED_MAX) ||
-	    event_code > SBI_PMU_FW_PLATFORM)
+	if (!pmu_fw_event_code_valid(event_code))
 		return SBI_EINVAL;
 
 	for_each_set_bit(i, &cmask, BITS_PER_LONG) {
@@ -783,6 +875,40 @@ skip_match:
 	return ctr_idx;
 }
 
+bool sbi_pmu_mmode_begin(uint64_t *cycle, uint64_t *instret)
+{
+	if (likely(!fw_counters_started[current_hartid()]))
+		return false;
+
+	*cycle = pmu_ctr_read_hw(0);
+	*instret = pmu_ctr_read_hw(2);
+
+	return true;
+}
+
+void sbi_pmu_mmode_end(unsigned long mclass, uint64_t cycle,
+		       uint64_t instret)
+{
+	u32 cidx, code, hartid = current_hartid();
+	unsigned long started = fw_counters_started[hartid];
+
+	cycle = pmu_ctr_read_hw(0) - cycle;
+	instret = pmu_ctr_read_hw(2) - instret;
+
+	for (cidx = num_hw_ctrs; cidx < total_ctrs; cidx++) {
+		if (!(started & BIT(cidx - num_hw_ctrs)))
+			continue;
+
+		code = get_cidx_code(active_events[hartid][cidx]);
+		if (code == SBI_PMU_FW_MMODE_CYCLES(SBI_PMU_MMODE_ALL) ||
+		    code == SBI_PMU_FW_MMODE_CYCLES(mclass))
+			fw_counters_data[hartid][cidx - num_hw_ctrs] += cycle;
+		else if (code == SBI_PMU_FW_MMODE_INSTRET(SBI_PMU_MMODE_ALL) ||
+			 code == SBI_PMU_FW_MMODE_INSTRET(mclass))
+			fw_counters_data[hartid][cidx - num_hw_ctrs] += instret;
+	}
+}
+
 int sbi_pmu_ctr_incr_fw(enum sbi_pmu_fw_event_code_id fw_id)
 {
 	u32 cidx, hartid = current_hartid();
@@ -861,6 +987,109 @@ static void pmu_reset_event_map(u32 hartid)
 	fw_counters_started[hartid] = 0;
 }
 
+static void pmu_sample_process(struct sbi_trap_regs *regs)
+{
+	struct pmu_sample_state *ss =
+			sbi_scratch_thishart_offset_ptr(pmu_sample_off);
+	struct sbi_pmu_sample *smp;
+	int irq_bit;
+
+	if (!ss->active)
+		return;
+
+	/* Drop the sample if S-mode did not drain the ring in time */
+	if (ss->count < SBI_PMU_SAMPLE_MAX) {
+		smp = &ss->ring[(ss->head + ss->count) % SBI_PMU_SAMPLE_MAX];
+		smp->pc = regs->mepc;
+		smp->mode = (regs->mstatus & MSTATUS_MPP) >> MSTATUS_MPP_SHIFT;
+#if __riscv_xlen == 32
+		if (regs->mstatusH & MSTATUSH_MPV)
+#else
+		if (regs->mstatus & MSTATUS_MPV)
+#endif
+			smp->mode |= SBI_PMU_SAMPLE_MODE_VIRT;
+		smp->ctr_value = pmu_ctr_read_hw(ss->cidx);
+		ss->count++;
+	}
+
+	/*
+	 * Emulate counter overflow interrupt so that S-mode drains the
+	 * ring. Without a PMU interrupt S-mode has to poll the ring.
+	 */
+	if (ss->irq && ss->count >= (SBI_PMU_SAMPLE_MAX / 2)) {
+		irq_bit = sbi_pmu_irq_bit();
+		if (irq_bit)
+			csr_set(CSR_MIP, irq_bit);
+	}
+
+	sbi_timer_mmode_event_start(sbi_timer_value() + ss->period,
+				    pmu_sample_process);
+}
+
+int sbi_pmu_sample_start(unsigned long period, unsigned long cidx,
+			 unsigned long flags)
+{
+	struct pmu_sample_state *ss =
+			sbi_scratch_thishart_offset_ptr(pmu_sample_off);
+	int rc;
+
+	/* Counter1 (i.e. TIME CSR) is not mapped at all */
+	if (!period || cidx >= num_hw_ctrs || cidx == 1 ||
+	    (flags & ~SBI_PMU_SAMPLE_FLAG_NO_IRQ))
+		return SBI_EINVAL;
+
+	if (ss->active)
+		return SBI_EALREADY_STARTED;
+
+	ss->irq = (flags & SBI_PMU_SAMPLE_FLAG_NO_IRQ) ? false : true;
+	ss->cidx = cidx;
+	ss->head = 0;
+	ss->count = 0;
+	ss->period = period;
+	ss->active = true;
+
+	rc = sbi_timer_mmode_event_start(sbi_timer_value() + period,
+					 pmu_sample_process);
+	if (rc) {
+		ss->active = false;
+		return SBI_ENOTSUPP;
+	}
+
+	return 0;
+}
+
+int sbi_pmu_sample_stop(void)
+{
+	struct pmu_sample_state *ss =
+			sbi_scratch_thishart_offset_ptr(pmu_sample_off);
+
+	if (!ss->active)
+		return SBI_EALREADY_STOPPED;
+
+	ss->active = false;
+	sbi_timer_mmode_event_stop();
+
+	return 0;
+}
+
+int sbi_pmu_sample_read(unsigned long addr, unsigned long num,
+			unsigned long *out_num)
+{
+	struct pmu_sample_state *ss =
+			sbi_scratch_thishart_offset_ptr(pmu_sample_off);
+	struct sbi_pmu_sample *out = (struct sbi_pmu_sample *)addr;
+	unsigned long i;
+
+	for (i = 0; i < num && ss->count; i++) {
+		sbi_memcpy(&out[i], &ss->ring[ss->head], sizeof(*out));
+		ss->head = (ss->head + 1) % SBI_PMU_SAMPLE_MAX;
+		ss->count--;
+	}
+	*out_num = i;
+
+	return 0;
+}
+
 const struct sbi_pmu_device *sbi_pmu_get_device(void)
 {
 	return pmu_dev;
@@ -874,9 +1103,72 @@ void sbi_pmu_set_device(const struct sbi_pmu_device *dev)
 	pmu_dev = dev;
 }
 
+void sbi_pmu_context_save(struct sbi_scratch *scratch)
+{
+	u32 hartid = current_hartid();
+	struct pmu_hart_context *ctx =
+			sbi_scratch_offset_ptr(scratch, pmu_context_off);
+	uint32_t cidx;
+
+	if (sbi_hart_priv_version(scratch) >= SBI_HART_PRIV_VER_1_11)
+		ctx->mcountinhibit = csr_read(CSR_MCOUNTINHIBIT);
+
+	/*
+	 * Only the event selectors are saved. Counter values belong to
+	 * the supervisor which stops the counters before suspending and
+	 * restarts them with an initial value without matching again.
+	 */
+	for (cidx = 3; cidx < num_hw_ctrs; cidx++) {
+		if (active_events[hartid][cidx] == SBI_PMU_EVENT_IDX_INVALID)
+			continue;
+#if __riscv_xlen == 32
+		ctx->mhpmevent[cidx - 3] =
+			csr_read_num(CSR_MHPMEVENT3 + cidx - 3);
+		if (sbi_hart_has_extension(scratch, SBI_HART_EXT_SSCOFPMF))
+			ctx->mhpmevent[cidx - 3] |= (uint64_t)
+				csr_read_num(CSR_MHPMEVENT3H + cidx - 3) << 32;
+#else
+		ctx->mhpmevent[cidx - 3] =
+			csr_read_num(CSR_MHPMEVENT3 + cidx - 3);
+#endif
+	}
+}
+
+void sbi_pmu_context_restore(struct sbi_scratch *scratch)
+{
+	u32 hartid = current_hartid();
+	struct pmu_hart_context *ctx =
+			sbi_scratch_offset_ptr(scratch, pmu_context_off);
+	uint32_t cidx;
+
+	/* Inactive counters were reset by the warm-boot sequence */
+	for (cidx = 3; cidx < num_hw_ctrs; cidx++) {
+		if (active_events[hartid][cidx] == SBI_PMU_EVENT_IDX_INVALID)
+			continue;
+#if __riscv_xlen == 32
+		csr_write_num(CSR_MHPMEVENT3 + cidx - 3,
+			      ctx->mhpmevent[cidx - 3] & 0xFFFFFFFF);
+		if (sbi_hart_has_extension(scratch, SBI_HART_EXT_SSCOFPMF))
+			csr_write_num(CSR_MHPMEVENT3H + cidx - 3,
+				      ctx->mhpmevent[cidx - 3] >> BITS_PER_LONG);
+#else
+		csr_write_num(CSR_MHPMEVENT3 + cidx - 3,
+			      ctx->mhpmevent[cidx - 3]);
+#endif
+	}
+
+	if (sbi_hart_priv_version(scratch) >= SBI_HART_PRIV_VER_1_11)
+		csr_write(CSR_MCOUNTINHIBIT, ctx->mcountinhibit);
+}
+
 void sbi_pmu_exit(struct sbi_scratch *scratch)
 {
 	u32 hartid = current_hartid();
+	struct pmu_sample_state *ss =
+			sbi_scratch_offset_ptr(scratch, pmu_sample_off);
+
+	if (ss->active)
+		sbi_pmu_sample_stop();
 
 	if (sbi_hart_priv_version(scratch) >= SBI_HART_PRIV_VER_1_11)
 		csr_write(CSR_MCOUNTINHIBIT, 0xFFFFFFF8);
@@ -889,9 +1181,14 @@ void sbi_pmu_exit(struct sbi_scratch *scratch)
 int sbi_pmu_init(struct sbi_scratch *scratch, bool cold_boot)
 {
 	const struct sbi_platform *plat;
+	struct pmu_sample_state *ss;
 	u32 hartid = current_hartid();
 
 	if (cold_boot) {
+		pmu_sample_off = sbi_scratch_alloc_offset(sizeof(*ss));
+		if (!pmu_sample_off)
+			return SBI_ENOMEM;
+
 		plat = sbi_platform_ptr(scratch);
 		/* Initialize hw pmu events */
 		sbi_platform_pmu_init(plat);
@@ -899,10 +1196,20 @@ int sbi_pmu_init(struct sbi_scratch *scratch, bool cold_boot)
 		/* mcycle & minstret is available always */
 		num_hw_ctrs = sbi_hart_mhpm_count(scratch) + 3;
 		total_ctrs = num_hw_ctrs + SBI_PMU_FW_CTR_MAX;
+
+		pmu_context_off = sbi_scratch_alloc_offset(
+				sizeof(struct pmu_hart_context) +
+				(num_hw_ctrs - 3) * sizeof(uint64_t));
+		if (!pmu_context_off)
+			return SBI_ENOMEM;
 	}
 
 	pmu_reset_event_map(hartid);
 
+	ss = sbi_scratch_offset_ptr(scratch, pmu_sample_off);
+	ss->active = false;
+	ss->count = 0;
+
 	/* First three counters are fixed by the priv spec and we enable it by default */
 	active_events[hartid][0] = SBI_PMU_EVENT_TYPE_HW << SBI_PMU_EVENT_IDX_TYPE_OFFSET |
 				   SBI_PMU_HW_CPU_CYCLES;
@@ -64,7 +64,7 @@ unsigned long sbi_scratch_alloc_offset(unsigned long size)
 
 	spin_lock(&extra_lock);
 
-	if (SBI_SCRATCH_SIZE < (extra_offset + size))
+	if (SBI_SCRATCH_LOCK_NODES_OFFSET < (extra_offset + size))
 		goto done;
 
 	ret = extra_offset;
@@ -89,7 +89,7 @@ done:
 void sbi_scratch_free_offset(unsigned long offset)
 {
 	if ((offset < SBI_SCRATCH_EXTRA_SPACE_OFFSET) ||
-	    (SBI_SCRATCH_SIZE <= offset))
+	    (SBI_SCRATCH_LOCK_NODES_OFFSET <= offset))
 		return;
 
 	/*
@@ -13,6 +13,8 @@
 #include <sbi/sbi_domain.h>
 #include <sbi/sbi_hart.h>
 #include <sbi/sbi_hsm.h>
+#include <sbi/sbi_irqchip.h>
+#include <sbi/sbi_lockstat.h>
 #include <sbi/sbi_platform.h>
 #include <sbi/sbi_system.h>
 #include <sbi/sbi_ipi.h>
@@ -79,6 +81,9 @@ void __noreturn sbi_system_reset(u32 reset_type, u32 reset_reason)
 		hbase += BITS_PER_LONG;
 	}
 
+	/* Other HARTs are halting so their lock statistics are final */
+	sbi_lockstat_dump();
+
 	/* Stop current HART */
 	sbi_hsm_hart_stop(scratch, false);
 
@@ -95,6 +100,7 @@ void __noreturn sbi_system_reset(u32 reset_type, u32 reset_reason)
 }
 
 static const struct sbi_system_suspend_device *suspend_dev = NULL;
+static bool system_suspended;
 
 const struct sbi_system_suspend_device *sbi_system_suspend_get_device(void)
 {
@@ -179,9 +185,15 @@ int sbi_system_suspend(u32 sleep_type, ulong resume_addr, ulong opaque)
 				   SBI_DOMAIN_EXECUTE))
 		return SBI_EINVALID_ADDR;
 
+	ret = sbi_irqchip_suspend(scratch);
+	if (ret)
+		return ret;
+
 	if (!sbi_hsm_hart_change_state(scratch, SBI_HSM_STATE_STARTED,
-				       SBI_HSM_STATE_SUSPENDED))
+				       SBI_HSM_STATE_SUSPENDED)) {
+		sbi_irqchip_resume(scratch);
 		return SBI_EFAIL;
+	}
 
 	/* Prepare for resume */
 	scratch->next_mode = prev_mode;
@@ -191,8 +203,11 @@ int sbi_system_suspend(u32 sleep_type, ulong resume_addr, ulong opaque)
 	__sbi_hsm_suspend_non_ret_save(scratch);
 
 	/* Suspend */
+	system_suspended = true;
 	ret = suspend_dev->system_suspend(sleep_type, scratch->warmboot_addr);
 	if (ret != SBI_OK) {
+		system_suspended = false;
+		sbi_irqchip_resume(scratch);
 		if (!sbi_hsm_hart_change_state(scratch, SBI_HSM_STATE_SUSPENDED,
 					       SBI_HSM_STATE_STARTED))
 			sbi_hart_hang();
@@ -204,3 +219,12 @@ int sbi_system_suspend(u32 sleep_type, ulong resume_addr, ulong opaque)
 
 	__builtin_unreachable();
 }
+
+void sbi_system_resume(struct sbi_scratch *scratch)
+{
+	if (!system_suspended)
+		return;
+
+	system_suspended = false;
+	sbi_irqchip_resume(scratch);
+}
@@ -18,7 +18,20 @@
 #include <sbi/sbi_scratch.h>
 #include <sbi/sbi_timer.h>
 
+/** Per-HART timer events multiplexed on the M-mode timer */
+struct sbi_timer_events {
+	/** Next S-mode timer event (without Sstc) or -1ULL */
+	u64 smode_next;
+	/** Next M-mode timer event or -1ULL */
+	u64 mmode_next;
+	/** Function called upon M-mode timer event */
+	void (*mmode_fn)(struct sbi_trap_regs *regs);
+	/** Saved stimecmp (Sstc only) across non-retentive suspend */
+	u64 saved_stimecmp;
+};
+
 static unsigned long time_delta_off;
+static unsigned long timer_events_off;
 static u64 (*get_time_val)(void);
 static const struct sbi_timer_device *timer_dev = NULL;
 
@@ -129,15 +142,34 @@ void sbi_timer_set_delta_upper(ulong delta_upper)
 	*time_delta |= ((u64)delta_upper << 32);
 }
 
-void sbi_timer_event_start(u64 next_event)
+static void timer_events_program(struct sbi_scratch *scratch,
+				 struct sbi_timer_events *ev)
 {
-	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_SET_TIMER);
+	u64 next_event = ev->mmode_next;
+
+	if (!sbi_hart_has_extension(scratch, SBI_HART_EXT_SSTC) &&
+	    ev->smode_next < next_event)
+		next_event = ev->smode_next;
+
+	if (next_event == -1ULL)
+		return;
+
+	if (timer_dev && timer_dev->timer_event_start)
+		timer_dev->timer_event_start(next_event);
+	csr_set(CSR_MIE, MIP_MTIP);
+}
+
+static void timer_smode_event_program(u64 next_event)
+{
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+	struct sbi_timer_events *ev =
+			sbi_scratch_offset_ptr(scratch, timer_events_off);
 
 	/**
 	 * Update the stimecmp directly if available. This allows
 	 * the older software to leverage sstc extension on newer hardware.
 	 */
-	if (sbi_hart_has_extension(sbi_scratch_thishart_ptr(), SBI_HART_EXT_SSTC)) {
+	if (sbi_hart_has_extension(scratch, SBI_HART_EXT_SSTC)) {
 #if __riscv_xlen == 32
 		csr_write(CSR_STIMECMP, next_event & 0xFFFFFFFF);
 		csr_write(CSR_STIMECMPH, next_event >> 32);
@@ -145,22 +177,130 @@ void sbi_timer_event_start(u64 next_event)
 		csr_write(CSR_STIMECMP, next_event);
 #endif
 	} else if (timer_dev && timer_dev->timer_event_start) {
+		ev->smode_next = next_event;
+		/*
+		 * The M-mode timer is shared with M-mode timer events
+		 * so program whichever event comes first.
+		 */
+		if (ev->mmode_next < next_event)
+			next_event = ev->mmode_next;
 		timer_dev->timer_event_start(next_event);
 		csr_clear(CSR_MIP, MIP_STIP);
 	}
 	csr_set(CSR_MIE, MIP_MTIP);
 }
 
-void sbi_timer_process(void)
+void sbi_timer_event_start(u64 next_event)
+{
+	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_SET_TIMER);
+	timer_smode_event_program(next_event);
+}
+
+u64 sbi_timer_smode_event_save(void)
+{
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+	struct sbi_timer_events *ev =
+			sbi_scratch_offset_ptr(scratch, timer_events_off);
+	u64 next_event;
+
+	if (!sbi_hart_has_extension(scratch, SBI_HART_EXT_SSTC))
+		return ev->smode_next;
+
+#if __riscv_xlen == 32
+	next_event = csr_read(CSR_STIMECMP);
+	next_event |= (u64)csr_read(CSR_STIMECMPH) << 32;
+#else
+	next_event = csr_read(CSR_STIMECMP);
+#endif
+
+	return next_event;
+}
+
+void sbi_timer_smode_event_restore(u64 next_event)
+{
+	/* A timer which fired already pends again right away */
+	csr_clear(CSR_MIP, MIP_STIP);
+	timer_smode_event_program(next_event);
+}
+
+int sbi_timer_mmode_event_start(u64 next_event,
+				void (*fn)(struct sbi_trap_regs *regs))
+{
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+	struct sbi_timer_events *ev =
+			sbi_scratch_offset_ptr(scratch, timer_events_off);
+
+	if (!timer_dev || !timer_dev->timer_event_start || !get_time_val)
+		return SBI_ENODEV;
+	if (!fn || next_event == -1ULL)
+		return SBI_EINVAL;
+
+	ev->mmode_fn = fn;
+	ev->mmode_next = next_event;
+	timer_events_program(scratch, ev);
+
+	return 0;
+}
+
+void sbi_timer_mmode_event_stop(void)
+{
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+	struct sbi_timer_events *ev =
+			sbi_scratch_offset_ptr(scratch, timer_events_off);
+
+	if (ev->mmode_next == -1ULL)
+		return;
+
+	ev->mmode_next = -1ULL;
+	ev->mmode_fn = NULL;
+
+	/* Fallback to the pending S-mode timer event (if any) */
+	csr_clear(CSR_MIE, MIP_MTIP);
+	if (timer_dev && timer_dev->timer_event_stop)
+		timer_dev->timer_event_stop();
+	timer_events_program(scratch, ev);
+}
+
+void sbi_timer_process(struct sbi_trap_regs *regs)
 {
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+	struct sbi_timer_events *ev =
+			sbi_scratch_offset_ptr(scratch, timer_events_off);
+	bool sstc = sbi_hart_has_extension(scratch, SBI_HART_EXT_SSTC);
+	void (*fn)(struct sbi_trap_regs *regs);
+	u64 now;
+
 	csr_clear(CSR_MIE, MIP_MTIP);
-	/*
-	 * If sstc extension is available, supervisor can receive the timer
-	 * directly without M-mode come in between. This function should
-	 * only invoked if M-mode programs the timer for its own purpose.
-	 */
-	if (!sbi_hart_has_extension(sbi_scratch_thishart_ptr(), SBI_HART_EXT_SSTC))
+
+	/* Fast path when M-mode timer is only used for S-mode timer */
+	if (ev->mmode_next == -1ULL) {
+		/*
+		 * If sstc extension is available, supervisor can receive the
+		 * timer directly without M-mode come in between. This function
+		 * should only invoked if M-mode programs the timer for its own
+		 * purpose.
+		 */
+		if (!sstc) {
+			ev->smode_next = -1ULL;
+			csr_set(CSR_MIP, MIP_STIP);
+		}
+		return;
+	}
+
+	now = get_time_val();
+	if (!sstc && ev->smode_next <= now) {
+		ev->smode_next = -1ULL;
 		csr_set(CSR_MIP, MIP_STIP);
+	}
+	if (ev->mmode_next <= now) {
+		fn = ev->mmode_fn;
+		ev->mmode_next = -1ULL;
+		/* The function can re-arm M-mode timer event */
+		if (fn)
+			fn(regs);
+	}
+
+	timer_events_program(scratch, ev);
 }
 
 const struct sbi_timer_device *sbi_timer_get_device(void)
@@ -181,6 +321,7 @@ void sbi_timer_set_device(const struct sbi_timer_device *dev)
 int sbi_timer_init(struct sbi_scratch *scratch, bool cold_boot)
 {
 	u64 *time_delta;
+	struct sbi_timer_events *ev;
 	const struct sbi_platform *plat = sbi_platform_ptr(scratch);
 
 	if (cold_boot) {
@@ -188,21 +329,73 @@ int sbi_timer_init(struct sbi_scratch *scratch, bool cold_boot)
 		if (!time_delta_off)
 			return SBI_ENOMEM;
 
+		timer_events_off = sbi_scratch_alloc_offset(sizeof(*ev));
+		if (!timer_events_off)
+			return SBI_ENOMEM;
+
 		if (sbi_hart_has_extension(scratch, SBI_HART_EXT_TIME))
 			get_time_val = get_ticks;
 	} else {
-		if (!time_delta_off)
+		if (!time_delta_off || !timer_events_off)
 			return SBI_ENOMEM;
 	}
 
 	time_delta = sbi_scratch_offset_ptr(scratch, time_delta_off);
 	*time_delta = 0;
 
+	ev = sbi_scratch_offset_ptr(scratch, timer_events_off);
+	ev->smode_next = -1ULL;
+	ev->mmode_next = -1ULL;
+	ev->mmode_fn = NULL;
+	ev->saved_stimecmp = -1ULL;
+
 	return sbi_platform_timer_init(plat, cold_boot);
 }
 
+void sbi_timer_context_save(struct sbi_scratch *scratch)
+{
+	struct sbi_timer_events *ev =
+			sbi_scratch_offset_ptr(scratch, timer_events_off);
+
+	/* Events without Sstc are kept in scratch which is retained */
+	if (!sbi_hart_has_extension(scratch, SBI_HART_EXT_SSTC))
+		return;
+
+#if __riscv_xlen == 32
+	ev->saved_stimecmp = csr_read(CSR_STIMECMP);
+	ev->saved_stimecmp |= (u64)csr_read(CSR_STIMECMPH) << 32;
+#else
+	ev->saved_stimecmp = csr_read(CSR_STIMECMP);
+#endif
+}
+
+void sbi_timer_context_restore(struct sbi_scratch *scratch)
+{
+	struct sbi_timer_events *ev =
+			sbi_scratch_offset_ptr(scratch, timer_events_off);
+
+	if (sbi_hart_has_extension(scratch, SBI_HART_EXT_SSTC)) {
+#if __riscv_xlen == 32
+		csr_write(CSR_STIMECMP, ev->saved_stimecmp & 0xFFFFFFFF);
+		csr_write(CSR_STIMECMPH, ev->saved_stimecmp >> 32);
+#else
+		csr_write(CSR_STIMECMP, ev->saved_stimecmp);
+#endif
+	}
+
+	/* The timer device may have lost the comparator of this HART */
+	timer_events_program(scratch, ev);
+}
+
 void sbi_timer_exit(struct sbi_scratch *scratch)
 {
+	struct sbi_timer_events *ev =
+			sbi_scratch_offset_ptr(scratch, timer_events_off);
+
+	ev->smode_next = -1ULL;
+	ev->mmode_next = -1ULL;
+	ev->mmode_fn = NULL;
+
 	if (timer_dev && timer_dev->timer_event_stop)
 		timer_dev->timer_event_stop();
 
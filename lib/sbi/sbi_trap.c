@@ -12,6 +12,7 @@
 #include <sbi/sbi_bitops.h>
 #include <sbi/sbi_console.h>
 #include <sbi/sbi_ecall.h>
+#include <sbi/sbi_ecall_interface.h>
 #include <sbi/sbi_error.h>
 #include <sbi/sbi_hart.h>
 #include <sbi/sbi_illegal_insn.h>
@@ -20,9 +21,126 @@
 #include <sbi/sbi_misaligned_ldst.h>
 #include <sbi/sbi_pmu.h>
 #include <sbi/sbi_scratch.h>
+#include <sbi/sbi_string.h>
 #include <sbi/sbi_timer.h>
 #include <sbi/sbi_trap.h>
 
+#ifdef CONFIG_SBI_TRAP_HOTSPOT
+
+#define TRAP_HOTSPOT_WAYS		4
+#define TRAP_HOTSPOT_SETS		(SBI_TRAP_HOTSPOT_MAX / TRAP_HOTSPOT_WAYS)
+
+/** Per-HART set associative table of trap emulation hotspots */
+struct trap_hotspot_table {
+	/* Monotonic counter used to track least recently used entry */
+	unsigned long tick;
+	/* Number of traps redirected by sbi_trap_redirect() */
+	unsigned long redirects;
+	unsigned long last_use[SBI_TRAP_HOTSPOT_MAX];
+	struct sbi_trap_hotspot ents[SBI_TRAP_HOTSPOT_MAX];
+};
+
+static unsigned long trap_hotspot_off;
+
+static void trap_hotspot_update(ulong pc, ulong cause, ulong mode,
+				ulong cycles)
+{
+	struct trap_hotspot_table *tbl;
+	struct sbi_trap_hotspot *ent;
+	unsigned int i, set, victim;
+
+	if (!trap_hotspot_off)
+		return;
+	tbl = sbi_scratch_thishart_offset_ptr(trap_hotspot_off);
+
+	set = ((pc >> 1) ^ (pc >> 7) ^ cause) % TRAP_HOTSPOT_SETS;
+	set *= TRAP_HOTSPOT_WAYS;
+
+	victim = set;
+	for (i = set; i < (set + TRAP_HOTSPOT_WAYS); i++) {
+		ent = &tbl->ents[i];
+		if (ent->hits && ent->pc == pc &&
+		    ent->cause == cause && ent->mode == mode)
+			goto found;
+		if (tbl->last_use[i] < tbl->last_use[victim])
+			victim = i;
+	}
+
+	/* Evict the least recently used entry of the set */
+	ent = &tbl->ents[victim];
+	ent->pc = pc;
+	ent->cause = cause;
+	ent->mode = mode;
+	ent->hits = 0;
+	ent->cycles = 0;
+	i = victim;
+
+found:
+	ent->hits++;
+	ent->cycles += cycles;
+	tbl->last_use[i] = ++tbl->tick;
+}
+
+unsigned long sbi_trap_hotspot_read(struct sbi_trap_hotspot *out,
+				    unsigned long num, bool reset)
+{
+	struct trap_hotspot_table *tbl;
+	unsigned long i, ret = 0;
+
+	if (!trap_hotspot_off)
+		return 0;
+	tbl = sbi_scratch_thishart_offset_ptr(trap_hotspot_off);
+
+	for (i = 0; i < SBI_TRAP_HOTSPOT_MAX && ret < num; i++) {
+		if (!tbl->ents[i].hits)
+			continue;
+		sbi_memcpy(&out[ret++], &tbl->ents[i], sizeof(*out));
+	}
+
+	if (reset)
+		sbi_memset(tbl, 0, sizeof(*tbl));
+
+	return ret;
+}
+
+static unsigned long trap_hotspot_redirects(void)
+{
+	struct trap_hotspot_table *tbl;
+
+	if (!trap_hotspot_off)
+		return 0;
+	tbl = sbi_scratch_thishart_offset_ptr(trap_hotspot_off);
+
+	return tbl->redirects;
+}
+
+static void trap_hotspot_redirected(void)
+{
+	struct trap_hotspot_table *tbl;
+
+	if (!trap_hotspot_off)
+		return;
+	tbl = sbi_scratch_thishart_offset_ptr(trap_hotspot_off);
+
+	tbl->redirects++;
+}
+
+static ulong trap_hotspot_mode(const struct sbi_trap_regs *regs)
+{
+	ulong mode = (regs->mstatus & MSTATUS_MPP) >> MSTATUS_MPP_SHIFT;
+
+#if __riscv_xlen == 32
+	if (regs->mstatusH & MSTATUSH_MPV)
+#else
+	if (regs->mstatus & MSTATUS_MPV)
+#endif
+		mode |= SBI_TRAP_HOTSPOT_MODE_VIRT;
+
+	return mode;
+}
+
+#endif
+
 static void __noreturn sbi_trap_error(const char *msg, int rc,
 				      ulong mcause, ulong mtval, ulong mtval2,
 				      ulong mtinst, struct sbi_trap_regs *regs)
@@ -195,6 +313,10 @@ int sbi_trap_redirect(struct sbi_trap_regs *regs,
 		regs->mstatus &= ~MSTATUS_SIE;
 	}
 
+#ifdef CONFIG_SBI_TRAP_HOTSPOT
+	trap_hotspot_redirected();
+#endif
+
 	return 0;
 }
 
@@ -203,7 +325,7 @@ static int sbi_trap_nonaia_irq(struct sbi_trap_regs *regs, ulong mcause)
 	mcause &= ~(1UL << (__riscv_xlen - 1));
 	switch (mcause) {
 	case IRQ_M_TIMER:
-		sbi_timer_process();
+		sbi_timer_process(regs);
 		break;
 	case IRQ_M_SOFT:
 		sbi_ipi_process();
@@ -226,7 +348,7 @@ static int sbi_trap_aia_irq(struct sbi_trap_regs *regs, ulong mcause)
 		mtopi = mtopi >> TOPI_IID_SHIFT;
 		switch (mtopi) {
 		case IRQ_M_TIMER:
-			sbi_timer_process();
+			sbi_timer_process(regs);
 			break;
 		case IRQ_M_SOFT:
 			sbi_ipi_process();
@@ -244,29 +366,16 @@ static int sbi_trap_aia_irq(struct sbi_trap_regs *regs, ulong mcause)
 	return 0;
 }
 
-/**
- * Handle trap/interrupt
- *
- * This function is called by firmware linked to OpenSBI
- * library for handling trap/interrupt. It expects the
- * following:
- * 1. The 'mscratch' CSR is pointing to sbi_scratch of current HART
- * 2. The 'mcause' CSR is having exception/interrupt cause
- * 3. The 'mtval' CSR is having additional trap information
- * 4. The 'mtval2' CSR is having additional trap information
- * 5. The 'mtinst' CSR is having decoded trap instruction
- * 6. Stack pointer (SP) is setup for current HART
- * 7. Interrupts are disabled in MSTATUS CSR
- *
- * @param regs pointer to register state
- */
-struct sbi_trap_regs *sbi_trap_handler(struct sbi_trap_regs *regs)
+static struct sbi_trap_regs *trap_handler(struct sbi_trap_regs *regs)
 {
 	int rc = SBI_ENOTSUPP;
 	const char *msg = "trap handler failed";
 	ulong mcause = csr_read(CSR_MCAUSE);
 	ulong mtval = csr_read(CSR_MTVAL), mtval2 = 0, mtinst = 0;
 	struct sbi_trap_info trap;
+#ifdef CONFIG_SBI_TRAP_HOTSPOT
+	ulong epc, mode, cycles, redirects;
+#endif
 
 	if (misa_extension('H')) {
 		mtval2 = csr_read(CSR_MTVAL2);
@@ -288,16 +397,34 @@ struct sbi_trap_regs *sbi_trap_handler(struct sbi_trap_regs *regs)
 
 	switch (mcause) {
 	case CAUSE_ILLEGAL_INSTRUCTION:
-		rc  = sbi_illegal_insn_handler(mtval, regs);
-		msg = "illegal instruction handler failed";
-		break;
 	case CAUSE_MISALIGNED_LOAD:
-		rc = sbi_misaligned_load_handler(mtval, mtval2, mtinst, regs);
-		msg = "misaligned load handler failed";
-		break;
 	case CAUSE_MISALIGNED_STORE:
-		rc  = sbi_misaligned_store_handler(mtval, mtval2, mtinst, regs);
-		msg = "misaligned store handler failed";
+#ifdef CONFIG_SBI_TRAP_HOTSPOT
+		epc = regs->mepc;
+		mode = trap_hotspot_mode(regs);
+		redirects = trap_hotspot_redirects();
+		cycles = csr_read(CSR_MCYCLE);
+#endif
+
+		if (mcause == CAUSE_ILLEGAL_INSTRUCTION) {
+			rc  = sbi_illegal_insn_handler(mtval, regs);
+			msg = "illegal instruction handler failed";
+		} else if (mcause == CAUSE_MISALIGNED_LOAD) {
+			rc = sbi_misaligned_load_handler(mtval, mtval2, mtinst,
+							 regs);
+			msg = "misaligned load handler failed";
+		} else {
+			rc  = sbi_misaligned_store_handler(mtval, mtval2,
+							   mtinst, regs);
+			msg = "misaligned store handler failed";
+		}
+
+#ifdef CONFIG_SBI_TRAP_HOTSPOT
+		/* Only account traps that were emulated, not redirected */
+		if (!rc && redirects == trap_hotspot_redirects())
+			trap_hotspot_update(epc, mcause, mode,
+					    csr_read(CSR_MCYCLE) - cycles);
+#endif
 		break;
 	case CAUSE_SUPERVISOR_ECALL:
 	case CAUSE_MACHINE_ECALL:
@@ -328,6 +455,102 @@ trap_error:
 	return regs;
 }
 
+static unsigned long trap_mmode_class(ulong mcause, ulong extid)
+{
+	if (mcause & (1UL << (__riscv_xlen - 1))) {
+		mcause &= ~(1UL << (__riscv_xlen - 1));
+		switch (mcause) {
+		case IRQ_M_TIMER:
+			return SBI_PMU_MMODE_IRQ_TIMER;
+		case IRQ_M_SOFT:
+			return SBI_PMU_MMODE_IRQ_IPI;
+		default:
+			return SBI_PMU_MMODE_IRQ_EXT;
+		}
+	}
+
+	switch (mcause) {
+	case CAUSE_ILLEGAL_INSTRUCTION:
+		return SBI_PMU_MMODE_EMUL_ILLEGAL_INSN;
+	case CAUSE_MISALIGNED_LOAD:
+		return SBI_PMU_MMODE_EMUL_MISALIGNED_LOAD;
+	case CAUSE_MISALIGNED_STORE:
+		return SBI_PMU_MMODE_EMUL_MISALIGNED_STORE;
+	case CAUSE_SUPERVISOR_ECALL:
+	case CAUSE_MACHINE_ECALL:
+		break;
+	default:
+		return SBI_PMU_MMODE_REDIRECT;
+	}
+
+	switch (extid) {
+	case SBI_EXT_BASE:
+		return SBI_PMU_MMODE_ECALL_BASE;
+	case SBI_EXT_TIME:
+		return SBI_PMU_MMODE_ECALL_TIME;
+	case SBI_EXT_IPI:
+		return SBI_PMU_MMODE_ECALL_IPI;
+	case SBI_EXT_RFENCE:
+		return SBI_PMU_MMODE_ECALL_RFENCE;
+	case SBI_EXT_HSM:
+		return SBI_PMU_MMODE_ECALL_HSM;
+	case SBI_EXT_SRST:
+		return SBI_PMU_MMODE_ECALL_SRST;
+	case SBI_EXT_PMU:
+		return SBI_PMU_MMODE_ECALL_PMU;
+	case SBI_EXT_DBCN:
+		return SBI_PMU_MMODE_ECALL_DBCN;
+	case SBI_EXT_SUSP:
+		return SBI_PMU_MMODE_ECALL_SUSP;
+	case SBI_EXT_CPPC:
+		return SBI_PMU_MMODE_ECALL_CPPC;
+	default:
+		break;
+	}
+
+	if (extid <= SBI_EXT_0_1_SHUTDOWN)
+		return SBI_PMU_MMODE_ECALL_LEGACY;
+	if (SBI_EXT_VENDOR_START <= extid && extid <= SBI_EXT_VENDOR_END)
+		return SBI_PMU_MMODE_ECALL_VENDOR;
+
+	return SBI_PMU_MMODE_ECALL_OTHER;
+}
+
+/**
+ * Handle trap/interrupt
+ *
+ * This function is called by firmware linked to OpenSBI
+ * library for handling trap/interrupt. It expects the
+ * following:
+ * 1. The 'mscratch' CSR is pointing to sbi_scratch of current HART
+ * 2. The 'mcause' CSR is having exception/interrupt cause
+ * 3. The 'mtval' CSR is having additional trap information
+ * 4. The 'mtval2' CSR is having additional trap information
+ * 5. The 'mtinst' CSR is having decoded trap instruction
+ * 6. Stack pointer (SP) is setup for current HART
+ * 7. Interrupts are disabled in MSTATUS CSR
+ *
+ * @param regs pointer to register state
+ */
+struct sbi_trap_regs *sbi_trap_handler(struct sbi_trap_regs *regs)
+{
+	unsigned long mclass;
+	uint64_t cycle, instret;
+
+	if (likely(!sbi_pmu_mmode_begin(&cycle, &instret)))
+		return trap_handler(regs);
+
+	/*
+	 * Classify the trap upfront because mcause can be clobbered
+	 * by expected traps while handling this trap.
+	 */
+	mclass = trap_mmode_class(csr_read(CSR_MCAUSE), regs->a7);
+	regs = trap_handler(regs);
+	sbi_pmu_mmode_end(mclass, cycle, instret);
+
+	return regs;
+}
+
 typedef void (*trap_exit_t)(const struct sbi_trap_regs *regs);
 
 /**
@@ -346,3 +569,17 @@ void __noreturn sbi_trap_exit(const struct sbi_trap_regs *regs)
 	((trap_exit_t)scratch->trap_exit)(regs);
 	__builtin_unreachable();
 }
+
+int sbi_trap_init(struct sbi_scratch *scratch, bool cold_boot)
+{
+#ifdef CONFIG_SBI_TRAP_HOTSPOT
+	if (cold_boot) {
+		trap_hotspot_off = sbi_scratch_alloc_offset(
+					sizeof(struct trap_hotspot_table));
+		if (!trap_hotspot_off)
+			return SBI_ENOMEM;
+	}
+#endif
+
+	return 0;
+}
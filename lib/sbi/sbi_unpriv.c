@@ -7,10 +7,12 @@
  *   Anup Patel <anup.patel@wdc.com>
  */
 
+#include <sbi/riscv_asm.h>
 #include <sbi/riscv_encoding.h>
 #include <sbi/sbi_bitops.h>
 #include <sbi/sbi_hart.h>
 #include <sbi/sbi_scratch.h>
+#include <sbi/sbi_string.h>
 #include <sbi/sbi_trap.h>
 #include <sbi/sbi_unpriv.h>
 
@@ -116,6 +118,173 @@ void sbi_store_u64(u64 *addr, u64 val,
 # error "Unexpected __riscv_xlen"
 #endif
 
+/**
+ * Unprivileged access helpers for the bulk copy functions below. Unlike
+ * the sbi_load_xyz()/sbi_store_xyz() functions, these expect the caller
+ * to have already pointed MTVEC to the expected trap handler so only the
+ * MPRV bit is toggled around the access. The MPRV bit has to be cleared
+ * between accesses because the M-mode side of the copy (and the stack)
+ * must not be translated using the privilege mode in MPP.
+ */
+#define DEFINE_UNPRIV_WINDOW_LOAD_FUNCTION(type, insn)                        \
+	static inline ulong unpriv_window_load_##type(ulong addr,             \
+					struct sbi_trap_info *trap)           \
+	{                                                                     \
+		register ulong tinfo asm("a3") = (ulong)trap;                 \
+		register ulong mstatus = 0;                                   \
+		type ret = 0;                                                 \
+		asm volatile(                                                 \
+			"csrrs %[mstatus], " STR(CSR_MSTATUS) ", %[mprv]\n"   \
+			".option push\n"                                      \
+			".option norvc\n"                                     \
+			#insn " %[ret], 0(%[addr])\n"                         \
+			".option pop\n"                                       \
+			"csrw " STR(CSR_MSTATUS) ", %[mstatus]"               \
+		    : [mstatus] "+&r"(mstatus), [tinfo] "+&r"(tinfo),         \
+		      [ret] "+&r"(ret)                                        \
+		    : [addr] "r"(addr), [mprv] "r"(MSTATUS_MPRV)              \
+		    : "a4", "memory");                                        \
+		return ret;                                                   \
+	}
+
+#define DEFINE_UNPRIV_WINDOW_STORE_FUNCTION(type, insn)                       \
+	static inline void unpriv_window_store_##type(ulong addr, ulong val,  \
+					struct sbi_trap_info *trap)           \
+	{                                                                     \
+		register ulong tinfo asm("a3") = (ulong)trap;                 \
+		register ulong mstatus = 0;                                   \
+		asm volatile(                                                 \
+			"csrrs %[mstatus], " STR(CSR_MSTATUS) ", %[mprv]\n"   \
+			".option push\n"                                      \
+			".option norvc\n"                                     \
+			#insn " %[val], 0(%[addr])\n"                         \
+			".option pop\n"                                       \
+			"csrw " STR(CSR_MSTATUS) ", %[mstatus]"               \
+		    : [mstatus] "+&r"(mstatus), [tinfo] "+&r"(tinfo)          \
+		    : [addr] "r"(addr), [mprv] "r"(MSTATUS_MPRV),             \
+		      [val] "r"(val)                                          \
+		    : "a4", "memory");                                        \
+	}
+
+DEFINE_UNPRIV_WINDOW_LOAD_FUNCTION(u8, lbu)
+DEFINE_UNPRIV_WINDOW_LOAD_FUNCTION(u16, lhu)
+DEFINE_UNPRIV_WINDOW_STORE_FUNCTION(u8, sb)
+DEFINE_UNPRIV_WINDOW_STORE_FUNCTION(u16, sh)
+DEFINE_UNPRIV_WINDOW_STORE_FUNCTION(u32, sw)
+#if __riscv_xlen == 64
+DEFINE_UNPRIV_WINDOW_LOAD_FUNCTION(u32, lwu)
+DEFINE_UNPRIV_WINDOW_LOAD_FUNCTION(u64, ld)
+DEFINE_UNPRIV_WINDOW_STORE_FUNCTION(u64, sd)
+#else
+DEFINE_UNPRIV_WINDOW_LOAD_FUNCTION(u32, lw)
+#endif
+
+/*
+ * Size of the largest naturally aligned access (up to XLEN bits) which
+ * can be used at addr without going beyond len bytes.
+ */
+static inline ulong unpriv_access_size(ulong addr, ulong len)
+{
+	ulong size = sizeof(ulong);
+
+	while (size > 1 && ((addr & (size - 1)) || len < size))
+		size >>= 1;
+
+	return size;
+}
+
+ulong sbi_copy_from_unpriv(void *dst, ulong src, ulong len,
+			   struct sbi_trap_info *trap)
+{
+	ulong mtvec, size, val, done = 0;
+
+	trap->cause = 0;
+	if (!len)
+		return 0;
+
+	mtvec = csr_swap(CSR_MTVEC, sbi_hart_expected_trap_addr());
+
+	while (done < len) {
+		size = unpriv_access_size(src + done, len - done);
+		switch (size) {
+		case 1:
+			val = unpriv_window_load_u8(src + done, trap);
+			break;
+		case 2:
+			val = unpriv_window_load_u16(src + done, trap);
+			break;
+#if __riscv_xlen == 64
+		case 4:
+			val = unpriv_window_load_u32(src + done, trap);
+			break;
+		default:
+			val = unpriv_window_load_u64(src + done, trap);
+			break;
+#else
+		default:
+			val = unpriv_window_load_u32(src + done, trap);
+			break;
+#endif
+		}
+		if (trap->cause)
+			break;
+
+		/* Little-endian so low order bytes of val come first */
+		sbi_memcpy((u8 *)dst + done, &val, size);
+		done += size;
+	}
+
+	csr_write(CSR_MTVEC, mtvec);
+
+	return done;
+}
+
+ulong sbi_copy_to_unpriv(ulong dst, const void *src, ulong len,
+			 struct sbi_trap_info *trap)
+{
+	ulong mtvec, size, val, done = 0;
+
+	trap->cause = 0;
+	if (!len)
+		return 0;
+
+	mtvec = csr_swap(CSR_MTVEC, sbi_hart_expected_trap_addr());
+
+	while (done < len) {
+		size = unpriv_access_size(dst + done, len - done);
+		val = 0;
+		sbi_memcpy(&val, (const u8 *)src + done, size);
+		switch (size) {
+		case 1:
+			unpriv_window_store_u8(dst + done, val, trap);
+			break;
+		case 2:
+			unpriv_window_store_u16(dst + done, val, trap);
+			break;
+#if __riscv_xlen == 64
+		case 4:
+			unpriv_window_store_u32(dst + done, val, trap);
+			break;
+		default:
+			unpriv_window_store_u64(dst + done, val, trap);
+			break;
+#else
+		default:
+			unpriv_window_store_u32(dst + done, val, trap);
+			break;
+#endif
+		}
+		if (trap->cause)
+			break;
+
+		done += size;
+	}
+
+	csr_write(CSR_MTVEC, mtvec);
+
+	return done;
+}
+
 ulong sbi_get_insn(ulong mepc, struct sbi_trap_info *trap)
 {
 	register ulong tinfo asm("a3");
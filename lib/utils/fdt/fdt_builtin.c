@@ -0,0 +1,112 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * fdt_builtin.c - Pre-resolved records of a built-in device tree
+ *
+ * The passed-in device tree is compared against the built-in one using
+ * its size and checksum. When they are identical, HART IDs and "reg"
+ * entries come from the records generated at build time instead of
+ * being parsed again on every cold boot.
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#include <libfdt.h>
+#include <sbi/sbi_error.h>
+#include <sbi_utils/fdt/fdt_builtin.h>
+
+enum fdt_builtin_state {
+	FDT_BUILTIN_UNCHECKED = 0,
+	FDT_BUILTIN_MATCHED,
+	FDT_BUILTIN_UNUSABLE,
+	FDT_BUILTIN_INVALIDATED,
+};
+
+/* Records generated at compile time */
+extern const struct fdt_builtin_records fdt_builtin_records;
+
+static enum fdt_builtin_state builtin_state = FDT_BUILTIN_UNCHECKED;
+static const void *builtin_fdt;
+
+static u32 fdt_builtin_checksum(const u8 *data, u32 size)
+{
+	u32 hash = 2166136261U;
+
+	while (size--) {
+		hash ^= *data++;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+bool fdt_builtin_usable(const void *fdt)
+{
+	const struct fdt_builtin_records *rec = &fdt_builtin_records;
+
+	if (builtin_state == FDT_BUILTIN_INVALIDATED)
+		return false;
+
+	/* A relocated copy of the device tree is compared again */
+	if (builtin_state == FDT_BUILTIN_UNCHECKED || builtin_fdt != fdt) {
+		builtin_state = FDT_BUILTIN_UNUSABLE;
+		builtin_fdt = fdt;
+		if (fdt && !fdt_check_header(fdt) &&
+		    fdt_totalsize(fdt) == rec->totalsize &&
+		    fdt_builtin_checksum(fdt, rec->totalsize) == rec->checksum)
+			builtin_state = FDT_BUILTIN_MATCHED;
+	}
+
+	return (builtin_state == FDT_BUILTIN_MATCHED) ? true : false;
+}
+
+void fdt_builtin_invalidate(void)
+{
+	builtin_state = FDT_BUILTIN_INVALIDATED;
+}
+
+int fdt_builtin_hart_ids(const void *fdt, const u32 **out_ids,
+			 u32 *out_count)
+{
+	const struct fdt_builtin_records *rec = &fdt_builtin_records;
+
+	if (!fdt_builtin_usable(fdt) || rec->hart_count < 0)
+		return SBI_ENOENT;
+
+	*out_ids = rec->hart_ids;
+	*out_count = rec->hart_count;
+	return 0;
+}
+
+int fdt_builtin_node_addr_size(const void *fdt, int node, int index,
+			       uint64_t *addr, uint64_t *size)
+{
+	const struct fdt_builtin_records *rec = &fdt_builtin_records;
+	const struct fdt_builtin_reg *reg;
+	u32 lo = 0, hi = rec->reg_count, mid;
+
+	if (!fdt_builtin_usable(fdt))
+		return SBI_ENOENT;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		reg = &rec->regs[mid];
+		if (reg->node < node ||
+		    (reg->node == node && reg->index < index)) {
+			lo = mid + 1;
+		} else if (reg->node == node && reg->index == index) {
+			if (addr)
+				*addr = reg->addr;
+			if (size)
+				*size = reg->size;
+			return 0;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return SBI_ENOENT;
+}
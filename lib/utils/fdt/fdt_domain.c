@@ -10,12 +10,15 @@
 
 #include <libfdt.h>
 #include <libfdt_env.h>
+#include <sbi/sbi_console.h>
 #include <sbi/sbi_domain.h>
 #include <sbi/sbi_error.h>
 #include <sbi/sbi_hartmask.h>
 #include <sbi/sbi_scratch.h>
 #include <sbi_utils/fdt/fdt_domain.h>
 #include <sbi_utils/fdt/fdt_helper.h>
+#include <sbi_utils/fdt/fdt_index.h>
+#include <sbi_utils/fdt/fdt_rewrite.h>
 
 int fdt_iterate_each_domain(void *fdt, void *opaque,
 			    int (*fn)(void *fdt, int domain_offset,
@@ -26,10 +29,10 @@ int fdt_iterate_each_domain(void *fdt, void *opaque,
 	if (!fdt || !fn)
 		return SBI_EINVAL;
 
-	poffset = fdt_path_offset(fdt, "/chosen");
+	poffset = fdt_index_path_offset(fdt, "/chosen");
 	if (poffset < 0)
 		return 0;
-	poffset = fdt_node_offset_by_compatible(fdt, poffset,
+	poffset = fdt_index_offset_by_compatible(fdt, poffset,
 						"opensbi,domain,config");
 	if (poffset < 0)
 		return 0;
@@ -69,7 +72,7 @@ int fdt_iterate_each_memregion(void *fdt, int domain_offset, void *opaque,
 
 	rcount = (u32)len / (sizeof(u32) * 2);
 	for (i = 0; i < rcount; i++) {
-		region_offset = fdt_node_offset_by_phandle(fdt,
+		region_offset = fdt_index_offset_by_phandle(fdt,
 						fdt32_to_cpu(regions[2 * i]));
 		if (region_offset < 0)
 			return region_offset;
@@ -106,22 +109,6 @@ static int __fixup_find_domain_offset(void *fdt, int doff, void *p)
 				 SBI_DOMAIN_MEMREGION_WRITEABLE | \
 				 SBI_DOMAIN_MEMREGION_EXECUTABLE)
 
-static int __fixup_count_disable_devices(void *fdt, int doff, int roff,
-					 u32 perm, void *p)
-{
-	int len;
-	u32 *dcount = p;
-
-	if (perm & DISABLE_DEVICES_MASK)
-		return 0;
-
-	len = 0;
-	if (fdt_getprop(fdt, roff, "devices", &len))
-		*dcount += len / sizeof(u32);
-
-	return 0;
-}
-
 static int __fixup_disable_devices(void *fdt, int doff, int roff,
 				   u32 raccess, void *p)
 {
@@ -138,12 +125,12 @@ static int __fixup_disable_devices(void *fdt, int doff, int roff,
 	len = len / sizeof(u32);
 
 	for (i = 0; i < len; i++) {
-		coff = fdt_node_offset_by_phandle(fdt,
+		coff = fdt_index_offset_by_phandle(fdt,
 					fdt32_to_cpu(devices[i]));
 		if (coff < 0)
 			return coff;
 
-		fdt_setprop_string(fdt, coff, "status", "disabled");
+		fdt_rewrite_setprop_string(fdt, coff, "status", "disabled");
 	}
 
 	return 0;
@@ -151,15 +138,16 @@ static int __fixup_disable_devices(void *fdt, int doff, int roff,
 
 void fdt_domain_fixup(void *fdt)
 {
-	u32 i, dcount;
+	u32 i;
 	int err, poffset, doffset;
 	struct sbi_domain *dom = sbi_domain_thishart_ptr();
 	struct __fixup_find_domain_offset_info fdo;
 
 	/* Remove the domain assignment DT property from CPU DT nodes */
-	poffset = fdt_path_offset(fdt, "/cpus");
+	poffset = fdt_index_path_offset(fdt, "/cpus");
 	if (poffset < 0)
 		return;
+	fdt_rewrite_begin(fdt);
 	fdt_for_each_subnode(doffset, fdt, poffset) {
 		err = fdt_parse_hart_id(fdt, doffset, &i);
 		if (err)
@@ -168,7 +156,8 @@ void fdt_domain_fixup(void *fdt)
 		if (!fdt_node_is_enabled(fdt, doffset))
 			continue;
 
-		fdt_nop_property(fdt, doffset, "opensbi-domain");
+		if (fdt_getprop(fdt, doffset, "opensbi-domain", NULL))
+			fdt_rewrite_delprop(fdt, doffset, "opensbi-domain");
 	}
 
 	/* Skip device disable for root domain */
@@ -183,50 +172,60 @@ void fdt_domain_fixup(void *fdt)
 	if (doffset < 0)
 		goto skip_device_disable;
 
-	/* Count current domain device DT nodes to be disabled */
-	dcount = 0;
-	fdt_iterate_each_memregion(fdt, doffset, &dcount,
-				   __fixup_count_disable_devices);
-	if (!dcount)
-		goto skip_device_disable;
-
-	/* Expand FDT based on device DT nodes to be disabled */
-	err = fdt_open_into(fdt, fdt, fdt_totalsize(fdt) + dcount * 32);
-	if (err < 0)
-		return;
-
-	/* Again find current domain DT node */
-	doffset = -1;
-	fdo.name = dom->name;
-	fdo.doffset = &doffset;
-	fdt_iterate_each_domain(fdt, &fdo, __fixup_find_domain_offset);
-	if (doffset < 0)
-		goto skip_device_disable;
-
 	/* Disable device DT nodes for current domain */
 	fdt_iterate_each_memregion(fdt, doffset, NULL,
 				   __fixup_disable_devices);
 skip_device_disable:
 
 	/* Remove the OpenSBI domain config DT node */
-	poffset = fdt_path_offset(fdt, "/chosen");
-	if (poffset < 0)
-		return;
-	poffset = fdt_node_offset_by_compatible(fdt, poffset,
+	poffset = fdt_index_path_offset(fdt, "/chosen");
+	if (poffset >= 0)
+		poffset = fdt_index_offset_by_compatible(fdt, poffset,
 						"opensbi,domain,config");
-	if (poffset < 0)
-		return;
-	fdt_nop_node(fdt, poffset);
+	if (poffset >= 0)
+		fdt_rewrite_del_node(fdt, poffset);
+
+	fdt_rewrite_end(fdt);
 }
 
-#define FDT_DOMAIN_MAX_COUNT		8
-#define FDT_DOMAIN_REGION_MAX_COUNT	16
+#if CONFIG_FDT_DOMAIN_POOL_SIZE
+#define FDT_DOMAIN_POOL_SIZE	CONFIG_FDT_DOMAIN_POOL_SIZE
+#else
+#define FDT_DOMAIN_POOL_SIZE						\
+	(8 * (sizeof(struct sbi_domain) + sizeof(struct sbi_hartmask) +	\
+	      17 * sizeof(struct sbi_domain_memregion)))
+#endif
+
+/*
+ * Domains, HART masks and memory regions parsed from the device tree
+ * are carved out of a single pool so each domain takes only as much
+ * storage as its device tree node describes.
+ */
+static unsigned long
+	fdt_domain_pool[FDT_DOMAIN_POOL_SIZE / sizeof(unsigned long)];
+static unsigned long fdt_domain_pool_used;
+
+static void *fdt_domain_alloc(unsigned long size)
+{
+	void *ptr;
+
+	size = (size + sizeof(unsigned long) - 1) &
+	       ~(sizeof(unsigned long) - 1);
+	if (sizeof(fdt_domain_pool) - fdt_domain_pool_used < size)
+		return NULL;
 
-static u32 fdt_domains_count;
-static struct sbi_domain fdt_domains[FDT_DOMAIN_MAX_COUNT];
-static struct sbi_hartmask fdt_masks[FDT_DOMAIN_MAX_COUNT];
-static struct sbi_domain_memregion
-	fdt_regions[FDT_DOMAIN_MAX_COUNT][FDT_DOMAIN_REGION_MAX_COUNT + 1];
+	ptr = (u8 *)fdt_domain_pool + fdt_domain_pool_used;
+	fdt_domain_pool_used += size;
+	memset(ptr, 0, size);
+
+	return ptr;
+}
+
+struct __fdt_parse_region_info {
+	struct sbi_domain_memregion *regions;
+	u32 count;
+	u32 max;
+};
 
 static int __fdt_parse_region(void *fdt, int domain_offset,
 			      int region_offset, u32 region_access,
@@ -236,7 +235,7 @@ static int __fdt_parse_region(void *fdt, int domain_offset,
 	u32 val32;
 	u64 val64;
 	const u32 *val;
-	u32 *region_count = opaque;
+	struct __fdt_parse_region_info *info = opaque;
 	struct sbi_domain_memregion *region;
 
 	/*
@@ -252,9 +251,9 @@ static int __fdt_parse_region(void *fdt, int domain_offset,
 		return SBI_EINVAL;
 
 	/* Find next region of the domain */
-	if (FDT_DOMAIN_REGION_MAX_COUNT <= *region_count)
+	if (info->max <= info->count)
 		return SBI_EINVAL;
-	region = &fdt_regions[fdt_domains_count][*region_count];
+	region = &info->regions[info->count];
 
 	/* Read "base" DT property */
 	val = fdt_getprop(fdt, region_offset, "base", &len);
@@ -278,7 +277,7 @@ static int __fdt_parse_region(void *fdt, int domain_offset,
 	if (fdt_get_property(fdt, region_offset, "mmio", NULL))
 		region->flags |= SBI_DOMAIN_MEMREGION_MMIO;
 
-	(*region_count)++;
+	info->count++;
 
 	return 0;
 }
@@ -293,14 +292,29 @@ static int __fdt_parse_domain(void *fdt, int domain_offset, void *opaque)
 	struct sbi_hartmask assign_mask;
 	int *cold_domain_offset = opaque;
 	struct sbi_domain_memregion *reg, *regions;
+	struct __fdt_parse_region_info info;
 	int i, err, len, cpus_offset, cpu_offset, doffset;
 
-	/* Sanity check on maximum domains we can handle */
-	if (FDT_DOMAIN_MAX_COUNT <= fdt_domains_count)
-		return SBI_EINVAL;
-	dom = &fdt_domains[fdt_domains_count];
-	mask = &fdt_masks[fdt_domains_count];
-	regions = &fdt_regions[fdt_domains_count][0];
+	/*
+	 * Size the domain from the DT regions plus the root domain
+	 * memregions copied over below.
+	 */
+	info.max = 0;
+	if (fdt_getprop(fdt, domain_offset, "regions", &len))
+		info.max = (u32)len / (sizeof(u32) * 2);
+	sbi_domain_for_each_memregion(&root, reg) {
+		if (!(reg->flags & SBI_DOMAIN_MEMREGION_SU_ACCESS_MASK))
+			info.max++;
+	}
+
+	dom = fdt_domain_alloc(sizeof(*dom));
+	mask = fdt_domain_alloc(sizeof(*mask));
+	regions = fdt_domain_alloc(sizeof(*regions) * (info.max + 1));
+	if (!dom || !mask || !regions) {
+		sbi_printf("%s: out of domain storage for %s\n", __func__,
+			   fdt_get_name(fdt, domain_offset, NULL));
+		return SBI_ENOMEM;
+	}
 
 	/* Read DT node name */
 	strncpy(dom->name, fdt_get_name(fdt, domain_offset, NULL),
@@ -314,7 +328,7 @@ static int __fdt_parse_domain(void *fdt, int domain_offset, void *opaque)
 	len = len / sizeof(u32);
 	if (val && len) {
 		for (i = 0; i < len; i++) {
-			cpu_offset = fdt_node_offset_by_phandle(fdt,
+			cpu_offset = fdt_index_offset_by_phandle(fdt,
 							fdt32_to_cpu(val[i]));
 			if (cpu_offset < 0)
 				return cpu_offset;
@@ -331,14 +345,14 @@ static int __fdt_parse_domain(void *fdt, int domain_offset, void *opaque)
 	}
 
 	/* Setup memregions from DT */
-	val32 = 0;
-	memset(regions, 0,
-		   sizeof(*regions) * (FDT_DOMAIN_REGION_MAX_COUNT + 1));
+	info.regions = regions;
+	info.count = 0;
 	dom->regions = regions;
-	err = fdt_iterate_each_memregion(fdt, domain_offset, &val32,
+	err = fdt_iterate_each_memregion(fdt, domain_offset, &info,
 					 __fdt_parse_region);
 	if (err)
 		return err;
+	val32 = info.count;
 
 	/*
 	 * Copy over root domain memregions which don't allow
@@ -354,7 +368,7 @@ static int __fdt_parse_domain(void *fdt, int domain_offset, void *opaque)
 		    (reg->flags & SBI_DOMAIN_MEMREGION_SU_WRITABLE) ||
 		    (reg->flags & SBI_DOMAIN_MEMREGION_SU_EXECUTABLE))
 			continue;
-		if (FDT_DOMAIN_REGION_MAX_COUNT <= val32)
+		if (info.max <= val32)
 			return SBI_EINVAL;
 		memcpy(&regions[val32++], reg, sizeof(*reg));
 	}
@@ -364,7 +378,7 @@ static int __fdt_parse_domain(void *fdt, int domain_offset, void *opaque)
 	val32 = -1U;
 	val = fdt_getprop(fdt, domain_offset, "boot-hart", &len);
 	if (val && len >= 4) {
-		cpu_offset = fdt_node_offset_by_phandle(fdt,
+		cpu_offset = fdt_index_offset_by_phandle(fdt,
 							 fdt32_to_cpu(*val));
 		if (cpu_offset >= 0 && fdt_node_is_enabled(fdt, cpu_offset))
 			fdt_parse_hart_id(fdt, cpu_offset, &val32);
@@ -425,8 +439,22 @@ static int __fdt_parse_domain(void *fdt, int domain_offset, void *opaque)
 	else
 		dom->system_suspend_allowed = false;
 
+	/* Read "trap-delegation-allowed" DT property */
+	if (fdt_get_property(fdt, domain_offset,
+			     "trap-delegation-allowed", NULL))
+		dom->trap_delegation_allowed = true;
+	else
+		dom->trap_delegation_allowed = false;
+
+	/* Read "domain-switch-allowed" DT property */
+	if (fdt_get_property(fdt, domain_offset,
+			     "domain-switch-allowed", NULL))
+		dom->domain_switch_allowed = true;
+	else
+		dom->domain_switch_allowed = false;
+
 	/* Find /cpus DT node */
-	cpus_offset = fdt_path_offset(fdt, "/cpus");
+	cpus_offset = fdt_index_path_offset(fdt, "/cpus");
 	if (cpus_offset < 0)
 		return cpus_offset;
 
@@ -447,7 +475,7 @@ static int __fdt_parse_domain(void *fdt, int domain_offset, void *opaque)
 		if (!val || len < 4)
 			return SBI_EINVAL;
 
-		doffset = fdt_node_offset_by_phandle(fdt, fdt32_to_cpu(*val));
+		doffset = fdt_index_offset_by_phandle(fdt, fdt32_to_cpu(*val));
 		if (doffset < 0)
 			return doffset;
 
@@ -455,9 +483,6 @@ static int __fdt_parse_domain(void *fdt, int domain_offset, void *opaque)
 			sbi_hartmask_set_hart(val32, &assign_mask);
 	}
 
-	/* Increment domains count */
-	fdt_domains_count++;
-
 	/* Register the domain */
 	return sbi_domain_register(dom, &assign_mask);
 }
@@ -474,7 +499,7 @@ int fdt_domains_populate(void *fdt)
 		return SBI_EINVAL;
 
 	/* Find /cpus DT node */
-	cpus_offset = fdt_path_offset(fdt, "/cpus");
+	cpus_offset = fdt_index_path_offset(fdt, "/cpus");
 	if (cpus_offset < 0)
 		return cpus_offset;
 
@@ -494,7 +519,7 @@ int fdt_domains_populate(void *fdt)
 
 		val = fdt_getprop(fdt, cpu_offset, "opensbi-domain", &len);
 		if (val && len >= 4)
-			cold_domain_offset = fdt_node_offset_by_phandle(fdt,
+			cold_domain_offset = fdt_index_offset_by_phandle(fdt,
 							   fdt32_to_cpu(*val));
 
 		break;
@@ -19,12 +19,15 @@
 #include <sbi_utils/fdt/fdt_fixup.h>
 #include <sbi_utils/fdt/fdt_pmu.h>
 #include <sbi_utils/fdt/fdt_helper.h>
+#include <sbi_utils/fdt/fdt_index.h>
+#include <sbi_utils/fdt/fdt_rewrite.h>
 
 int fdt_add_cpu_idle_states(void *fdt, const struct sbi_cpu_idle_state *state)
 {
 	int cpu_node, cpus_node, err, idle_states_node;
 	uint32_t count, phandle;
 
+	fdt_index_invalidate();
 	err = fdt_open_into(fdt, fdt, fdt_totalsize(fdt) + 1024);
 	if (err < 0)
 		return err;
@@ -112,14 +115,11 @@ void fdt_cpu_fixup(void *fdt)
 	const char *mmu_type;
 	u32 hartid;
 
-	err = fdt_open_into(fdt, fdt, fdt_totalsize(fdt) + 32);
-	if (err < 0)
-		return;
-
-	cpus_offset = fdt_path_offset(fdt, "/cpus");
+	cpus_offset = fdt_index_path_offset(fdt, "/cpus");
 	if (cpus_offset < 0)
 		return;
 
+	fdt_rewrite_begin(fdt);
 	fdt_for_each_subnode(cpu_offset, fdt, cpus_offset) {
 		err = fdt_parse_hart_id(fdt, cpu_offset, &hartid);
 		if (err)
@@ -137,9 +137,10 @@ void fdt_cpu_fixup(void *fdt)
 		mmu_type = fdt_getprop(fdt, cpu_offset, "mmu-type", &len);
 		if (!sbi_domain_is_assigned_hart(dom, hartid) ||
 		    !mmu_type || !len)
-			fdt_setprop_string(fdt, cpu_offset, "status",
-					   "disabled");
+			fdt_rewrite_setprop_string(fdt, cpu_offset, "status",
+						   "disabled");
 	}
+	fdt_rewrite_end(fdt);
 }
 
 static void fdt_domain_based_fixup_one(void *fdt, int nodeoff)
@@ -153,21 +154,19 @@ static void fdt_domain_based_fixup_one(void *fdt, int nodeoff)
 		return;
 
 	if (!sbi_domain_check_addr(dom, reg_addr, dom->next_mode,
-				    SBI_DOMAIN_READ | SBI_DOMAIN_WRITE)) {
-		rc = fdt_open_into(fdt, fdt, fdt_totalsize(fdt) + 32);
-		if (rc < 0)
-			return;
-		fdt_setprop_string(fdt, nodeoff, "status", "disabled");
-	}
+				    SBI_DOMAIN_READ | SBI_DOMAIN_WRITE))
+		fdt_rewrite_setprop_string(fdt, nodeoff, "status", "disabled");
 }
 
 static void fdt_fixup_node(void *fdt, const char *compatible)
 {
 	int noff = 0;
 
-	while ((noff = fdt_node_offset_by_compatible(fdt, noff,
-						     compatible)) >= 0)
+	fdt_rewrite_begin(fdt);
+	while ((noff = fdt_index_offset_by_compatible(fdt, noff,
+						      compatible)) >= 0)
 		fdt_domain_based_fixup_one(fdt, noff);
+	fdt_rewrite_end(fdt);
 }
 
 void fdt_aplic_fixup(void *fdt)
@@ -235,7 +234,7 @@ static int fdt_resv_memory_update_node(void *fdt, unsigned long addr,
 			     "mmode_resv%d@%x", index,
 			     addr_low);
 
-	subnode = fdt_add_subnode(fdt, parent, name);
+	subnode = fdt_rewrite_add_subnode(fdt, parent, name);
 	if (subnode < 0)
 		return subnode;
 
@@ -245,7 +244,7 @@ static int fdt_resv_memory_update_node(void *fdt, unsigned long addr,
 		 * mapping of the region as part of its standard
 		 * mapping of system memory.
 		 */
-		err = fdt_setprop_empty(fdt, subnode, "no-map");
+		err = fdt_rewrite_setprop_empty(fdt, subnode, "no-map");
 		if (err < 0)
 			return err;
 	}
@@ -259,8 +258,8 @@ static int fdt_resv_memory_update_node(void *fdt, unsigned long addr,
 		*val++ = cpu_to_fdt32(size_high);
 	*val++ = cpu_to_fdt32(size_low);
 
-	err = fdt_setprop(fdt, subnode, "reg", reg,
-			  (na + ns) * sizeof(fdt32_t));
+	err = fdt_rewrite_setprop(fdt, subnode, "reg", reg,
+				  (na + ns) * sizeof(fdt32_t));
 	if (err < 0)
 		return err;
 
@@ -282,7 +281,7 @@ static int fdt_resv_memory_update_node(void *fdt, unsigned long addr,
  * Some additional memory spaces may be protected by platform codes via PMP as
  * well, and corresponding child nodes will be inserted.
  */
-int fdt_reserved_memory_fixup(void *fdt)
+static int __fdt_reserved_memory_fixup(void *fdt)
 {
 	struct sbi_domain_memregion *reg;
 	struct sbi_domain *dom = sbi_domain_thishart_ptr();
@@ -294,22 +293,11 @@ int fdt_reserved_memory_fixup(void *fdt)
 	int na = fdt_address_cells(fdt, 0);
 	int ns = fdt_size_cells(fdt, 0);
 
-	/*
-	 * Expand the device tree to accommodate new node
-	 * by the following estimated size:
-	 *
-	 * Each PMP memory region entry occupies 64 bytes.
-	 * With 16 PMP memory regions we need 64 * 16 = 1024 bytes.
-	 */
-	err = fdt_open_into(fdt, fdt, fdt_totalsize(fdt) + 1024);
-	if (err < 0)
-		return err;
-
 	/* try to locate the reserved memory node */
-	parent = fdt_path_offset(fdt, "/reserved-memory");
+	parent = fdt_index_path_offset(fdt, "/reserved-memory");
 	if (parent < 0) {
 		/* if such node does not exist, create one */
-		parent = fdt_add_subnode(fdt, 0, "reserved-memory");
+		parent = fdt_rewrite_add_subnode(fdt, 0, "reserved-memory");
 		if (parent < 0)
 			return parent;
 
@@ -320,15 +308,16 @@ int fdt_reserved_memory_fixup(void *fdt)
 		 * - ranges: should be empty
 		 */
 
-		err = fdt_setprop_empty(fdt, parent, "ranges");
+		err = fdt_rewrite_setprop_empty(fdt, parent, "ranges");
 		if (err < 0)
 			return err;
 
-		err = fdt_setprop_u32(fdt, parent, "#size-cells", ns);
+		err = fdt_rewrite_setprop_u32(fdt, parent, "#size-cells", ns);
 		if (err < 0)
 			return err;
 
-		err = fdt_setprop_u32(fdt, parent, "#address-cells", na);
+		err = fdt_rewrite_setprop_u32(fdt, parent,
+					      "#address-cells", na);
 		if (err < 0)
 			return err;
 	}
@@ -390,32 +379,48 @@ int fdt_reserved_memory_fixup(void *fdt)
 	return 0;
 }
 
+int fdt_reserved_memory_fixup(void *fdt)
+{
+	int rc, end_rc;
+
+	fdt_rewrite_begin(fdt);
+	rc = __fdt_reserved_memory_fixup(fdt);
+	end_rc = fdt_rewrite_end(fdt);
+
+	return rc ? rc : end_rc;
+}
+
 int fdt_reserved_memory_nomap_fixup(void *fdt)
 {
 	int parent, subnode;
-	int err;
+	int err = 0, end_err;
 
 	/* Locate the reserved memory node */
-	parent = fdt_path_offset(fdt, "/reserved-memory");
+	parent = fdt_index_path_offset(fdt, "/reserved-memory");
 	if (parent < 0)
 		return parent;
 
+	fdt_rewrite_begin(fdt);
 	fdt_for_each_subnode(subnode, fdt, parent) {
 		/*
 		 * Tell operating system not to create a virtual
 		 * mapping of the region as part of its standard
 		 * mapping of system memory.
 		 */
-		err = fdt_setprop_empty(fdt, subnode, "no-map");
+		err = fdt_rewrite_setprop_empty(fdt, subnode, "no-map");
 		if (err < 0)
-			return err;
+			break;
 	}
 
-	return 0;
+	end_err = fdt_rewrite_end(fdt);
+
+	return err ? err : end_err;
 }
 
 void fdt_fixups(void *fdt)
 {
+	fdt_rewrite_begin(fdt);
+
 	fdt_aplic_fixup(fdt);
 
 	fdt_imsic_fixup(fdt);
@@ -424,4 +429,6 @@ void fdt_fixups(void *fdt)
 
 	fdt_reserved_memory_fixup(fdt);
 	fdt_pmu_fixup(fdt);
+
+	fdt_rewrite_end(fdt);
 }
@@ -12,7 +12,9 @@
 #include <sbi/sbi_hartmask.h>
 #include <sbi/sbi_platform.h>
 #include <sbi/sbi_scratch.h>
+#include <sbi_utils/fdt/fdt_builtin.h>
 #include <sbi_utils/fdt/fdt_helper.h>
+#include <sbi_utils/fdt/fdt_index.h>
 #include <sbi_utils/irqchip/aplic.h>
 #include <sbi_utils/irqchip/imsic.h>
 #include <sbi_utils/irqchip/plic.h>
@@ -35,11 +37,16 @@
 const struct fdt_match *fdt_match_node(void *fdt, int nodeoff,
 				       const struct fdt_match *match_table)
 {
+	const struct fdt_match *match;
 	int ret;
 
 	if (!fdt || nodeoff < 0 || !match_table)
 		return NULL;
 
+	ret = fdt_index_match_node(fdt, nodeoff, match_table, &match);
+	if (ret != SBI_ENOSYS)
+		return ret ? NULL : match;
+
 	while (match_table->compatible) {
 		ret = fdt_node_check_compatible(fdt, nodeoff,
 						match_table->compatible);
@@ -60,8 +67,12 @@ int fdt_find_match(void *fdt, int startoff,
 	if (!fdt || !match_table)
 		return SBI_ENODEV;
 
+	nodeoff = fdt_index_find_match(fdt, startoff, match_table, out_match);
+	if (nodeoff != SBI_ENOSYS)
+		return nodeoff;
+
 	while (match_table->compatible) {
-		nodeoff = fdt_node_offset_by_compatible(fdt, startoff,
+		nodeoff = fdt_index_offset_by_compatible(fdt, startoff,
 						match_table->compatible);
 		if (nodeoff >= 0) {
 			if (out_match)
@@ -91,7 +102,7 @@ int fdt_parse_phandle_with_args(void *fdt, int nodeoff,
 	list_end = list + (len / sizeof(*list));
 
 	while (list < list_end) {
-		pnodeoff = fdt_node_offset_by_phandle(fdt,
+		pnodeoff = fdt_index_offset_by_phandle(fdt,
 						fdt32_to_cpu(*list));
 		if (pnodeoff < 0)
 			return pnodeoff;
@@ -170,6 +181,10 @@ int fdt_get_node_addr_size(void *fdt, int node, int index,
 	if (!fdt || node < 0 || index < 0)
 		return SBI_EINVAL;
 
+	rc = fdt_builtin_node_addr_size(fdt, node, index, addr, size);
+	if (rc != SBI_ENOENT)
+		return rc;
+
 	parent = fdt_parent_offset(fdt, node);
 	if (parent < 0)
 		return parent;
@@ -273,7 +288,7 @@ int fdt_parse_max_enabled_hart_id(void *fdt, u32 *max_hartid)
 
 	*max_hartid = 0;
 
-	cpus_offset = fdt_path_offset(fdt, "/cpus");
+	cpus_offset = fdt_index_path_offset(fdt, "/cpus");
 	if (cpus_offset < 0)
 		return cpus_offset;
 
@@ -300,7 +315,7 @@ int fdt_parse_timebase_frequency(void *fdt, unsigned long *freq)
 	if (!fdt || !freq)
 		return SBI_EINVAL;
 
-	cpus_offset = fdt_path_offset(fdt, "/cpus");
+	cpus_offset = fdt_index_path_offset(fdt, "/cpus");
 	if (cpus_offset < 0)
 		return cpus_offset;
 
@@ -423,7 +438,7 @@ int fdt_parse_uart8250(void *fdt, struct platform_uart_data *uart,
 	if (!compatible || !uart || !fdt)
 		return SBI_ENODEV;
 
-	nodeoffset = fdt_node_offset_by_compatible(fdt, -1, compatible);
+	nodeoffset = fdt_index_offset_by_compatible(fdt, -1, compatible);
 	if (nodeoffset < 0)
 		return nodeoffset;
 
@@ -475,7 +490,7 @@ int fdt_parse_aplic_node(void *fdt, int nodeoff, struct aplic_data *aplic)
 
 	val = fdt_getprop(fdt, nodeoff, "msi-parent", &len);
 	if (val && len >= sizeof(fdt32_t)) {
-		noff = fdt_node_offset_by_phandle(fdt, fdt32_to_cpu(*val));
+		noff = fdt_index_offset_by_phandle(fdt, fdt32_to_cpu(*val));
 		if (noff < 0)
 			return noff;
 
@@ -508,7 +523,7 @@ int fdt_parse_aplic_node(void *fdt, int nodeoff, struct aplic_data *aplic)
 		if (!val || len < sizeof(fdt32_t))
 			goto aplic_msi_parent_done;
 
-		noff = fdt_node_offset_by_phandle(fdt, fdt32_to_cpu(*val));
+		noff = fdt_index_offset_by_phandle(fdt, fdt32_to_cpu(*val));
 		if (noff < 0)
 			return noff;
 
@@ -516,7 +531,7 @@ int fdt_parse_aplic_node(void *fdt, int nodeoff, struct aplic_data *aplic)
 		if (!val || len < sizeof(fdt32_t))
 			goto aplic_msi_parent_done;
 
-		noff = fdt_node_offset_by_phandle(fdt, fdt32_to_cpu(*val));
+		noff = fdt_index_offset_by_phandle(fdt, fdt32_to_cpu(*val));
 		if (noff < 0)
 			return noff;
 
@@ -602,7 +617,7 @@ bool fdt_check_imsic_mlevel(void *fdt)
 	if (!fdt)
 		return false;
 
-	while ((noff = fdt_node_offset_by_compatible(fdt, noff,
+	while ((noff = fdt_index_offset_by_compatible(fdt, noff,
 						     "riscv,imsics")) >= 0) {
 		val = fdt_getprop(fdt, noff, "interrupts-extended", &len);
 		if (val && len > sizeof(fdt32_t)) {
@@ -710,6 +725,7 @@ int fdt_parse_plic_node(void *fdt, int nodeoffset, struct plic_data *plic)
 	if (rc < 0 || !reg_addr || !reg_size)
 		return SBI_ENODEV;
 	plic->addr = reg_addr;
+	plic->flags = 0;
 
 	val = fdt_getprop(fdt, nodeoffset, "riscv,ndev", &len);
 	if (len > 0)
@@ -725,14 +741,14 @@ int fdt_parse_plic(void *fdt, struct plic_data *plic, const char *compat)
 	if (!compat || !plic || !fdt)
 		return SBI_ENODEV;
 
-	nodeoffset = fdt_node_offset_by_compatible(fdt, -1, compat);
+	nodeoffset = fdt_index_offset_by_compatible(fdt, -1, compat);
 	if (nodeoffset < 0)
 		return nodeoffset;
 
 	return fdt_parse_plic_node(fdt, nodeoffset, plic);
 }
 
-int fdt_parse_aclint_node(void *fdt, int nodeoffset, bool for_timer,
+static int __fdt_parse_aclint_node(void *fdt, int nodeoffset, u32 match_hwirq,
 			  unsigned long *out_addr1, unsigned long *out_size1,
 			  unsigned long *out_addr2, unsigned long *out_size2,
 			  u32 *out_first_hartid, u32 *out_hart_count)
@@ -741,7 +757,6 @@ int fdt_parse_aclint_node(void *fdt, int nodeoffset, bool for_timer,
 	uint64_t reg_addr, reg_size;
 	int i, rc, count, cpu_offset, cpu_intc_offset;
 	u32 phandle, hwirq, hartid, first_hartid, last_hartid, hart_count;
-	u32 match_hwirq = (for_timer) ? IRQ_M_TIMER : IRQ_M_SOFT;
 
 	if (nodeoffset < 0 || !fdt ||
 	    !out_addr1 || !out_size1 ||
@@ -778,7 +793,7 @@ int fdt_parse_aclint_node(void *fdt, int nodeoffset, bool for_timer,
 		phandle = fdt32_to_cpu(val[2 * i]);
 		hwirq = fdt32_to_cpu(val[(2 * i) + 1]);
 
-		cpu_intc_offset = fdt_node_offset_by_phandle(fdt, phandle);
+		cpu_intc_offset = fdt_index_offset_by_phandle(fdt, phandle);
 		if (cpu_intc_offset < 0)
 			continue;
 
@@ -811,6 +826,26 @@ int fdt_parse_aclint_node(void *fdt, int nodeoffset, bool for_timer,
 	return 0;
 }
 
+int fdt_parse_aclint_node(void *fdt, int nodeoffset, bool for_timer,
+			  unsigned long *out_addr1, unsigned long *out_size1,
+			  unsigned long *out_addr2, unsigned long *out_size2,
+			  u32 *out_first_hartid, u32 *out_hart_count)
+{
+	return __fdt_parse_aclint_node(fdt, nodeoffset,
+				(for_timer) ? IRQ_M_TIMER : IRQ_M_SOFT,
+				out_addr1, out_size1, out_addr2, out_size2,
+				out_first_hartid, out_hart_count);
+}
+
+int fdt_parse_aclint_sswi_node(void *fdt, int nodeoffset,
+			       unsigned long *out_addr, unsigned long *out_size,
+			       u32 *out_first_hartid, u32 *out_hart_count)
+{
+	return __fdt_parse_aclint_node(fdt, nodeoffset, IRQ_S_SOFT,
+				out_addr, out_size, NULL, NULL,
+				out_first_hartid, out_hart_count);
+}
+
 int fdt_parse_plmt_node(void *fdt, int nodeoffset, unsigned long *plmt_base,
 			  unsigned long *plmt_size, u32 *hart_count)
 {
@@ -842,7 +877,7 @@ int fdt_parse_plmt_node(void *fdt, int nodeoffset, unsigned long *plmt_base,
 		phandle = fdt32_to_cpu(val[2 * i]);
 		hwirq = fdt32_to_cpu(val[2 * i + 1]);
 
-		cpu_intc_offset = fdt_node_offset_by_phandle(fdt, phandle);
+		cpu_intc_offset = fdt_index_offset_by_phandle(fdt, phandle);
 		if (cpu_intc_offset < 0)
 			continue;
 
@@ -898,7 +933,7 @@ int fdt_parse_plicsw_node(void *fdt, int nodeoffset, unsigned long *plicsw_base,
 		phandle = fdt32_to_cpu(val[2 * i]);
 		hwirq = fdt32_to_cpu(val[2 * i + 1]);
 
-		cpu_intc_offset = fdt_node_offset_by_phandle(fdt, phandle);
+		cpu_intc_offset = fdt_index_offset_by_phandle(fdt, phandle);
 		if (cpu_intc_offset < 0)
 			continue;
 
@@ -928,7 +963,7 @@ int fdt_parse_compat_addr(void *fdt, uint64_t *addr,
 {
 	int nodeoffset, rc;
 
-	nodeoffset = fdt_node_offset_by_compatible(fdt, -1, compatible);
+	nodeoffset = fdt_index_offset_by_compatible(fdt, -1, compatible);
 	if (nodeoffset < 0)
 		return nodeoffset;
 
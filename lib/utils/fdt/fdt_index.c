@@ -0,0 +1,483 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * fdt_index.c - Flat Device Tree lookup index
+ *
+ * The device tree is walked once and every (compatible string, node) pair
+ * and every (phandle, node) pair is added to a small hash table. Entries
+ * of a hash chain are kept in device tree order so that lookups starting
+ * after a given node offset behave exactly like the libfdt functions.
+ *
+ * The same walk also matches every node against the match tables of all
+ * FDT driver classes (see fdt_driver_classes.carray) and records, for each
+ * match table, the matching nodes in device tree order. Driver frameworks
+ * then consume these lists at their own init stage via fdt_find_match().
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#include <libfdt.h>
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_string.h>
+#include <sbi_utils/fdt/fdt_builtin.h>
+#include <sbi_utils/fdt/fdt_helper.h>
+#include <sbi_utils/fdt/fdt_index.h>
+
+#define FDT_INDEX_MAX_COMPAT		1024
+#define FDT_INDEX_MAX_PHANDLE		512
+#define FDT_INDEX_BUCKETS		128
+#define FDT_INDEX_MAX_DRIVERS		64
+#define FDT_INDEX_MAX_DRV_COMPAT	256
+#define FDT_INDEX_MAX_PROBE		256
+#define FDT_INDEX_NONE			0xffff
+
+enum fdt_index_state {
+	FDT_INDEX_UNBUILT = 0,
+	FDT_INDEX_BUILT,
+	FDT_INDEX_STALE,
+	FDT_INDEX_FAILED,
+};
+
+struct fdt_index_table {
+	u32 count;
+	u32 max;
+	u32 *keys;
+	int *offsets;
+	u16 *next;
+	u16 head[FDT_INDEX_BUCKETS];
+	u16 tail[FDT_INDEX_BUCKETS];
+};
+
+static u32 compat_keys[FDT_INDEX_MAX_COMPAT];
+static int compat_offsets[FDT_INDEX_MAX_COMPAT];
+static u16 compat_next[FDT_INDEX_MAX_COMPAT];
+
+static u32 phandle_keys[FDT_INDEX_MAX_PHANDLE];
+static int phandle_offsets[FDT_INDEX_MAX_PHANDLE];
+static u16 phandle_next[FDT_INDEX_MAX_PHANDLE];
+
+static struct fdt_index_table compat_table = {
+	.max = FDT_INDEX_MAX_COMPAT,
+	.keys = compat_keys,
+	.offsets = compat_offsets,
+	.next = compat_next,
+};
+
+static struct fdt_index_table phandle_table = {
+	.max = FDT_INDEX_MAX_PHANDLE,
+	.keys = phandle_keys,
+	.offsets = phandle_offsets,
+	.next = phandle_next,
+};
+
+/* Compatible strings of all driver match tables */
+static u32 drv_compat_keys[FDT_INDEX_MAX_DRV_COMPAT];
+static int drv_compat_tables[FDT_INDEX_MAX_DRV_COMPAT];
+static u16 drv_compat_next[FDT_INDEX_MAX_DRV_COMPAT];
+static const struct fdt_match *drv_compat_matches[FDT_INDEX_MAX_DRV_COMPAT];
+
+static struct fdt_index_table drv_compat_table = {
+	.max = FDT_INDEX_MAX_DRV_COMPAT,
+	.keys = drv_compat_keys,
+	.offsets = drv_compat_tables,
+	.next = drv_compat_next,
+};
+
+/* Per match table list of matching nodes in device tree order */
+static struct {
+	u32 count;
+	const struct fdt_match *tables[FDT_INDEX_MAX_DRIVERS];
+	u16 head[FDT_INDEX_MAX_DRIVERS];
+	u16 tail[FDT_INDEX_MAX_DRIVERS];
+	u32 probe_count;
+	int probe_offsets[FDT_INDEX_MAX_PROBE];
+	const struct fdt_match *probe_matches[FDT_INDEX_MAX_PROBE];
+	u16 probe_next[FDT_INDEX_MAX_PROBE];
+	bool valid;
+} drv_plan;
+
+/* List of FDT driver classes generated at compile time */
+extern const struct fdt_driver_class *fdt_driver_classes[];
+extern unsigned long fdt_driver_classes_size;
+
+/* Well-known paths which are looked-up repeatedly */
+static struct {
+	const char *path;
+	int offset;
+} index_paths[] = {
+	{ .path = "/" },
+	{ .path = "/chosen" },
+	{ .path = "/cpus" },
+	{ .path = "/reserved-memory" },
+};
+
+static enum fdt_index_state index_state = FDT_INDEX_UNBUILT;
+static const void *index_fdt;
+static const void *index_struct;
+static u32 index_struct_size;
+
+static u32 fdt_index_hash(const char *str, int len)
+{
+	u32 hash = 2166136261U;
+
+	while (len-- > 0 && *str) {
+		hash ^= (u8)*str++;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+static void fdt_index_table_reset(struct fdt_index_table *tbl)
+{
+	u32 i;
+
+	tbl->count = 0;
+	for (i = 0; i < FDT_INDEX_BUCKETS; i++) {
+		tbl->head[i] = FDT_INDEX_NONE;
+		tbl->tail[i] = FDT_INDEX_NONE;
+	}
+}
+
+static int fdt_index_table_add(struct fdt_index_table *tbl,
+			       u32 key, int offset)
+{
+	u32 b = key % FDT_INDEX_BUCKETS;
+	u16 i;
+
+	if (tbl->max <= tbl->count)
+		return SBI_ENOSPC;
+
+	i = tbl->count++;
+	tbl->keys[i] = key;
+	tbl->offsets[i] = offset;
+	tbl->next[i] = FDT_INDEX_NONE;
+
+	/* Append to keep each chain in device tree order */
+	if (tbl->tail[b] == FDT_INDEX_NONE)
+		tbl->head[b] = i;
+	else
+		tbl->next[tbl->tail[b]] = i;
+	tbl->tail[b] = i;
+
+	return 0;
+}
+
+static int fdt_index_drv_table_find(const struct fdt_match *match_table)
+{
+	int i;
+
+	for (i = 0; i < drv_plan.count; i++) {
+		if (drv_plan.tables[i] == match_table)
+			return i;
+	}
+
+	return -1;
+}
+
+static void fdt_index_drv_init(void)
+{
+	const struct fdt_driver_class *cls;
+	const struct fdt_match *match;
+	int i, j, k, t, len;
+	u32 key;
+
+	fdt_index_table_reset(&drv_compat_table);
+	drv_plan.count = 0;
+	drv_plan.probe_count = 0;
+	drv_plan.valid = false;
+
+	for (i = 0; i < fdt_driver_classes_size; i++) {
+		cls = fdt_driver_classes[i];
+		for (j = 0; j < cls->match_tables_size; j++) {
+			match = *cls->match_tables[j];
+			if (!match || fdt_index_drv_table_find(match) >= 0)
+				continue;
+			if (FDT_INDEX_MAX_DRIVERS <= drv_plan.count)
+				return;
+
+			t = drv_plan.count++;
+			drv_plan.tables[t] = match;
+			drv_plan.head[t] = FDT_INDEX_NONE;
+			drv_plan.tail[t] = FDT_INDEX_NONE;
+			for (; match->compatible; match++) {
+				len = sbi_strlen(match->compatible);
+				key = fdt_index_hash(match->compatible, len);
+				if (fdt_index_table_add(&drv_compat_table,
+							key, t))
+					return;
+				k = drv_compat_table.count - 1;
+				drv_compat_matches[k] = match;
+			}
+		}
+	}
+
+	drv_plan.valid = true;
+}
+
+static void fdt_index_drv_add(int t, int noff, const struct fdt_match *match)
+{
+	u16 i = drv_plan.tail[t];
+
+	/*
+	 * Several compatible strings of a node may hit the same match
+	 * table in which case the first entry of the table wins just
+	 * like fdt_match_node().
+	 */
+	if (i != FDT_INDEX_NONE && drv_plan.probe_offsets[i] == noff) {
+		if (match < drv_plan.probe_matches[i])
+			drv_plan.probe_matches[i] = match;
+		return;
+	}
+
+	if (FDT_INDEX_MAX_PROBE <= drv_plan.probe_count) {
+		drv_plan.valid = false;
+		return;
+	}
+
+	i = drv_plan.probe_count++;
+	drv_plan.probe_offsets[i] = noff;
+	drv_plan.probe_matches[i] = match;
+	drv_plan.probe_next[i] = FDT_INDEX_NONE;
+	if (drv_plan.tail[t] == FDT_INDEX_NONE)
+		drv_plan.head[t] = i;
+	else
+		drv_plan.probe_next[drv_plan.tail[t]] = i;
+	drv_plan.tail[t] = i;
+}
+
+static void fdt_index_drv_match(int noff, const char *compat, int len,
+				u32 key)
+{
+	const struct fdt_match *match;
+	u16 i;
+
+	for (i = drv_compat_table.head[key % FDT_INDEX_BUCKETS];
+	     i != FDT_INDEX_NONE; i = drv_compat_table.next[i]) {
+		if (drv_compat_table.keys[i] != key)
+			continue;
+		match = drv_compat_matches[i];
+		if (sbi_strncmp(match->compatible, compat, len))
+			continue;
+		fdt_index_drv_add(drv_compat_table.offsets[i], noff, match);
+	}
+}
+
+/*
+ * Node offsets are relative to the structure block so the index of a
+ * device tree stays valid for a copy of it, such as the one made when
+ * the firmware relocates the device tree.
+ */
+static void fdt_index_rekey(const void *fdt)
+{
+	const void *dt_struct = (const char *)fdt + fdt_off_dt_struct(fdt);
+
+	if (index_struct_size == fdt_size_dt_struct(fdt) &&
+	    !sbi_memcmp(index_struct, dt_struct, index_struct_size)) {
+		index_fdt = fdt;
+		index_struct = dt_struct;
+		return;
+	}
+
+	fdt_index_build(fdt);
+}
+
+static bool fdt_index_usable(const void *fdt)
+{
+	if (index_state == FDT_INDEX_UNBUILT)
+		fdt_index_build(fdt);
+	else if (index_state == FDT_INDEX_BUILT && index_fdt != fdt)
+		fdt_index_rekey(fdt);
+
+	/*
+	 * The device tree size check catches modifications done without
+	 * calling fdt_index_invalidate().
+	 */
+	return (index_state == FDT_INDEX_BUILT && index_fdt == fdt &&
+		index_struct_size == fdt_size_dt_struct(fdt)) ? true : false;
+}
+
+int fdt_index_build(const void *fdt)
+{
+	int i, rc, len, slen, depth, noff;
+	const char *name, *path, *compat;
+	u32 key, phandle;
+
+	if (!fdt)
+		return SBI_EINVAL;
+
+	index_state = FDT_INDEX_FAILED;
+	index_fdt = fdt;
+	index_struct = (const char *)fdt + fdt_off_dt_struct(fdt);
+	index_struct_size = fdt_size_dt_struct(fdt);
+
+	fdt_index_table_reset(&compat_table);
+	fdt_index_table_reset(&phandle_table);
+	fdt_index_drv_init();
+	for (i = 0; i < array_size(index_paths); i++)
+		index_paths[i].offset = -FDT_ERR_NOTFOUND;
+
+	/* The root node is at depth 1 */
+	depth = 0;
+	for (noff = fdt_next_node(fdt, -1, &depth); noff >= 0;
+	     noff = fdt_next_node(fdt, noff, &depth)) {
+		if (depth == 1) {
+			index_paths[0].offset = noff;
+		} else if (depth == 2) {
+			name = fdt_get_name(fdt, noff, &len);
+			for (i = 1; name && i < array_size(index_paths); i++) {
+				path = index_paths[i].path + 1;
+				if (len == sbi_strlen(path) &&
+				    !sbi_strncmp(name, path, len))
+					index_paths[i].offset = noff;
+			}
+		}
+
+		phandle = fdt_get_phandle(fdt, noff);
+		if (phandle) {
+			rc = fdt_index_table_add(&phandle_table,
+						 phandle, noff);
+			if (rc)
+				return rc;
+		}
+
+		compat = fdt_getprop(fdt, noff, "compatible", &len);
+		while (compat && len > 0) {
+			slen = sbi_strnlen(compat, len) + 1;
+			key = fdt_index_hash(compat, slen);
+			rc = fdt_index_table_add(&compat_table, key, noff);
+			if (rc)
+				return rc;
+			if (drv_plan.valid)
+				fdt_index_drv_match(noff, compat, slen, key);
+			compat += slen;
+			len -= slen;
+		}
+	}
+	if (noff != -FDT_ERR_NOTFOUND)
+		return SBI_EINVAL;
+
+	index_state = FDT_INDEX_BUILT;
+	return 0;
+}
+
+void fdt_index_invalidate(void)
+{
+	if (index_state == FDT_INDEX_BUILT)
+		index_state = FDT_INDEX_STALE;
+	fdt_builtin_invalidate();
+}
+
+int fdt_index_offset_by_compatible(const void *fdt, int startoffset,
+				   const char *compatible)
+{
+	u32 key;
+	u16 i;
+
+	if (!fdt_index_usable(fdt))
+		return fdt_node_offset_by_compatible(fdt, startoffset,
+						     compatible);
+
+	key = fdt_index_hash(compatible, sbi_strlen(compatible));
+	for (i = compat_table.head[key % FDT_INDEX_BUCKETS];
+	     i != FDT_INDEX_NONE; i = compat_table.next[i]) {
+		if (compat_table.offsets[i] <= startoffset ||
+		    compat_table.keys[i] != key)
+			continue;
+		if (!fdt_node_check_compatible(fdt, compat_table.offsets[i],
+					       compatible))
+			return compat_table.offsets[i];
+	}
+
+	return -FDT_ERR_NOTFOUND;
+}
+
+int fdt_index_offset_by_phandle(const void *fdt, uint32_t phandle)
+{
+	u16 i;
+
+	if ((phandle == 0) || (phandle == (u32)-1))
+		return -FDT_ERR_BADPHANDLE;
+
+	if (!fdt_index_usable(fdt))
+		return fdt_node_offset_by_phandle(fdt, phandle);
+
+	for (i = phandle_table.head[phandle % FDT_INDEX_BUCKETS];
+	     i != FDT_INDEX_NONE; i = phandle_table.next[i]) {
+		if (phandle_table.keys[i] == phandle)
+			return phandle_table.offsets[i];
+	}
+
+	return -FDT_ERR_NOTFOUND;
+}
+
+int fdt_index_path_offset(const void *fdt, const char *path)
+{
+	int i;
+
+	if (fdt_index_usable(fdt)) {
+		for (i = 0; i < array_size(index_paths); i++) {
+			if (!sbi_strncmp(path, index_paths[i].path,
+					 sbi_strlen(index_paths[i].path) + 1))
+				return index_paths[i].offset;
+		}
+	}
+
+	return fdt_path_offset(fdt, path);
+}
+
+int fdt_index_find_match(const void *fdt, int startoff,
+			 const struct fdt_match *match_table,
+			 const struct fdt_match **out_match)
+{
+	int t;
+	u16 i;
+
+	if (!fdt_index_usable(fdt) || !drv_plan.valid)
+		return SBI_ENOSYS;
+
+	t = fdt_index_drv_table_find(match_table);
+	if (t < 0)
+		return SBI_ENOSYS;
+
+	for (i = drv_plan.head[t]; i != FDT_INDEX_NONE;
+	     i = drv_plan.probe_next[i]) {
+		if (drv_plan.probe_offsets[i] <= startoff)
+			continue;
+		if (out_match)
+			*out_match = drv_plan.probe_matches[i];
+		return drv_plan.probe_offsets[i];
+	}
+
+	return SBI_ENODEV;
+}
+
+int fdt_index_match_node(const void *fdt, int nodeoff,
+			 const struct fdt_match *match_table,
+			 const struct fdt_match **out_match)
+{
+	int t;
+	u16 i;
+
+	if (!fdt_index_usable(fdt) || !drv_plan.valid)
+		return SBI_ENOSYS;
+
+	t = fdt_index_drv_table_find(match_table);
+	if (t < 0)
+		return SBI_ENOSYS;
+
+	for (i = drv_plan.head[t]; i != FDT_INDEX_NONE;
+	     i = drv_plan.probe_next[i]) {
+		if (drv_plan.probe_offsets[i] < nodeoff)
+			continue;
+		if (drv_plan.probe_offsets[i] > nodeoff)
+			break;
+		*out_match = drv_plan.probe_matches[i];
+		return 0;
+	}
+
+	return SBI_ENODEV;
+}
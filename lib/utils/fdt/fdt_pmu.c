@@ -14,6 +14,8 @@
 #include <sbi/sbi_pmu.h>
 #include <sbi/sbi_scratch.h>
 #include <sbi_utils/fdt/fdt_helper.h>
+#include <sbi_utils/fdt/fdt_index.h>
+#include <sbi_utils/fdt/fdt_rewrite.h>
 
 #define FDT_PMU_HW_EVENT_MAX (SBI_PMU_HW_EVENT_MAX * 2)
 
@@ -47,17 +49,19 @@ int fdt_pmu_fixup(void *fdt)
 	if (!fdt)
 		return SBI_EINVAL;
 
-	pmu_offset = fdt_node_offset_by_compatible(fdt, -1, "riscv,pmu");
+	pmu_offset = fdt_index_offset_by_compatible(fdt, -1, "riscv,pmu");
 	if (pmu_offset < 0)
 		return SBI_EFAIL;
 
-	fdt_delprop(fdt, pmu_offset, "riscv,event-to-mhpmcounters");
-	fdt_delprop(fdt, pmu_offset, "riscv,event-to-mhpmevent");
-	fdt_delprop(fdt, pmu_offset, "riscv,raw-event-to-mhpmcounters");
+	fdt_rewrite_begin(fdt);
+	fdt_rewrite_delprop(fdt, pmu_offset, "riscv,event-to-mhpmcounters");
+	fdt_rewrite_delprop(fdt, pmu_offset, "riscv,event-to-mhpmevent");
+	fdt_rewrite_delprop(fdt, pmu_offset,
+			    "riscv,raw-event-to-mhpmcounters");
 	if (!sbi_hart_has_extension(scratch, SBI_HART_EXT_SSCOFPMF))
-		fdt_delprop(fdt, pmu_offset, "interrupts-extended");
+		fdt_rewrite_delprop(fdt, pmu_offset, "interrupts-extended");
 
-	return 0;
+	return fdt_rewrite_end(fdt);
 }
 
 int fdt_pmu_setup(void *fdt)
@@ -72,7 +76,7 @@ int fdt_pmu_setup(void *fdt)
 	if (!fdt)
 		return SBI_EINVAL;
 
-	pmu_offset = fdt_node_offset_by_compatible(fdt, -1, "riscv,pmu");
+	pmu_offset = fdt_index_offset_by_compatible(fdt, -1, "riscv,pmu");
 	if (pmu_offset < 0)
 		return SBI_EFAIL;
 
@@ -0,0 +1,655 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * fdt_rewrite.c - Batched Flat Device Tree edits
+ *
+ * Edits are queued against node offsets of the unmodified device tree.
+ * When the outermost batch ends, the blob is moved up by an upper bound
+ * of its growth and streamed back to its original address while the
+ * queued edits are applied. The write pointer never passes the read
+ * pointer so no additional buffer is needed and every edit costs the
+ * same single pass over the device tree.
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#include <libfdt.h>
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_hartmask.h>
+#include <sbi/sbi_string.h>
+#include <sbi_utils/fdt/fdt_index.h>
+#include <sbi_utils/fdt/fdt_rewrite.h>
+
+/*
+ * Most edits are per-CPU so a single nested batch needs room for one
+ * edit per HART described by the device tree plus a few more.
+ */
+#define FDT_REWRITE_MAX_EDITS		(2 * SBI_HARTMASK_MAX_BITS)
+#define FDT_REWRITE_MAX_DATA		4096
+#define FDT_REWRITE_MAX_DEPTH		32
+#define FDT_REWRITE_NEW_NODE		0x40000000
+#define FDT_REWRITE_ALIGN(x)		(((x) + 3) & ~3U)
+
+enum fdt_rewrite_type {
+	FDT_REWRITE_SETPROP = 0,
+	FDT_REWRITE_DELPROP,
+	FDT_REWRITE_ADD_NODE,
+	FDT_REWRITE_DEL_NODE,
+};
+
+struct fdt_rewrite_edit {
+	/* Node offset in the unmodified tree or handle of a new node */
+	int node;
+	u16 type;
+	u16 done;
+	/* Offsets of name and value in the data pool */
+	u32 name;
+	u32 data;
+	u32 len;
+	/* Handle of the new node (ADD_NODE) or name offset (SETPROP) */
+	int arg;
+};
+
+struct fdt_rewrite_state {
+	void *fdt;
+	u32 depth;
+	int err;
+	u32 count;
+	u32 data_used;
+	u32 new_nodes;
+	struct fdt_rewrite_edit edits[FDT_REWRITE_MAX_EDITS];
+	u16 order[FDT_REWRITE_MAX_EDITS];
+	char data[FDT_REWRITE_MAX_DATA];
+};
+
+struct fdt_rewrite_out {
+	char *buf;
+	u32 pos;
+};
+
+static struct fdt_rewrite_state rw;
+
+static const char *fdt_rewrite_name(const struct fdt_rewrite_edit *e)
+{
+	return &rw.data[e->name];
+}
+
+static int fdt_rewrite_data(const void *src, u32 len, u32 *out_off)
+{
+	if (FDT_REWRITE_MAX_DATA - rw.data_used < len)
+		return SBI_ENOSPC;
+
+	if (len)
+		sbi_memcpy(&rw.data[rw.data_used], src, len);
+	*out_off = rw.data_used;
+	rw.data_used += len;
+
+	return 0;
+}
+
+static int fdt_rewrite_queue(void *fdt, int nodeoff, u32 type,
+			     const char *name, const void *val, u32 len,
+			     struct fdt_rewrite_edit **out_edit)
+{
+	struct fdt_rewrite_edit *e;
+	int rc;
+
+	if (!rw.depth || rw.fdt != fdt || nodeoff < 0)
+		return SBI_EINVAL;
+	if (FDT_REWRITE_MAX_EDITS <= rw.count) {
+		rw.err = SBI_ENOSPC;
+		return SBI_ENOSPC;
+	}
+
+	e = &rw.edits[rw.count];
+	sbi_memset(e, 0, sizeof(*e));
+	e->node = nodeoff;
+	e->type = type;
+	if (name) {
+		rc = fdt_rewrite_data(name, sbi_strlen(name) + 1, &e->name);
+		if (!rc)
+			rc = fdt_rewrite_data(val, len, &e->data);
+		if (rc) {
+			rw.err = rc;
+			return rc;
+		}
+	}
+	e->len = len;
+	rw.count++;
+
+	if (out_edit)
+		*out_edit = e;
+	return 0;
+}
+
+void fdt_rewrite_begin(void *fdt)
+{
+	if (rw.depth++)
+		return;
+
+	rw.fdt = fdt;
+	rw.err = 0;
+	rw.count = 0;
+	rw.data_used = 0;
+	rw.new_nodes = 0;
+}
+
+int fdt_rewrite_setprop(void *fdt, int nodeoff, const char *name,
+			const void *val, int len)
+{
+	if (!name || len < 0 || (len && !val))
+		return SBI_EINVAL;
+
+	return fdt_rewrite_queue(fdt, nodeoff, FDT_REWRITE_SETPROP,
+				 name, val, len, NULL);
+}
+
+int fdt_rewrite_delprop(void *fdt, int nodeoff, const char *name)
+{
+	if (!name)
+		return SBI_EINVAL;
+
+	return fdt_rewrite_queue(fdt, nodeoff, FDT_REWRITE_DELPROP,
+				 name, NULL, 0, NULL);
+}
+
+int fdt_rewrite_add_subnode(void *fdt, int parentoff, const char *name)
+{
+	struct fdt_rewrite_edit *e;
+	int rc;
+
+	if (!name)
+		return SBI_EINVAL;
+
+	rc = fdt_rewrite_queue(fdt, parentoff, FDT_REWRITE_ADD_NODE,
+			       name, NULL, 0, &e);
+	if (rc)
+		return rc;
+
+	e->arg = FDT_REWRITE_NEW_NODE + rw.new_nodes++;
+	return e->arg;
+}
+
+int fdt_rewrite_del_node(void *fdt, int nodeoff)
+{
+	return fdt_rewrite_queue(fdt, nodeoff, FDT_REWRITE_DEL_NODE,
+				 NULL, NULL, 0, NULL);
+}
+
+static void fdt_rewrite_sort(void)
+{
+	u32 i, j;
+	int node;
+
+	/* Stable insertion sort so that later edits still win */
+	for (i = 0; i < rw.count; i++) {
+		node = rw.edits[i].node;
+		for (j = i; j > 0; j--) {
+			if (rw.edits[rw.order[j - 1]].node <= node)
+				break;
+			rw.order[j] = rw.order[j - 1];
+		}
+		rw.order[j] = i;
+	}
+}
+
+static int fdt_rewrite_find_string(const char *strtab, u32 size,
+				   const char *name)
+{
+	u32 off = 0;
+
+	while (off < size) {
+		if (!sbi_strcmp(&strtab[off], name))
+			return off;
+		off += sbi_strnlen(&strtab[off], size - off) + 1;
+	}
+
+	return -1;
+}
+
+/* Is edit order[pos] overridden by a later property edit of [pos, end) ? */
+static bool fdt_rewrite_superseded(u32 pos, u32 end)
+{
+	const struct fdt_rewrite_edit *e = &rw.edits[rw.order[pos]], *l;
+
+	for (pos++; pos < end; pos++) {
+		l = &rw.edits[rw.order[pos]];
+		if (l->node != e->node ||
+		    (l->type != FDT_REWRITE_SETPROP &&
+		     l->type != FDT_REWRITE_DELPROP))
+			continue;
+		if (!sbi_strcmp(fdt_rewrite_name(l), fdt_rewrite_name(e)))
+			return true;
+	}
+
+	return false;
+}
+
+static void fdt_rewrite_put32(struct fdt_rewrite_out *out, u32 val)
+{
+	fdt32_t tmp = cpu_to_fdt32(val);
+
+	sbi_memcpy(&out->buf[out->pos], &tmp, sizeof(tmp));
+	out->pos += sizeof(tmp);
+}
+
+static void fdt_rewrite_put(struct fdt_rewrite_out *out,
+			    const void *src, u32 len)
+{
+	u32 alen = FDT_REWRITE_ALIGN(len);
+
+	sbi_memmove(&out->buf[out->pos], src, len);
+	sbi_memset(&out->buf[out->pos + len], 0, alen - len);
+	out->pos += alen;
+}
+
+static void fdt_rewrite_put_prop(struct fdt_rewrite_out *out,
+				 const struct fdt_rewrite_edit *e, u32 nameoff)
+{
+	fdt32_t hdr[3];
+
+	hdr[0] = cpu_to_fdt32(FDT_PROP);
+	hdr[1] = cpu_to_fdt32(e->len);
+	hdr[2] = cpu_to_fdt32(nameoff);
+	sbi_memcpy(&out->buf[out->pos], hdr, sizeof(hdr));
+	out->pos += sizeof(hdr);
+	fdt_rewrite_put(out, &rw.data[e->data], e->len);
+}
+
+/* Emit properties added to a node, i.e. those not replacing one */
+static void fdt_rewrite_put_new_props(struct fdt_rewrite_out *out,
+				      u32 first, u32 end)
+{
+	struct fdt_rewrite_edit *e;
+	u32 pos;
+
+	for (pos = first; pos < end; pos++) {
+		e = &rw.edits[rw.order[pos]];
+		if (e->type != FDT_REWRITE_SETPROP || e->done)
+			continue;
+		e->done = 1;
+		if (!fdt_rewrite_superseded(pos, end))
+			fdt_rewrite_put_prop(out, e, e->arg);
+	}
+}
+
+static void fdt_rewrite_mark_done(u32 first, u32 end, const char *name)
+{
+	struct fdt_rewrite_edit *e;
+	u32 pos;
+
+	for (pos = first; pos < end; pos++) {
+		e = &rw.edits[rw.order[pos]];
+		if ((e->type == FDT_REWRITE_SETPROP ||
+		     e->type == FDT_REWRITE_DELPROP) &&
+		    !sbi_strcmp(fdt_rewrite_name(e), name))
+			e->done = 1;
+	}
+}
+
+static void fdt_rewrite_range(int node, u32 *first, u32 *end)
+{
+	u32 pos;
+
+	for (pos = 0; pos < rw.count; pos++) {
+		if (rw.edits[rw.order[pos]].node == node)
+			break;
+	}
+	*first = pos;
+	while (pos < rw.count && rw.edits[rw.order[pos]].node == node)
+		pos++;
+	*end = pos;
+}
+
+static void fdt_rewrite_put_new_nodes(struct fdt_rewrite_out *out,
+				      u32 first, u32 end)
+{
+	const struct fdt_rewrite_edit *e;
+	u32 pos, cfirst, cend;
+
+	for (pos = first; pos < end; pos++) {
+		e = &rw.edits[rw.order[pos]];
+		if (e->type != FDT_REWRITE_ADD_NODE)
+			continue;
+
+		fdt_rewrite_range(e->arg, &cfirst, &cend);
+		fdt_rewrite_put32(out, FDT_BEGIN_NODE);
+		fdt_rewrite_put(out, fdt_rewrite_name(e),
+				sbi_strlen(fdt_rewrite_name(e)) + 1);
+		fdt_rewrite_put_new_props(out, cfirst, cend);
+		fdt_rewrite_put_new_nodes(out, cfirst, cend);
+		fdt_rewrite_put32(out, FDT_END_NODE);
+	}
+}
+
+/* Size of the struct block element starting at the given tag */
+static u32 fdt_rewrite_tag_size(const char *p, u32 tag, u32 avail)
+{
+	switch (tag) {
+	case FDT_BEGIN_NODE:
+		return FDT_REWRITE_ALIGN(FDT_TAGSIZE +
+				sbi_strnlen(p + FDT_TAGSIZE, avail) + 1);
+	case FDT_PROP:
+		return FDT_REWRITE_ALIGN(3 * FDT_TAGSIZE +
+				fdt32_ld((const fdt32_t *)p + 1));
+	default:
+		return FDT_TAGSIZE;
+	}
+}
+
+/*
+ * Check the struct block before anything is moved so that a malformed
+ * device tree is left untouched instead of half rewritten.
+ */
+static int fdt_rewrite_check_struct(const char *in, u32 in_size,
+				    u32 strings_size)
+{
+	u32 pos, len, tag, depth = 0;
+
+	for (pos = 0; pos < in_size; pos += len) {
+		if (in_size - pos < FDT_TAGSIZE)
+			return SBI_EINVAL;
+		tag = fdt32_ld((const fdt32_t *)(in + pos));
+		if (tag == FDT_PROP && in_size - pos < 3 * FDT_TAGSIZE)
+			return SBI_EINVAL;
+		len = fdt_rewrite_tag_size(in + pos, tag, in_size - pos);
+		if (in_size - pos < len)
+			return SBI_EINVAL;
+
+		switch (tag) {
+		case FDT_BEGIN_NODE:
+			depth++;
+			break;
+		case FDT_END_NODE:
+			if (!depth)
+				return SBI_EINVAL;
+			depth--;
+			break;
+		case FDT_PROP:
+			if (strings_size <=
+			    fdt32_ld((const fdt32_t *)(in + pos) + 2))
+				return SBI_EINVAL;
+			break;
+		case FDT_NOP:
+			break;
+		case FDT_END:
+			return depth ? SBI_EINVAL : 0;
+		default:
+			return SBI_EINVAL;
+		}
+	}
+
+	return SBI_EINVAL;
+}
+
+static int fdt_rewrite_struct(struct fdt_rewrite_out *out, const char *in,
+			      u32 in_size, const char *strtab)
+{
+	struct {
+		u32 first;
+		u32 end;
+		bool props_done;
+	} stack[FDT_REWRITE_MAX_DEPTH];
+	u32 pos, len, tag, nameoff, cur = 0, skip = 0, depth = 0;
+	const struct fdt_rewrite_edit *e;
+	const char *name;
+	int i;
+
+	for (pos = 0; pos < in_size; pos += len) {
+		tag = fdt32_ld((const fdt32_t *)(in + pos));
+		len = fdt_rewrite_tag_size(in + pos, tag, in_size - pos);
+		if (in_size - pos < len)
+			return SBI_EINVAL;
+
+		/* Drop deleted subtrees */
+		if (skip) {
+			if (tag == FDT_BEGIN_NODE)
+				skip++;
+			else if (tag == FDT_END_NODE)
+				skip--;
+			continue;
+		}
+
+		if (tag == FDT_BEGIN_NODE || tag == FDT_END_NODE) {
+			/* New properties go before the first subnode */
+			if (depth && depth <= FDT_REWRITE_MAX_DEPTH &&
+			    !stack[depth - 1].props_done) {
+				fdt_rewrite_put_new_props(out,
+						stack[depth - 1].first,
+						stack[depth - 1].end);
+				stack[depth - 1].props_done = true;
+			}
+		}
+
+		switch (tag) {
+		case FDT_BEGIN_NODE:
+			while (cur < rw.count &&
+			       rw.edits[rw.order[cur]].node < (int)pos)
+				cur++;
+			i = cur;
+			while (cur < rw.count &&
+			       rw.edits[rw.order[cur]].node == (int)pos) {
+				if (rw.edits[rw.order[cur]].type ==
+				    FDT_REWRITE_DEL_NODE)
+					skip = 1;
+				cur++;
+			}
+			if (skip)
+				continue;
+			if (depth < FDT_REWRITE_MAX_DEPTH) {
+				stack[depth].first = i;
+				stack[depth].end = cur;
+				stack[depth].props_done = false;
+			}
+			depth++;
+			break;
+		case FDT_END_NODE:
+			if (!depth)
+				return SBI_EINVAL;
+			depth--;
+			if (depth < FDT_REWRITE_MAX_DEPTH)
+				fdt_rewrite_put_new_nodes(out,
+						stack[depth].first,
+						stack[depth].end);
+			break;
+		case FDT_PROP:
+			if (!depth || FDT_REWRITE_MAX_DEPTH < depth)
+				break;
+			nameoff = fdt32_ld((const fdt32_t *)(in + pos) + 2);
+			name = strtab + nameoff;
+			for (i = stack[depth - 1].end - 1;
+			     i >= (int)stack[depth - 1].first; i--) {
+				e = &rw.edits[rw.order[i]];
+				if ((e->type == FDT_REWRITE_SETPROP ||
+				     e->type == FDT_REWRITE_DELPROP) &&
+				    !sbi_strcmp(fdt_rewrite_name(e), name))
+					break;
+			}
+			if (i < (int)stack[depth - 1].first)
+				break;
+			/* Mark all edits of this property as applied */
+			fdt_rewrite_mark_done(stack[depth - 1].first,
+					      stack[depth - 1].end, name);
+			if (e->type == FDT_REWRITE_SETPROP)
+				fdt_rewrite_put_prop(out, e, nameoff);
+			continue;
+		case FDT_NOP:
+			continue;
+		case FDT_END:
+			fdt_rewrite_put32(out, FDT_END);
+			return 0;
+		default:
+			return SBI_EINVAL;
+		}
+
+		fdt_rewrite_put(out, in + pos, len);
+	}
+
+	return SBI_EINVAL;
+}
+
+/* Offset of a property name in the strings block of the new tree */
+static int fdt_rewrite_nameoff(const char *strtab, u32 strings_size,
+			       u32 idx, u32 *new_strings)
+{
+	const char *name = fdt_rewrite_name(&rw.edits[idx]);
+	int off;
+	u32 i;
+
+	for (i = 0; i < idx; i++) {
+		if (rw.edits[i].type == FDT_REWRITE_SETPROP &&
+		    !sbi_strcmp(fdt_rewrite_name(&rw.edits[i]), name))
+			return rw.edits[i].arg;
+	}
+
+	off = fdt_rewrite_find_string(strtab, strings_size, name);
+	if (off >= 0)
+		return off;
+
+	off = strings_size + *new_strings;
+	*new_strings += sbi_strlen(name) + 1;
+	return off;
+}
+
+static int fdt_rewrite_apply(void *fdt)
+{
+	u32 i, grow, tsize, boot_cpuid, new_strings;
+	u32 rsv_off, rsv_size, struct_off, struct_size;
+	u32 strings_off, strings_size, out_struct, out_strings;
+	struct fdt_rewrite_out out;
+	struct fdt_rewrite_edit *e;
+	char *in;
+	int rc;
+
+	if (!rw.count)
+		return 0;
+
+	if (fdt_check_header(fdt))
+		return SBI_EINVAL;
+	rc = fdt_num_mem_rsv(fdt);
+	if (rc < 0)
+		return SBI_EINVAL;
+	rsv_size = (rc + 1) * sizeof(struct fdt_reserve_entry);
+
+	fdt_index_invalidate();
+
+	/* Streaming needs a version 17 blob with its blocks in order */
+	if (fdt_version(fdt) < 17 ||
+	    fdt_off_mem_rsvmap(fdt) < sizeof(struct fdt_header) ||
+	    fdt_off_dt_struct(fdt) < fdt_off_mem_rsvmap(fdt) + rsv_size ||
+	    fdt_off_dt_strings(fdt) <
+			fdt_off_dt_struct(fdt) + fdt_size_dt_struct(fdt)) {
+		if (fdt_open_into(fdt, fdt, fdt_totalsize(fdt)))
+			return SBI_EINVAL;
+	}
+
+	tsize = fdt_totalsize(fdt);
+	boot_cpuid = fdt_boot_cpuid_phys(fdt);
+	rsv_off = fdt_off_mem_rsvmap(fdt);
+	struct_off = fdt_off_dt_struct(fdt);
+	struct_size = fdt_size_dt_struct(fdt);
+	strings_off = fdt_off_dt_strings(fdt);
+	strings_size = fdt_size_dt_strings(fdt);
+
+	rc = fdt_rewrite_check_struct((char *)fdt + struct_off, struct_size,
+				      strings_size);
+	if (rc)
+		return rc;
+
+	/* Upper bound of the growth, removed data is not accounted */
+	grow = 0;
+	new_strings = 0;
+	for (i = 0; i < rw.count; i++) {
+		e = &rw.edits[i];
+		if (e->type == FDT_REWRITE_SETPROP) {
+			grow += 3 * FDT_TAGSIZE + FDT_REWRITE_ALIGN(e->len);
+			e->arg = fdt_rewrite_nameoff((char *)fdt + strings_off,
+						     strings_size, i,
+						     &new_strings);
+		} else if (e->type == FDT_REWRITE_ADD_NODE) {
+			grow += 2 * FDT_TAGSIZE + FDT_REWRITE_ALIGN(
+				sbi_strlen(fdt_rewrite_name(e)) + 1);
+		}
+	}
+	grow = (grow + new_strings + 7) & ~7U;
+
+	/* Move the blob up and stream it back to its original address */
+	in = (char *)fdt + grow;
+	sbi_memmove(in, fdt, tsize);
+
+	fdt_rewrite_sort();
+	out.buf = fdt;
+	out.pos = (sizeof(struct fdt_header) + 7) & ~7U;
+	sbi_memmove(&out.buf[out.pos], in + rsv_off, rsv_size);
+	out.pos += rsv_size;
+
+	/* Cannot fail because the struct block was checked above */
+	out_struct = out.pos;
+	fdt_rewrite_struct(&out, in + struct_off, struct_size,
+			   in + strings_off);
+
+	out_strings = out.pos;
+	sbi_memmove(&out.buf[out_strings], in + strings_off, strings_size);
+	for (i = 0; i < rw.count; i++) {
+		e = &rw.edits[i];
+		if (e->type == FDT_REWRITE_SETPROP && strings_size <= e->arg)
+			sbi_memcpy(&out.buf[out_strings + e->arg],
+				   fdt_rewrite_name(e),
+				   sbi_strlen(fdt_rewrite_name(e)) + 1);
+	}
+
+	fdt_set_magic(fdt, FDT_MAGIC);
+	fdt_set_version(fdt, 17);
+	fdt_set_last_comp_version(fdt, 16);
+	fdt_set_boot_cpuid_phys(fdt, boot_cpuid);
+	fdt_set_totalsize(fdt, tsize + grow);
+	fdt_set_off_mem_rsvmap(fdt, (sizeof(struct fdt_header) + 7) & ~7U);
+	fdt_set_off_dt_struct(fdt, out_struct);
+	fdt_set_size_dt_struct(fdt, out_strings - out_struct);
+	fdt_set_off_dt_strings(fdt, out_strings);
+	fdt_set_size_dt_strings(fdt, strings_size + new_strings);
+
+	return 0;
+}
+
+static int fdt_rewrite_flush(void *fdt)
+{
+	int rc;
+
+	rc = fdt_rewrite_apply(fdt);
+	if (rc && !rw.err)
+		rw.err = rc;
+	rw.count = 0;
+	rw.data_used = 0;
+	rw.new_nodes = 0;
+
+	return rw.err;
+}
+
+int fdt_rewrite_end(void *fdt)
+{
+	int rc;
+
+	if (!rw.depth || rw.fdt != fdt)
+		return SBI_EINVAL;
+	if (--rw.depth) {
+		/*
+		 * Start a new pass once a batch nested in the outermost
+		 * one ends with the queue half full. Node offsets of the
+		 * ended batch are no longer used at this point.
+		 */
+		if (rw.depth == 1 &&
+		    (FDT_REWRITE_MAX_EDITS / 2 < rw.count ||
+		     FDT_REWRITE_MAX_DATA / 2 < rw.data_used))
+			return fdt_rewrite_flush(fdt);
+		return 0;
+	}
+
+	rc = fdt_rewrite_flush(fdt);
+	rw.fdt = NULL;
+
+	return rc;
+}
@@ -4,7 +4,12 @@
 # Copyright (C) 2020 Bin Meng <bmeng.cn@gmail.com>
 #
 
+libsbiutils-objs-$(CONFIG_FDT_BUILTIN) += fdt/fdt_builtin.o
+libsbiutils-objs-$(CONFIG_FDT_BUILTIN) += fdt/fdt_builtin_records.o
 libsbiutils-objs-$(CONFIG_FDT_DOMAIN) += fdt/fdt_domain.o
 libsbiutils-objs-$(CONFIG_FDT_PMU) += fdt/fdt_pmu.o
 libsbiutils-objs-$(CONFIG_FDT) += fdt/fdt_helper.o
 libsbiutils-objs-$(CONFIG_FDT) += fdt/fdt_fixup.o
+libsbiutils-objs-$(CONFIG_FDT) += fdt/fdt_rewrite.o
+libsbiutils-objs-$(CONFIG_FDT_INDEX) += fdt/fdt_index.o
+libsbiutils-objs-$(CONFIG_FDT_INDEX) += fdt/fdt_driver_classes.o
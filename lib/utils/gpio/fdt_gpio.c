@@ -10,6 +10,7 @@
 #include <libfdt.h>
 #include <sbi/sbi_error.h>
 #include <sbi_utils/fdt/fdt_helper.h>
+#include <sbi_utils/fdt/fdt_index.h>
 #include <sbi_utils/gpio/fdt_gpio.h>
 
 /* List of FDT gpio drivers generated at compile time */
@@ -38,7 +39,7 @@ static int fdt_gpio_init(void *fdt, u32 phandle)
 	const struct fdt_match *match;
 
 	/* Find node offset */
-	nodeoff = fdt_node_offset_by_phandle(fdt, phandle);
+	nodeoff = fdt_index_offset_by_phandle(fdt, phandle);
 	if (nodeoff < 0)
 		return nodeoff;
 
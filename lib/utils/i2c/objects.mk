@@ -11,6 +11,7 @@ libsbiutils-objs-$(CONFIG_I2C) += i2c/i2c.o
 
 libsbiutils-objs-$(CONFIG_FDT_I2C) += i2c/fdt_i2c.o
 libsbiutils-objs-$(CONFIG_FDT_I2C) += i2c/fdt_i2c_adapter_drivers.o
+carray-fdt_driver_classes-$(CONFIG_FDT_I2C) += fdt_i2c_adapter_drivers_class
 
 carray-fdt_i2c_adapter_drivers-$(CONFIG_FDT_I2C_SIFIVE) += fdt_i2c_adapter_sifive
 libsbiutils-objs-$(CONFIG_FDT_I2C_SIFIVE) += i2c/fdt_i2c_sifive.o
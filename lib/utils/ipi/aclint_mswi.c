@@ -19,20 +19,22 @@
 
 static struct aclint_mswi_data *mswi_hartid2data[SBI_HARTMASK_MAX_BITS];
 
-static void mswi_ipi_send(u32 target_hart)
+static int mswi_ipi_send(u32 target_hart)
 {
 	u32 *msip;
 	struct aclint_mswi_data *mswi;
 
 	if (SBI_HARTMASK_MAX_BITS <= target_hart)
-		return;
+		return SBI_ENODEV;
 	mswi = mswi_hartid2data[target_hart];
 	if (!mswi)
-		return;
+		return SBI_ENODEV;
 
 	/* Set ACLINT IPI */
 	msip = (void *)mswi->addr;
 	writel(1, &msip[target_hart - mswi->first_hartid]);
+
+	return 0;
 }
 
 static void mswi_ipi_clear(u32 target_hart)
@@ -67,7 +69,7 @@ int aclint_mswi_warm_init(void)
 
 int aclint_mswi_cold_init(struct aclint_mswi_data *mswi)
 {
-	u32 i;
+	u32 i, *msip;
 	int rc;
 	unsigned long pos, region_size;
 	struct sbi_domain_memregion reg;
@@ -99,5 +101,11 @@ int aclint_mswi_cold_init(struct aclint_mswi_data *mswi)
 
 	sbi_ipi_set_device(&aclint_mswi);
 
+	/* Setup IPI doorbells */
+	msip = (void *)mswi->addr;
+	for (i = 0; i < mswi->hart_count; i++)
+		sbi_ipi_set_doorbell(&aclint_mswi, mswi->first_hartid + i,
+				     &msip[i], 1);
+
 	return 0;
 }
@@ -0,0 +1,76 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#include <sbi/riscv_io.h>
+#include <sbi/sbi_domain.h>
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_hartmask.h>
+#include <sbi/sbi_ipi.h>
+#include <sbi_utils/ipi/aclint_sswi.h>
+
+static struct aclint_sswi_data *sswi_hartid2data[SBI_HARTMASK_MAX_BITS];
+
+static int sswi_ipi_send(u32 target_hart)
+{
+	u32 *setssip;
+	struct aclint_sswi_data *sswi;
+
+	if (SBI_HARTMASK_MAX_BITS <= target_hart)
+		return SBI_ENODEV;
+	sswi = sswi_hartid2data[target_hart];
+	if (!sswi)
+		return SBI_ENODEV;
+
+	/* Set ACLINT SSWI (i.e. MIP.SSIP of target HART) */
+	setssip = (void *)sswi->addr;
+	writel(1, &setssip[target_hart - sswi->first_hartid]);
+
+	return 0;
+}
+
+static struct sbi_ipi_device aclint_sswi = {
+	.name = "aclint-sswi",
+	.ipi_send = sswi_ipi_send,
+};
+
+int aclint_sswi_cold_init(struct aclint_sswi_data *sswi)
+{
+	u32 i;
+	int rc;
+
+	/* Sanity checks */
+	if (!sswi || (sswi->addr & (ACLINT_SSWI_ALIGN - 1)) ||
+	    (sswi->size < (sswi->hart_count * sizeof(u32))) ||
+	    (sswi->first_hartid >= SBI_HARTMASK_MAX_BITS) ||
+	    (sswi->hart_count > ACLINT_SSWI_MAX_HARTS))
+		return SBI_EINVAL;
+
+	/* Update SSWI hartid table */
+	for (i = 0; i < sswi->hart_count; i++)
+		sswi_hartid2data[sswi->first_hartid + i] = sswi;
+
+	/*
+	 * Add SSWI regions to the root domain as shared between M-mode
+	 * and S-mode so that S-mode can send IPIs without trapping into
+	 * M-mode. The SSWI DT node is left untouched for S-mode.
+	 */
+	rc = sbi_domain_root_add_memrange(sswi->addr, sswi->size,
+					  ACLINT_SSWI_ALIGN,
+					  (SBI_DOMAIN_MEMREGION_MMIO |
+					   SBI_DOMAIN_MEMREGION_M_READABLE |
+					   SBI_DOMAIN_MEMREGION_M_WRITABLE |
+					   SBI_DOMAIN_MEMREGION_SU_READABLE |
+					   SBI_DOMAIN_MEMREGION_SU_WRITABLE));
+	if (rc)
+		return rc;
+
+	sbi_ipi_set_smode_device(&aclint_sswi);
+
+	return 0;
+}
@@ -40,7 +40,8 @@ static inline void plicsw_complete(void)
 			       PLICSW_CONTEXT_STRIDE * hartid);
 }
 
-static inline void plic_sw_pending(u32 target_hart)
+static void plicsw_ipi_doorbell(u32 target_hart, volatile u32 **addr,
+				u32 *val)
 {
 	/*
 	 * The pending array registers are w1s type.
@@ -59,22 +60,32 @@ static inline void plic_sw_pending(u32 target_hart)
 	 * ------------------------------------------
 	 * The bitY of hartX region indicates that hartX sends an
 	 * IPI to hartY.
+	 *
+	 * All regions are enabled for every target (refer to
+	 * plicsw_cold_ipi_init()) so we always use the region of
+	 * the target HART which makes the doorbell independent of
+	 * the sender and allows it to be computed only once.
 	 */
-	u32 hartid	    = current_hartid();
-	u32 word_index	    = hartid / 4;
-	u32 per_hart_offset = PLICSW_PENDING_STRIDE * hartid;
-	u32 val		    = 1 << target_hart << per_hart_offset;
+	u32 word_index	    = target_hart / 4;
+	u32 per_hart_offset = PLICSW_PENDING_STRIDE * (target_hart % 4);
 
-	writel(val, (void *)plicsw.addr + PLICSW_PENDING_BASE + word_index * 4);
+	*addr = (void *)plicsw.addr + PLICSW_PENDING_BASE + word_index * 4;
+	*val  = 1 << target_hart << per_hart_offset;
 }
 
-static void plicsw_ipi_send(u32 target_hart)
+static int plicsw_ipi_send(u32 target_hart)
 {
+	u32 val;
+	volatile u32 *addr;
+
 	if (plicsw.hart_count <= target_hart)
 		ebreak();
 
 	/* Set PLICSW IPI */
-	plic_sw_pending(target_hart);
+	plicsw_ipi_doorbell(target_hart, &addr, &val);
+	writel(val, addr);
+
+	return 0;
 }
 
 static void plicsw_ipi_clear(u32 target_hart)
@@ -106,6 +117,8 @@ int plicsw_warm_ipi_init(void)
 int plicsw_cold_ipi_init(struct plicsw_data *plicsw)
 {
 	int rc;
+	u32 val;
+	volatile u32 *addr;
 
 	/* Setup source priority */
 	uint32_t *priority = (void *)plicsw->addr + PLICSW_PRIORITY_BASE;
@@ -133,5 +146,11 @@ int plicsw_cold_ipi_init(struct plicsw_data *plicsw)
 
 	sbi_ipi_set_device(&plicsw_ipi);
 
+	/* Setup IPI doorbells */
+	for (int i = 0; i < plicsw->hart_count; i++) {
+		plicsw_ipi_doorbell(i, &addr, &val);
+		sbi_ipi_set_doorbell(&plicsw_ipi, i, addr, val);
+	}
+
 	return 0;
 }
@@ -24,29 +24,44 @@ static struct fdt_ipi dummy = {
 };
 
 static struct fdt_ipi *current_driver = &dummy;
+static struct fdt_ipi *current_smode_driver = &dummy;
 
 void fdt_ipi_exit(void)
 {
+	if (current_smode_driver->exit)
+		current_smode_driver->exit();
 	if (current_driver->exit)
 		current_driver->exit();
 }
 
 static int fdt_ipi_warm_init(void)
 {
-	if (current_driver->warm_init)
-		return current_driver->warm_init();
+	int rc;
+
+	if (current_driver->warm_init) {
+		rc = current_driver->warm_init();
+		if (rc)
+			return rc;
+	}
+	if (current_smode_driver->warm_init)
+		return current_smode_driver->warm_init();
 	return 0;
 }
 
 static int fdt_ipi_cold_init(void)
 {
 	int pos, noff, rc;
-	struct fdt_ipi *drv;
+	struct fdt_ipi *drv, **current;
 	const struct fdt_match *match;
 	void *fdt = fdt_get_address();
 
+	/* Use the first matching driver for M-mode and S-mode IPIs each */
 	for (pos = 0; pos < fdt_ipi_drivers_size; pos++) {
 		drv = fdt_ipi_drivers[pos];
+		current = (drv->smode) ? &current_smode_driver :
+					 &current_driver;
+		if (*current != &dummy)
+			continue;
 
 		noff = -1;
 		while ((noff = fdt_find_match(fdt, noff,
@@ -58,11 +73,8 @@ static int fdt_ipi_cold_init(void)
 				if (rc)
 					return rc;
 			}
-			current_driver = drv;
+			*current = drv;
 		}
-
-		if (current_driver != &dummy)
-			break;
 	}
 
 	return 0;
@@ -9,12 +9,17 @@
 
 libsbiutils-objs-$(CONFIG_IPI_MSWI) += ipi/aclint_mswi.o
 libsbiutils-objs-$(CONFIG_IPI_PLICSW) += ipi/andes_plicsw.o
+libsbiutils-objs-$(CONFIG_IPI_SSWI) += ipi/aclint_sswi.o
 
 libsbiutils-objs-$(CONFIG_FDT_IPI) += ipi/fdt_ipi.o
 libsbiutils-objs-$(CONFIG_FDT_IPI) += ipi/fdt_ipi_drivers.o
+carray-fdt_driver_classes-$(CONFIG_FDT_IPI) += fdt_ipi_drivers_class
 
 carray-fdt_ipi_drivers-$(CONFIG_FDT_IPI_MSWI) += fdt_ipi_mswi
 libsbiutils-objs-$(CONFIG_FDT_IPI_MSWI) += ipi/fdt_ipi_mswi.o
 
 carray-fdt_ipi_drivers-$(CONFIG_FDT_IPI_PLICSW) += fdt_ipi_plicsw
 libsbiutils-objs-$(CONFIG_FDT_IPI_PLICSW) += ipi/fdt_ipi_plicsw.o
+
+carray-fdt_ipi_drivers-$(CONFIG_FDT_IPI_SSWI) += fdt_ipi_sswi
+libsbiutils-objs-$(CONFIG_FDT_IPI_SSWI) += ipi/fdt_ipi_sswi.o
@@ -165,6 +165,104 @@ static int aplic_check_msicfg(struct aplic_msicfg_data *msicfg)
 	return 0;
 }
 
+/*
+ * Target and enable bits of an inactive or delegated source are read-only
+ * zero so these are neither read nor written by save/restore.
+ */
+static inline bool aplic_source_is_active(u32 sourcecfg)
+{
+	if (sourcecfg & APLIC_SOURCECFG_D)
+		return false;
+
+	return ((sourcecfg & APLIC_SOURCECFG_SM_MASK) !=
+		APLIC_SOURCECFG_SM_INACTIVE) ? true : false;
+}
+
+static inline bool aplic_word_is_active(const u32 *sourcecfg, u32 word,
+					u32 num)
+{
+	u32 i;
+
+	for (i = word * 32; i < (word + 1) * 32 && i <= num; i++) {
+		if (i && aplic_source_is_active(sourcecfg[i]))
+			return true;
+	}
+
+	return false;
+}
+
+void aplic_context_save(const struct aplic_data *aplic, u32 *domaincfg,
+			u32 *sourcecfg, u32 *target, u32 *enable, u32 num)
+{
+	u32 i;
+
+	if (aplic->num_source < num)
+		num = aplic->num_source;
+
+	*domaincfg = readl((void *)(aplic->addr + APLIC_DOMAINCFG));
+
+	sourcecfg[0] = target[0] = 0;
+	for (i = 1; i <= num; i++) {
+		sourcecfg[i] = readl((void *)(aplic->addr +
+				     APLIC_SOURCECFG_BASE +
+				     (i - 1) * sizeof(u32)));
+		target[i] = 0;
+		if (aplic_source_is_active(sourcecfg[i]))
+			target[i] = readl((void *)(aplic->addr +
+					  APLIC_TARGET_BASE +
+					  (i - 1) * sizeof(u32)));
+	}
+
+	for (i = 0; i <= num / 32; i++) {
+		enable[i] = 0;
+		if (aplic_word_is_active(sourcecfg, i, num))
+			enable[i] = readl((void *)(aplic->addr +
+					  APLIC_SETIE_BASE + i * sizeof(u32)));
+	}
+}
+
+void aplic_context_restore(const struct aplic_data *aplic, u32 domaincfg,
+			   const u32 *sourcecfg, const u32 *target,
+			   const u32 *enable, u32 num)
+{
+	u32 i;
+
+	if (aplic->num_source < num)
+		num = aplic->num_source;
+
+	/*
+	 * Reset clears the interrupt enable bit of domaincfg so a domain
+	 * which is still enabled as saved did not lose its state.
+	 */
+	if ((domaincfg & APLIC_DOMAINCFG_IE) &&
+	    readl((void *)(aplic->addr + APLIC_DOMAINCFG)) == domaincfg)
+		return;
+
+	/* Keep the domain disabled until all sources are restored */
+	writel(domaincfg & ~APLIC_DOMAINCFG_IE,
+	       (void *)(aplic->addr + APLIC_DOMAINCFG));
+
+	/* Inactive is the reset state of a source */
+	for (i = 1; i <= num; i++) {
+		if (!sourcecfg[i])
+			continue;
+		writel(sourcecfg[i], (void *)(aplic->addr +
+		       APLIC_SOURCECFG_BASE + (i - 1) * sizeof(u32)));
+		if (aplic_source_is_active(sourcecfg[i]))
+			writel(target[i], (void *)(aplic->addr +
+			       APLIC_TARGET_BASE + (i - 1) * sizeof(u32)));
+	}
+
+	/* Writing zero to a setie register has no effect */
+	for (i = 0; i <= num / 32; i++) {
+		if (enable[i])
+			writel(enable[i], (void *)(aplic->addr +
+			       APLIC_SETIE_BASE + i * sizeof(u32)));
+	}
+
+	writel(domaincfg, (void *)(aplic->addr + APLIC_DOMAINCFG));
+}
+
 int aplic_cold_irqchip_init(struct aplic_data *aplic)
 {
 	int rc;
@@ -32,6 +32,34 @@ void fdt_irqchip_exit(void)
 	}
 }
 
+void fdt_irqchip_resume(void)
+{
+	int i;
+
+	for (i = 0; i < current_drivers_count; i++) {
+		if (!current_drivers[i] || !current_drivers[i]->resume)
+			continue;
+		current_drivers[i]->resume();
+	}
+}
+
+int fdt_irqchip_suspend(void)
+{
+	int i, rc;
+
+	for (i = 0; i < current_drivers_count; i++) {
+		if (!current_drivers[i] || !current_drivers[i]->suspend)
+			continue;
+		rc = current_drivers[i]->suspend();
+		if (rc) {
+			fdt_irqchip_resume();
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
 static int fdt_irqchip_warm_init(void)
 {
 	int i, rc;
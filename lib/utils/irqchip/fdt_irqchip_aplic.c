@@ -20,6 +20,79 @@
 static unsigned long aplic_count = 0;
 static struct aplic_data aplic[APLIC_MAX_NR];
 
+#if CONFIG_FDT_IRQCHIP_APLIC_SUSPEND_SIZE
+#define APLIC_SAVE_WORDS \
+	(CONFIG_FDT_IRQCHIP_APLIC_SUSPEND_SIZE / sizeof(u32))
+
+struct aplic_save {
+	u32 domaincfg;
+	u32 *sourcecfg;
+	u32 *target;
+	u32 *enable;
+	bool saved;
+};
+
+static u32 aplic_save_words[APLIC_SAVE_WORDS];
+static unsigned long aplic_save_used;
+static struct aplic_save aplic_save[APLIC_MAX_NR];
+
+static void irqchip_aplic_save_alloc(unsigned long idx)
+{
+	u32 num = aplic[idx].num_source;
+	unsigned long words = 2 * (num + 1) + num / 32 + 1;
+	struct aplic_save *as = &aplic_save[idx];
+
+	/* System suspend fails for a domain without storage */
+	if (APLIC_SAVE_WORDS - aplic_save_used < words)
+		return;
+
+	as->sourcecfg = &aplic_save_words[aplic_save_used];
+	as->target = as->sourcecfg + num + 1;
+	as->enable = as->target + num + 1;
+	aplic_save_used += words;
+}
+
+static void irqchip_aplic_resume(void)
+{
+	struct aplic_save *as;
+	unsigned long i;
+
+	for (i = 0; i < aplic_count; i++) {
+		as = &aplic_save[i];
+		if (!as->saved)
+			continue;
+		aplic_context_restore(&aplic[i], as->domaincfg, as->sourcecfg,
+				      as->target, as->enable,
+				      aplic[i].num_source);
+		as->saved = false;
+	}
+}
+
+static int irqchip_aplic_suspend(void)
+{
+	struct aplic_save *as;
+	unsigned long i;
+
+	for (i = 0; i < aplic_count; i++) {
+		if (!aplic_save[i].sourcecfg)
+			return SBI_ENOSPC;
+	}
+
+	for (i = 0; i < aplic_count; i++) {
+		as = &aplic_save[i];
+		aplic_context_save(&aplic[i], &as->domaincfg, as->sourcecfg,
+				   as->target, as->enable, aplic[i].num_source);
+		as->saved = true;
+	}
+
+	return 0;
+}
+#else
+static inline void irqchip_aplic_save_alloc(unsigned long idx) { }
+#define irqchip_aplic_suspend	NULL
+#define irqchip_aplic_resume	NULL
+#endif
+
 static int irqchip_aplic_warm_init(void)
 {
 	/* Nothing to do here. */
@@ -40,7 +113,12 @@ static int irqchip_aplic_cold_init(void *fdt, int nodeoff,
 	if (rc)
 		return rc;
 
-	return aplic_cold_irqchip_init(pd);
+	rc = aplic_cold_irqchip_init(pd);
+	if (rc)
+		return rc;
+
+	irqchip_aplic_save_alloc(aplic_count - 1);
+	return 0;
 }
 
 static const struct fdt_match irqchip_aplic_match[] = {
@@ -53,4 +131,6 @@ struct fdt_irqchip fdt_irqchip_aplic = {
 	.cold_init = irqchip_aplic_cold_init,
 	.warm_init = irqchip_aplic_warm_init,
 	.exit = NULL,
+	.suspend = irqchip_aplic_suspend,
+	.resume = irqchip_aplic_resume,
 };
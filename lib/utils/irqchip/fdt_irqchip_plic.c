@@ -13,6 +13,7 @@
 #include <sbi/sbi_error.h>
 #include <sbi/sbi_hartmask.h>
 #include <sbi_utils/fdt/fdt_helper.h>
+#include <sbi_utils/fdt/fdt_index.h>
 #include <sbi_utils/irqchip/fdt_irqchip.h>
 #include <sbi_utils/irqchip/plic.h>
 
@@ -82,7 +83,7 @@ static int irqchip_plic_update_hartid_table(void *fdt, int nodeoff,
 		phandle = fdt32_to_cpu(val[i]);
 		hwirq = fdt32_to_cpu(val[i + 1]);
 
-		cpu_intc_offset = fdt_node_offset_by_phandle(fdt, phandle);
+		cpu_intc_offset = fdt_index_offset_by_phandle(fdt, phandle);
 		if (cpu_intc_offset < 0)
 			continue;
 
@@ -150,6 +151,9 @@ static int irqchip_plic_cold_init(void *fdt, int nodeoff,
 static void thead_plic_plat_init(struct plic_data *pd)
 {
 	writel_relaxed(BIT(0), (char *)pd->addr + THEAD_PLIC_CTRL_REG);
+
+	/* Priorities and enables are reset to zero on power-down */
+	pd->flags |= PLIC_FLAG_RESET_ZERO;
 }
 
 void thead_plic_restore(void)
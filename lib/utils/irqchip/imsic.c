@@ -52,6 +52,7 @@
 #define IMSIC_ENABLE_EITHRESHOLD	0
 
 #define IMSIC_IPI_ID			1
+#define IMSIC_IPI_EVENT_BASE_ID		2
 
 #define imsic_csr_write(__c, __v)	\
 do { \
@@ -81,6 +82,20 @@ do { \
 
 static struct imsic_data *imsic_hartid2data[SBI_HARTMASK_MAX_BITS];
 static int imsic_hartid2file[SBI_HARTMASK_MAX_BITS];
+static volatile u32 *imsic_hartid2doorbell[SBI_HARTMASK_MAX_BITS];
+
+/*
+ * Each IPI event gets its own interrupt identity starting from
+ * IMSIC_IPI_EVENT_BASE_ID so that the IPI event is encoded in the
+ * MSI itself. IPI events which don't fit in the interrupt identities
+ * implemented by an IMSIC use IMSIC_IPI_ID and the IPI event bitmask.
+ */
+static u32 imsic_ipi_event_count(const struct imsic_data *imsic)
+{
+	unsigned long count = imsic->num_ids - IMSIC_IPI_EVENT_BASE_ID + 1;
+
+	return (count < SBI_IPI_EVENT_MAX) ? count : SBI_IPI_EVENT_MAX;
+}
 
 int imsic_map_hartid_to_data(u32 hartid, struct imsic_data *imsic, int file)
 {
@@ -120,6 +135,12 @@ static int imsic_external_irqfn(struct sbi_trap_regs *regs)
 			sbi_ipi_process();
 			break;
 		default:
+			if (IMSIC_IPI_EVENT_BASE_ID <= mirq &&
+			    mirq < (IMSIC_IPI_EVENT_BASE_ID + SBI_IPI_EVENT_MAX)) {
+				sbi_ipi_process_event(mirq -
+						      IMSIC_IPI_EVENT_BASE_ID);
+				break;
+			}
 			sbi_printf("%s: unhandled IRQ%d\n",
 				   __func__, (u32)mirq);
 			break;
@@ -129,7 +150,7 @@ static int imsic_external_irqfn(struct sbi_trap_regs *regs)
 	return 0;
 }
 
-static void imsic_ipi_send(u32 target_hart)
+static volatile u32 *imsic_ipi_doorbell(u32 target_hart)
 {
 	unsigned long reloff;
 	struct imsic_regs *regs;
@@ -137,7 +158,7 @@ static void imsic_ipi_send(u32 target_hart)
 	int file = imsic_hartid2file[target_hart];
 
 	if (!data || !data->targets_mmode)
-		return;
+		return NULL;
 
 	regs = &data->regs[0];
 	reloff = file * (1UL << data->guest_index_bits) * IMSIC_MMIO_PAGE_SZ;
@@ -147,13 +168,38 @@ static void imsic_ipi_send(u32 target_hart)
 	}
 
 	if (regs->size && (reloff < regs->size))
-		writel(IMSIC_IPI_ID,
-		       (void *)(regs->addr + reloff + IMSIC_MMIO_PAGE_LE));
+		return (void *)(regs->addr + reloff + IMSIC_MMIO_PAGE_LE);
+
+	return NULL;
+}
+
+static int imsic_ipi_send(u32 target_hart)
+{
+	volatile u32 *doorbell = imsic_ipi_doorbell(target_hart);
+
+	if (!doorbell)
+		return SBI_ENODEV;
+
+	writel(IMSIC_IPI_ID, doorbell);
+	return 0;
+}
+
+static int imsic_ipi_send_event(u32 target_hart, u32 event)
+{
+	volatile u32 *doorbell = imsic_hartid2doorbell[target_hart];
+	struct imsic_data *data = imsic_hartid2data[target_hart];
+
+	if (!doorbell || imsic_ipi_event_count(data) <= event)
+		return SBI_ENOTSUPP;
+
+	writel(IMSIC_IPI_EVENT_BASE_ID + event, doorbell);
+	return 0;
 }
 
 static struct sbi_ipi_device imsic_ipi_device = {
 	.name		= "aia-imsic",
-	.ipi_send	= imsic_ipi_send
+	.ipi_send	= imsic_ipi_send,
+	.ipi_send_event	= imsic_ipi_send_event
 };
 
 static void imsic_local_eix_update(unsigned long base_id,
@@ -183,6 +229,8 @@ static void imsic_local_eix_update(unsigned long base_id,
 
 void imsic_local_irqchip_init(void)
 {
+	struct imsic_data *imsic;
+
 	/*
 	 * This function is expected to be called from:
 	 * 1) nascent_init() platform callback which is called
@@ -200,6 +248,13 @@ void imsic_local_irqchip_init(void)
 
 	/* Enable IPI */
 	imsic_local_eix_update(IMSIC_IPI_ID, 1, false, true);
+
+	/* Enable per-event IPIs */
+	imsic = imsic_get_data(current_hartid());
+	if (imsic)
+		imsic_local_eix_update(IMSIC_IPI_EVENT_BASE_ID,
+				       imsic_ipi_event_count(imsic),
+				       false, true);
 }
 
 int imsic_warm_irqchip_init(void)
@@ -215,6 +270,8 @@ int imsic_warm_irqchip_init(void)
 
 	/* Clear IPI pending */
 	imsic_local_eix_update(IMSIC_IPI_ID, 1, true, false);
+	imsic_local_eix_update(IMSIC_IPI_EVENT_BASE_ID,
+			       imsic_ipi_event_count(imsic), true, false);
 
 	/* Local IMSIC initialization */
 	imsic_local_irqchip_init();
@@ -295,6 +352,7 @@ int imsic_data_check(struct imsic_data *imsic)
 int imsic_cold_irqchip_init(struct imsic_data *imsic)
 {
 	int i, rc;
+	volatile u32 *doorbell;
 	struct sbi_domain_memregion reg;
 
 	/* Sanity checks */
@@ -325,5 +383,16 @@ int imsic_cold_irqchip_init(struct imsic_data *imsic)
 	/* Register IPI device */
 	sbi_ipi_set_device(&imsic_ipi_device);
 
+	/* Setup IPI doorbells of HARTs served by this IMSIC */
+	for (i = 0; i < SBI_HARTMASK_MAX_BITS; i++) {
+		if (imsic_hartid2data[i] != imsic)
+			continue;
+		doorbell = imsic_ipi_doorbell(i);
+		imsic_hartid2doorbell[i] = doorbell;
+		if (doorbell)
+			sbi_ipi_set_doorbell(&imsic_ipi_device, i,
+					     doorbell, IMSIC_IPI_ID);
+	}
+
 	return 0;
 }
@@ -45,8 +45,14 @@ void plic_priority_save(const struct plic_data *plic, u8 *priority, u32 num)
 void plic_priority_restore(const struct plic_data *plic, const u8 *priority,
 			   u32 num)
 {
-	for (u32 i = 1; i <= num; i++)
+	bool skip_zero = (plic->flags & PLIC_FLAG_RESET_ZERO) ? true : false;
+
+	for (u32 i = 1; i <= num; i++) {
+		/* Don't write back registers still holding the reset value */
+		if (skip_zero && !priority[i])
+			continue;
 		plic_set_priority(plic, i, priority[i]);
+	}
 }
 
 static u32 plic_get_thresh(const struct plic_data *plic, u32 cntxid)
@@ -109,12 +115,17 @@ void plic_context_restore(const struct plic_data *plic, int context_id,
 			  const u32 *enable, u32 threshold, u32 num)
 {
 	u32 ie_words = plic->num_src / 32 + 1;
+	bool skip_zero = (plic->flags & PLIC_FLAG_RESET_ZERO) ? true : false;
 
 	if (num > ie_words)
 		num = ie_words;
 
-	for (u32 i = 0; i < num; i++)
+	for (u32 i = 0; i < num; i++) {
+		/* Refer comments in plic_priority_restore() */
+		if (skip_zero && !enable[i])
+			continue;
 		plic_set_ie(plic, context_id, i, enable[i]);
+	}
 
 	plic_set_thresh(plic, context_id, threshold);
 }
@@ -11,6 +11,7 @@
 #include <sbi/sbi_error.h>
 #include <sbi/sbi_scratch.h>
 #include <sbi_utils/fdt/fdt_helper.h>
+#include <sbi_utils/fdt/fdt_index.h>
 #include <sbi_utils/serial/fdt_serial.h>
 
 /* List of FDT serial drivers generated at compile time */
@@ -33,7 +34,7 @@ int fdt_serial_init(void)
 	void *fdt = fdt_get_address();
 
 	/* Find offset of node pointed to by stdout-path */
-	coff = fdt_path_offset(fdt, "/chosen");
+	coff = fdt_index_path_offset(fdt, "/chosen");
 	if (-1 < coff) {
 		prop = fdt_getprop(fdt, coff, "stdout-path", &len);
 		if (prop && len) {
@@ -45,7 +46,7 @@ int fdt_serial_init(void)
 				noff = fdt_path_offset_namelen(fdt, prop,
 							       sep - start);
 			else
-				noff = fdt_path_offset(fdt, prop);
+				noff = fdt_index_path_offset(fdt, prop);
 		}
 	}
 
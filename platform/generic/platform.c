@@ -14,10 +14,13 @@
 #include <sbi/sbi_platform.h>
 #include <sbi/sbi_string.h>
 #include <sbi/sbi_system.h>
+#include <sbi_utils/fdt/fdt_builtin.h>
 #include <sbi_utils/fdt/fdt_domain.h>
 #include <sbi_utils/fdt/fdt_fixup.h>
 #include <sbi_utils/fdt/fdt_helper.h>
+#include <sbi_utils/fdt/fdt_index.h>
 #include <sbi_utils/fdt/fdt_pmu.h>
+#include <sbi_utils/fdt/fdt_rewrite.h>
 #include <sbi_utils/irqchip/fdt_irqchip.h>
 #include <sbi_utils/irqchip/imsic.h>
 #include <sbi_utils/serial/fdt_serial.h>
@@ -77,10 +80,11 @@ unsigned long fw_platform_init(unsigned long arg0, unsigned long arg1,
 {
 	const char *model;
 	void *fdt = (void *)arg1;
-	u32 hartid, hart_count = 0;
+	u32 i, hartid, hart_count = 0, builtin_count;
 	int rc, root_offset, cpus_offset, cpu_offset, len;
+	const u32 *builtin_ids;
 
-	root_offset = fdt_path_offset(fdt, "/");
+	root_offset = fdt_index_path_offset(fdt, "/");
 	if (root_offset < 0)
 		goto fail;
 
@@ -96,7 +100,17 @@ unsigned long fw_platform_init(unsigned long arg0, unsigned long arg1,
 	if (generic_plat && generic_plat->features)
 		platform.features = generic_plat->features(generic_plat_match);
 
-	cpus_offset = fdt_path_offset(fdt, "/cpus");
+	/* HART IDs resolved at build time */
+	if (!fdt_builtin_hart_ids(fdt, &builtin_ids, &builtin_count)) {
+		for (i = 0; i < builtin_count; i++) {
+			if (SBI_HARTMASK_MAX_BITS <= builtin_ids[i])
+				continue;
+			generic_hart_index2id[hart_count++] = builtin_ids[i];
+		}
+		goto hart_done;
+	}
+
+	cpus_offset = fdt_index_path_offset(fdt, "/cpus");
 	if (cpus_offset < 0)
 		goto fail;
 
@@ -114,6 +128,7 @@ unsigned long fw_platform_init(unsigned long arg0, unsigned long arg1,
 		generic_hart_index2id[hart_count++] = hartid;
 	}
 
+hart_done:
 	platform.hart_count = hart_count;
 
 	platform_has_mlevel_imsic = fdt_check_imsic_mlevel(fdt);
@@ -168,9 +183,13 @@ static int generic_final_init(bool cold_boot)
 
 	fdt = fdt_get_address();
 
+	fdt_rewrite_begin(fdt);
 	fdt_cpu_fixup(fdt);
 	fdt_fixups(fdt);
 	fdt_domain_fixup(fdt);
+	rc = fdt_rewrite_end(fdt);
+	if (rc)
+		return rc;
 
 	if (generic_plat && generic_plat->fdt_fixup) {
 		rc = generic_plat->fdt_fixup(fdt, generic_plat_match);
@@ -218,6 +237,45 @@ static int generic_extensions_init(struct sbi_hart_features *hfeatures)
 	return 0;
 }
 
+static unsigned long generic_hart_class(u32 hartid)
+{
+	static const char * const props[] = {
+		"compatible", "riscv,isa", "riscv,isa-base",
+		"riscv,isa-extensions",
+	};
+	void *fdt = fdt_get_address();
+	int i, len, cpus_offset, cpu_offset;
+	unsigned long hash = 0;
+	const u8 *val;
+	u32 fdt_hartid;
+
+	cpus_offset = fdt_index_path_offset(fdt, "/cpus");
+	if (cpus_offset < 0)
+		return 0;
+
+	fdt_for_each_subnode(cpu_offset, fdt, cpus_offset) {
+		if (fdt_parse_hart_id(fdt, cpu_offset, &fdt_hartid) ||
+		    fdt_hartid != hartid)
+			continue;
+
+		/* FNV-1a over the properties describing the HART */
+		for (i = 0; i < array_size(props); i++) {
+			val = fdt_getprop(fdt, cpu_offset, props[i], &len);
+			if (!val || len <= 0)
+				continue;
+			if (!hash)
+				hash = 2166136261UL;
+			while (len--) {
+				hash ^= *val++;
+				hash *= 16777619UL;
+			}
+		}
+		break;
+	}
+
+	return hash;
+}
+
 static int generic_domains_init(void)
 {
 	void *fdt = fdt_get_address();
@@ -227,10 +285,10 @@ static int generic_domains_init(void)
 	if (ret < 0)
 		return ret;
 
-	offset = fdt_path_offset(fdt, "/chosen");
+	offset = fdt_index_path_offset(fdt, "/chosen");
 
 	if (offset >= 0) {
-		offset = fdt_node_offset_by_compatible(fdt, offset,
+		offset = fdt_index_offset_by_compatible(fdt, offset,
 						       "opensbi,domain,config");
 		if (offset >= 0 &&
 		    fdt_get_property(fdt, offset, "system-suspend-test", NULL))
@@ -290,10 +348,13 @@ const struct sbi_platform_operations platform_ops = {
 	.early_exit		= generic_early_exit,
 	.final_exit		= generic_final_exit,
 	.extensions_init	= generic_extensions_init,
+	.hart_class		= generic_hart_class,
 	.domains_init		= generic_domains_init,
 	.console_init		= generic_console_init,
 	.irqchip_init		= fdt_irqchip_init,
 	.irqchip_exit		= fdt_irqchip_exit,
+	.irqchip_suspend	= fdt_irqchip_suspend,
+	.irqchip_resume		= fdt_irqchip_resume,
 	.ipi_init		= fdt_ipi_init,
 	.ipi_exit		= fdt_ipi_exit,
 	.pmu_init		= generic_pmu_init,
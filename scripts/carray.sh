@@ -61,7 +61,13 @@ if [ -z "${ARRAY_NAME}" ]; then
 	usage
 fi
 
-printf "#include <%s>\n\n" "${TYPE_HEADER}"
+MATCH_MEMBER=`cat ${CONFIG_FILE} | awk '{ if ($1 == "MATCH_TABLE:") { printf $2; exit 0; } }'`
+
+printf "#include <%s>\n" "${TYPE_HEADER}"
+if [ ! -z "${MATCH_MEMBER}" ]; then
+	printf "#include <sbi_utils/fdt/fdt_helper.h>\n"
+fi
+printf "\n"
 
 for VAR in ${VAR_LIST}; do
 	printf "extern %s %s;\n" "${TYPE_NAME}" "${VAR}"
@@ -75,3 +81,20 @@ done
 printf "};\n\n"
 
 printf "unsigned long %s_size = sizeof(%s) / sizeof(%s *);\n" "${ARRAY_NAME}" "${ARRAY_NAME}" "${TYPE_NAME}"
+
+if [ -z "${MATCH_MEMBER}" ]; then
+	exit 0
+fi
+
+printf "\nstatic const struct fdt_match *const *const %s_match_tables[] = {\n" "${ARRAY_NAME}"
+for VAR in ${VAR_LIST}; do
+	printf "\t&%s.%s,\n" "${VAR}" "${MATCH_MEMBER}"
+done
+printf "};\n\n"
+
+printf "const struct fdt_driver_class %s_class = {\n" "${ARRAY_NAME}"
+printf "\t.name = \"%s\",\n" "${ARRAY_NAME}"
+printf "\t.match_tables = %s_match_tables,\n" "${ARRAY_NAME}"
+printf "\t.match_tables_size = sizeof(%s_match_tables) /\n" "${ARRAY_NAME}"
+printf "\t\t\t     sizeof(%s_match_tables[0]),\n" "${ARRAY_NAME}"
+printf "};\n"
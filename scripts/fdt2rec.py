@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+#
+# SPDX-License-Identifier: BSD-2-Clause
+#
+# Generate pre-resolved records of a device tree blob as C source so
+# that the firmware does not have to parse the same device tree on every
+# cold boot (see lib/utils/fdt/fdt_builtin.c).
+#
+# The parsing done here mirrors fw_platform_init() of the generic
+# platform and fdt_get_node_addr_size(). Nodes which can't be resolved
+# exactly the same way are left out and get parsed at runtime.
+#
+
+import argparse
+import struct
+import sys
+
+FDT_MAGIC = 0xd00dfeed
+FDT_BEGIN_NODE = 1
+FDT_END_NODE = 2
+FDT_PROP = 3
+FDT_NOP = 4
+FDT_END = 9
+FDT_MAX_NCELLS = 4
+U64_MASK = (1 << 64) - 1
+
+
+class Node:
+    def __init__(self, offset, name, parent):
+        self.offset = offset
+        self.name = name
+        self.parent = parent
+        self.props = {}
+        self.children = []
+
+
+def parse_fdt(blob):
+    (magic, totalsize, off_struct, off_strings, _, _, _, _,
+     size_strings, size_struct) = struct.unpack_from(">10I", blob, 0)
+    if magic != FDT_MAGIC:
+        sys.exit("fdt2rec: bad device tree magic")
+
+    strings = blob[off_strings:off_strings + size_strings]
+    dt = blob[off_struct:off_struct + size_struct]
+    root = None
+    node = None
+    pos = 0
+    while pos < len(dt):
+        tag_off = pos
+        (tag,) = struct.unpack_from(">I", dt, pos)
+        pos += 4
+        if tag == FDT_BEGIN_NODE:
+            end = dt.index(b"\0", pos)
+            name = dt[pos:end].decode()
+            pos = (end + 1 + 3) & ~3
+            child = Node(tag_off, name, node)
+            if node:
+                node.children.append(child)
+            else:
+                root = child
+            node = child
+        elif tag == FDT_END_NODE:
+            node = node.parent
+        elif tag == FDT_PROP:
+            (plen, nameoff) = struct.unpack_from(">II", dt, pos)
+            pos += 8
+            pname = strings[nameoff:strings.index(b"\0", nameoff)].decode()
+            # Like fdt_getprop(), the first property of a name wins
+            node.props.setdefault(pname, dt[pos:pos + plen])
+            pos = (pos + plen + 3) & ~3
+        elif tag == FDT_NOP:
+            continue
+        elif tag == FDT_END:
+            break
+        else:
+            sys.exit("fdt2rec: bad device tree structure")
+
+    return totalsize, root
+
+
+def cells(node, name, default):
+    val = node.props.get(name)
+    if val is None:
+        return default
+    if len(val) != 4:
+        return -1
+    (val,) = struct.unpack(">I", val)
+    return val if val <= FDT_MAX_NCELLS else -1
+
+
+def address_cells(node):
+    val = cells(node, "#address-cells", 2)
+    return val if val != 0 else -1
+
+
+def size_cells(node):
+    return cells(node, "#size-cells", 1)
+
+
+def read_cells(data, start, count):
+    val = 0
+    for i in range(count):
+        (c,) = struct.unpack_from(">I", data, (start + i) * 4)
+        val = ((val << 32) | c) & U64_MASK
+    return val
+
+
+def translate(reg, parent):
+    ca = address_cells(parent)
+    cs = size_cells(parent)
+    if ca < 1 or cs < 0:
+        return None
+    ranges = parent.props.get("ranges")
+    if not ranges:
+        return reg
+    if len(ranges) < (2 * ca + cs) * 4:
+        return None
+    caddr = read_cells(ranges, 0, ca)
+    paddr = read_cells(ranges, ca, ca)
+    rsize = read_cells(ranges, 2 * ca, cs)
+    if reg < caddr or caddr >= ((reg + rsize) & U64_MASK):
+        return None
+    return (paddr + reg - caddr) & U64_MASK
+
+
+def node_regs(node):
+    parent = node.parent
+    reg = node.props.get("reg")
+    if parent is None or reg is None:
+        return []
+    ca = address_cells(parent)
+    cs = size_cells(parent)
+    if ca < 1 or cs < 0:
+        return []
+
+    regs = []
+    for index in range((len(reg) // 4) // (ca + cs)):
+        addr = read_cells(reg, index * (ca + cs), ca)
+        p = parent
+        while p is not None and addr is not None:
+            addr = translate(addr, p)
+            p = p.parent
+        if addr is None:
+            return []
+        size = read_cells(reg, index * (ca + cs) + ca, cs)
+        regs.append((node.offset, index, addr, size))
+
+    return regs
+
+
+def walk(node):
+    yield node
+    for child in node.children:
+        yield from walk(child)
+
+
+def hart_ids(root):
+    cpus = None
+    for child in root.children:
+        if child.name == "cpus" or child.name.startswith("cpus@"):
+            cpus = child
+            break
+    if cpus is None:
+        return None
+
+    ids = []
+    for cpu in cpus.children:
+        dtype = cpu.props.get("device_type")
+        reg = cpu.props.get("reg")
+        if not dtype or not dtype.startswith(b"cpu"):
+            continue
+        if reg is None or len(reg) < 4:
+            continue
+        status = cpu.props.get("status")
+        if status is not None and not status.startswith(b"ok"):
+            continue
+        ids.append(read_cells(reg, 1 if len(reg) > 4 else 0, 1))
+
+    return ids
+
+
+def checksum(blob):
+    # FNV-1a, must match fdt_builtin_checksum()
+    val = 2166136261
+    for b in blob:
+        val = ((val ^ b) * 16777619) & 0xffffffff
+    return val
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-i", "--input", required=True,
+                        help="Input device tree blob")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        blob = f.read()
+    totalsize, root = parse_fdt(blob)
+    blob = blob[:totalsize]
+
+    ids = hart_ids(root)
+    regs = []
+    for node in walk(root):
+        regs += node_regs(node)
+    regs.sort()
+
+    print("/* Generated by scripts/fdt2rec.py, do not edit */\n")
+    print("#include <sbi_utils/fdt/fdt_builtin.h>\n")
+    print("static const u32 builtin_hart_ids[] = {")
+    for hartid in ids or []:
+        print("\t%d," % hartid)
+    print("};\n")
+    print("static const struct fdt_builtin_reg builtin_regs[] = {")
+    for (offset, index, addr, size) in regs:
+        print("\t{ .node = %d, .index = %d," % (offset, index))
+        print("\t  .addr = 0x%xULL, .size = 0x%xULL }," % (addr, size))
+    print("};\n")
+    print("const struct fdt_builtin_records fdt_builtin_records = {")
+    print("\t.totalsize = %d," % totalsize)
+    print("\t.checksum = 0x%08x," % checksum(blob))
+    print("\t.hart_ids = builtin_hart_ids,")
+    print("\t.hart_count = %d," % (len(ids) if ids is not None else -1))
+    print("\t.regs = builtin_regs,")
+    print("\t.reg_count = %d," % len(regs))
+    print("};")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,153 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Host test of the FDT lookup index
+ *
+ * A device tree is indexed, copied elsewhere the way the firmware
+ * relocates it, and looked-up through the copy. The lookups must be
+ * served by the index and must match the libfdt functions. Built and
+ * run on the build host by scripts/fdt_index_test.sh.
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#include <libfdt.h>
+#include <sbi/sbi_error.h>
+#include <sbi_utils/fdt/fdt_helper.h>
+#include <sbi_utils/fdt/fdt_index.h>
+
+/* The host libc headers clash with the firmware ones */
+int printf(const char *format, ...);
+int snprintf(char *str, unsigned long size, const char *format, ...);
+
+#define TEST_FDT_SIZE		(64 * 1024)
+#define TEST_NODES		64
+
+static const struct fdt_match test_match[] = {
+	{ .compatible = "test,other" },
+	{ .compatible = "test,dev" },
+	{ },
+};
+
+static const struct fdt_match *const test_match_ptr = test_match;
+static const struct fdt_match *const *const test_match_tables[] = {
+	&test_match_ptr,
+};
+
+static const struct fdt_driver_class test_class = {
+	.name = "test",
+	.match_tables = test_match_tables,
+	.match_tables_size = 1,
+};
+
+const struct fdt_driver_class *fdt_driver_classes[] = { &test_class };
+unsigned long fdt_driver_classes_size = 1;
+
+static int test_failed;
+
+#define TEST_CHECK(cond)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("%s:%d: check failed: %s\n",		\
+			       __FILE__, __LINE__, #cond);		\
+			test_failed = 1;				\
+		}							\
+	} while (0)
+
+static void test_create(void *fdt, int nodes, const char *compat)
+{
+	char name[32];
+	int i;
+
+	fdt_create(fdt, TEST_FDT_SIZE);
+	fdt_finish_reservemap(fdt);
+	fdt_begin_node(fdt, "");
+	fdt_property_string(fdt, "compatible", "test,root");
+	fdt_begin_node(fdt, "chosen");
+	fdt_end_node(fdt);
+	fdt_begin_node(fdt, "cpus");
+	fdt_end_node(fdt);
+	for (i = 0; i < nodes; i++) {
+		snprintf(name, sizeof(name), "dev@%x", i);
+		fdt_begin_node(fdt, name);
+		if (i % 3)
+			fdt_property_string(fdt, "compatible", compat);
+		else
+			fdt_property(fdt, "compatible",
+				     "test,other\0test,dev", 21);
+		fdt_property_u32(fdt, "phandle", i + 1);
+		fdt_end_node(fdt);
+	}
+	fdt_end_node(fdt);
+	fdt_finish(fdt);
+}
+
+static void test_lookups(const void *fdt, int nodes)
+{
+	const struct fdt_match *match;
+	const char *paths[] = { "/", "/chosen", "/cpus" };
+	int i, off, ref, count;
+
+	/* The match table lookup is only served by the index */
+	count = 0;
+	off = -1;
+	ref = -1;
+	for (;;) {
+		off = fdt_index_find_match(fdt, off, test_match, &match);
+		TEST_CHECK(off != SBI_ENOSYS);
+		if (off < 0)
+			break;
+		ref = fdt_node_offset_by_compatible(fdt, ref, "test,dev");
+		TEST_CHECK(off == ref);
+		TEST_CHECK(match == &test_match[(count % 3) ? 1 : 0]);
+		count++;
+	}
+	TEST_CHECK(count == nodes);
+
+	off = ref = -1;
+	do {
+		off = fdt_index_offset_by_compatible(fdt, off, "test,other");
+		ref = fdt_node_offset_by_compatible(fdt, ref, "test,other");
+		TEST_CHECK(off == ref);
+	} while (off >= 0);
+
+	for (i = 1; i <= nodes + 1; i++)
+		TEST_CHECK(fdt_index_offset_by_phandle(fdt, i) ==
+			   fdt_node_offset_by_phandle(fdt, i));
+
+	for (i = 0; i < sizeof(paths) / sizeof(paths[0]); i++)
+		TEST_CHECK(fdt_index_path_offset(fdt, paths[i]) ==
+			   fdt_path_offset(fdt, paths[i]));
+}
+
+static u64 test_boot[TEST_FDT_SIZE / sizeof(u64)];
+static u64 test_reloc[TEST_FDT_SIZE / sizeof(u64)];
+static u64 test_other[TEST_FDT_SIZE / sizeof(u64)];
+
+int main(void)
+{
+	void *boot = test_boot, *reloc = test_reloc, *other = test_other;
+
+	/* Lookups done by the platform on the boot-time device tree */
+	test_create(boot, TEST_NODES, "test,dev");
+	test_lookups(boot, TEST_NODES);
+
+	/* Relocated copy, the original left in place */
+	fdt_move(boot, reloc, TEST_FDT_SIZE);
+	test_lookups(reloc, TEST_NODES);
+
+	/* Relocated copy, the original overwritten afterwards */
+	fdt_move(reloc, boot, TEST_FDT_SIZE);
+	sbi_memset(reloc, 0, TEST_FDT_SIZE);
+	test_lookups(boot, TEST_NODES);
+
+	/* A different device tree must not be served by the old index */
+	test_create(other, TEST_NODES / 2, "test,dev");
+	test_lookups(other, TEST_NODES / 2);
+
+	printf("fdt index test: %s\n", test_failed ? "FAILED" : "passed");
+	return test_failed;
+}
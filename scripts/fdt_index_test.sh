@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+
+function usage()
+{
+	echo "Usage:"
+	echo " $0 [options]"
+	echo "Options:"
+	echo "     -h                   Display help or usage"
+	echo "     -c <host_cc>         Host C compiler (Optional)"
+	exit 1;
+}
+
+# Command line options
+HOST_CC="${HOSTCC:-cc}"
+
+while getopts "hc:" o; do
+	case "${o}" in
+	h)
+		usage
+		;;
+	c)
+		HOST_CC=${OPTARG}
+		;;
+	*)
+		usage
+		;;
+	esac
+done
+
+SRC_DIR=$(cd "$(dirname "$0")/.." && pwd)
+BUILD_DIR=$(mktemp -d)
+trap 'rm -rf "${BUILD_DIR}"' EXIT
+
+SOURCES="${SRC_DIR}/scripts/fdt_index_test.c
+	 ${SRC_DIR}/lib/utils/fdt/fdt_index.c
+	 ${SRC_DIR}/lib/utils/libfdt/fdt.c
+	 ${SRC_DIR}/lib/utils/libfdt/fdt_ro.c
+	 ${SRC_DIR}/lib/utils/libfdt/fdt_sw.c
+	 ${SRC_DIR}/lib/sbi/sbi_string.c"
+
+CFLAGS="-O2 -fno-builtin -fno-strict-aliasing -DCONFIG_FDT_INDEX"
+CFLAGS="${CFLAGS} -I${SRC_DIR}/include -I${SRC_DIR}/lib/utils/libfdt"
+CFLAGS="${CFLAGS} -D__riscv_xlen=64"
+
+${HOST_CC} ${CFLAGS} -o "${BUILD_DIR}/fdt_index_test" ${SOURCES} || exit 1
+"${BUILD_DIR}/fdt_index_test" || exit 1
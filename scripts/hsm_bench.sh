@@ -0,0 +1,68 @@
+#!/usr/bin/env bash
+
+function usage()
+{
+	echo "Usage:"
+	echo " $0 [options]"
+	echo "Options:"
+	echo "     -h                   Display help or usage"
+	echo "     -b <build_dir>       Build directory of the generic platform"
+	echo "     -x <xlen>            RISC-V XLEN of the build (Optional)"
+	echo "     -n <harts_list>      Space separated HART counts (Optional)"
+	echo "     -t <seconds>         Timeout of each run (Optional)"
+	exit 1;
+}
+
+# Command line options
+BUILD_DIR=""
+XLEN="64"
+HARTS_LIST="2 4 8 16 32"
+TIMEOUT="300"
+
+while getopts "hb:x:n:t:" o; do
+	case "${o}" in
+	h)
+		usage
+		;;
+	b)
+		BUILD_DIR=${OPTARG}
+		;;
+	x)
+		XLEN=${OPTARG}
+		;;
+	n)
+		HARTS_LIST=${OPTARG}
+		;;
+	t)
+		TIMEOUT=${OPTARG}
+		;;
+	*)
+		usage
+		;;
+	esac
+done
+
+if [ -z "${BUILD_DIR}" ]; then
+	echo "Must specify build directory"
+	usage
+fi
+
+FW_DIR="${BUILD_DIR}/platform/generic/firmware"
+
+# QEMU virt has a 10 MHz timer so 10 ticks are one microsecond
+printf "%8s %14s %14s\n" "harts" "single (us)" "many (us)"
+for HARTS in ${HARTS_LIST}; do
+	# The payload is linked at the jump address of fw_jump
+	RESULT=$(timeout "${TIMEOUT}" "qemu-system-riscv${XLEN}" -M virt \
+		 -m 256M -smp "${HARTS}" -nographic \
+		 -bios "${FW_DIR}/fw_jump.bin" \
+		 -kernel "${FW_DIR}/payloads/hsm_bench.elf" | tr -d '\r' | \
+		 grep "^hsm bench: ")
+	if [ -z "${RESULT}" ]; then
+		echo "FAILED: no result with ${HARTS} HARTs"
+		exit 1
+	fi
+
+	set -- ${RESULT}
+	printf "%8s %14s %14s\n" "${HARTS}" "$(($6 / 10))" "$(($9 / 10))"
+done
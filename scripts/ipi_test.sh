@@ -0,0 +1,69 @@
+#!/usr/bin/env bash
+
+function usage()
+{
+	echo "Usage:"
+	echo " $0 [options]"
+	echo "Options:"
+	echo "     -h                   Display help or usage"
+	echo "     -b <build_dir>       Build directory of the generic platform"
+	echo "     -x <xlen>            RISC-V XLEN of the build (Optional)"
+	echo "     -n <harts>           Number of HARTs (Optional)"
+	echo "     -t <seconds>         Timeout (Optional)"
+	exit 1;
+}
+
+# Command line options
+BUILD_DIR=""
+XLEN="64"
+HARTS="8"
+TIMEOUT="300"
+
+while getopts "hb:x:n:t:" o; do
+	case "${o}" in
+	h)
+		usage
+		;;
+	b)
+		BUILD_DIR=${OPTARG}
+		;;
+	x)
+		XLEN=${OPTARG}
+		;;
+	n)
+		HARTS=${OPTARG}
+		;;
+	t)
+		TIMEOUT=${OPTARG}
+		;;
+	*)
+		usage
+		;;
+	esac
+done
+
+if [ -z "${BUILD_DIR}" ]; then
+	echo "Must specify build directory"
+	usage
+fi
+
+FW_DIR="${BUILD_DIR}/platform/generic/firmware"
+LOG=$(mktemp)
+trap 'rm -f "${LOG}"' EXIT
+
+# The payload is linked at the jump address of fw_jump
+timeout "${TIMEOUT}" "qemu-system-riscv${XLEN}" -M virt -m 256M \
+	-smp "${HARTS}" -nographic -bios "${FW_DIR}/fw_jump.bin" \
+	-kernel "${FW_DIR}/payloads/ipi_test.elf" > "${LOG}"
+if [ $? -ne 0 ]; then
+	echo "FAILED: QEMU did not shut down (hang or timeout)"
+	exit 1
+fi
+
+# Lost wakeups are reported by the HART missing the IPI
+tr -d '\r' < "${LOG}" | grep "^ipi test: "
+if ! tr -d '\r' < "${LOG}" | \
+     grep -q "^ipi test: 0*${HARTS} harts [0-9]* rounds passed$"; then
+	echo "FAILED: not all IPIs were delivered to all ${HARTS} HARTs"
+	exit 1
+fi
@@ -0,0 +1,87 @@
+#!/usr/bin/env bash
+
+function usage()
+{
+	echo "Usage:"
+	echo " $0 [options]"
+	echo "Options:"
+	echo "     -h                   Display help or usage"
+	echo "     -b <build_dir>       Build directory of the generic platform"
+	echo "     -x <xlen>            RISC-V XLEN of the build (Optional)"
+	echo "     -n <harts_list>      Space separated HART counts (Optional)"
+	echo "     -t <seconds>         Timeout of each run (Optional)"
+	exit 1;
+}
+
+# Command line options
+BUILD_DIR=""
+XLEN="64"
+HARTS_LIST="8"
+TIMEOUT="300"
+
+while getopts "hb:x:n:t:" o; do
+	case "${o}" in
+	h)
+		usage
+		;;
+	b)
+		BUILD_DIR=${OPTARG}
+		;;
+	x)
+		XLEN=${OPTARG}
+		;;
+	n)
+		HARTS_LIST=${OPTARG}
+		;;
+	t)
+		TIMEOUT=${OPTARG}
+		;;
+	*)
+		usage
+		;;
+	esac
+done
+
+if [ -z "${BUILD_DIR}" ]; then
+	echo "Must specify build directory"
+	usage
+fi
+
+FW_DIR="${BUILD_DIR}/platform/generic/firmware"
+LOG=$(mktemp)
+trap 'rm -f "${LOG}"' EXIT
+
+LINE="^lock test: hart [0-9]* line [0-9]* abcdefghijklmnopqrstuvwxyz$"
+RESULT="^lock test: [0-9]* harts done [0-9]* rounds [0-9]* ticks$"
+
+# QEMU virt has a 10 MHz timer so 10 ticks are one microsecond
+printf "%8s %14s %18s\n" "harts" "total (us)" "per lock (ns)"
+for HARTS in ${HARTS_LIST}; do
+	# The payload is linked at the jump address of fw_jump
+	timeout "${TIMEOUT}" "qemu-system-riscv${XLEN}" -M virt -m 256M \
+		-smp "${HARTS}" -nographic -bios "${FW_DIR}/fw_jump.bin" \
+		-kernel "${FW_DIR}/payloads/lock_test.elf" > "${LOG}"
+	if [ $? -ne 0 ]; then
+		echo "FAILED: QEMU did not shut down with ${HARTS} HARTs" \
+		     "(hang or timeout)"
+		exit 1
+	fi
+
+	# Every line must be written in one piece while holding the lock
+	LINES=$(tr -d '\r' < "${LOG}" | grep -c "${LINE}")
+	BROKEN=$(tr -d '\r' < "${LOG}" | grep "lock test" | \
+		 grep -v -c -e "${LINE}" -e "${RESULT}")
+	DONE=$(tr -d '\r' < "${LOG}" | grep "${RESULT}")
+
+	if [ -z "${DONE}" ] || [ "${BROKEN}" -ne 0 ] || \
+	   [ "${LINES}" -ne $((${HARTS} * 500)) ]; then
+		echo "FAILED: ${LINES} intact lines, ${BROKEN} broken lines" \
+		     "with ${HARTS} HARTs"
+		exit 1
+	fi
+
+	# Each round of each HART takes the console lock once
+	set -- ${DONE}
+	printf "%8s %14s %18s\n" "${HARTS}" "$(($8 / 10))" \
+	       "$(($8 * 100 / ($3 * $6)))"
+done
@@ -0,0 +1,284 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Randomized host test of the PMP planner
+ *
+ * Random domains are planned with sbi_hart_pmp_plan() and the access
+ * permissions of the planned PMP entries are compared against the
+ * first-match semantics of the domain memory regions. Built and run on
+ * the build host by scripts/pmp_plan_test.sh.
+ *
+ * Copyright (c) 2026 OpenSBI Contributors
+ *
+ * Authors:
+ *   agent <agent@local>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sbi/riscv_encoding.h>
+#include <sbi/sbi_domain.h>
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_hart_pmp.h>
+
+#define TEST_MAX_REGIONS	80
+#define TEST_WINDOW_ORDER	20
+#define TEST_PROT_MASK		(PMP_L | PMP_R | PMP_W | PMP_X)
+
+/* Stubs of firmware functions not needed by the planner itself */
+int sbi_printf(const char *format, ...)
+{
+	return 0;
+}
+
+unsigned long csr_read_num(int csr_num)
+{
+	return 0;
+}
+
+void csr_write_num(int csr_num, unsigned long val)
+{
+}
+
+static unsigned long test_rand(void)
+{
+	unsigned long val = 0;
+	unsigned int i;
+
+	for (i = 0; i < sizeof(val); i++)
+		val = (val << 8) | (rand() & 0xff);
+
+	return val;
+}
+
+static void test_region(struct sbi_domain_memregion *reg)
+{
+	unsigned long order, window;
+
+	switch (rand() % 16) {
+	case 0:
+		/* Whole address space */
+		order = __riscv_xlen;
+		reg->base = 0;
+		break;
+	case 1:
+		/* Large region somewhere in the address space */
+		order = TEST_WINDOW_ORDER + rand() % (__riscv_xlen -
+						      TEST_WINDOW_ORDER);
+		reg->base = test_rand() & ~((1UL << order) - 1);
+		break;
+	default:
+		/* Small regions in a window so that they overlap often */
+		order = PMP_SHIFT + rand() % (TEST_WINDOW_ORDER - PMP_SHIFT);
+		window = (1UL << TEST_WINDOW_ORDER) - 1;
+		reg->base = test_rand() & window & ~((1UL << order) - 1);
+		break;
+	}
+	reg->order = order;
+
+	reg->flags = 0;
+	if (rand() & 1)
+		reg->flags |= SBI_DOMAIN_MEMREGION_SU_READABLE;
+	if (rand() & 1)
+		reg->flags |= SBI_DOMAIN_MEMREGION_SU_WRITABLE;
+	if (rand() & 1)
+		reg->flags |= SBI_DOMAIN_MEMREGION_SU_EXECUTABLE;
+	if (!(rand() % 4))
+		reg->flags |= SBI_DOMAIN_MEMREGION_ENF_PERMISSIONS;
+}
+
+static bool test_region_match(const struct sbi_domain_memregion *reg,
+			      unsigned long addr)
+{
+	if (reg->order >= __riscv_xlen)
+		return true;
+
+	return ((addr ^ reg->base) >> reg->order) ? false : true;
+}
+
+/* Permissions of the first matching memory region */
+static int test_expected(const struct sbi_domain_memregion *regs,
+			 unsigned long addr)
+{
+	const struct sbi_domain_memregion *reg;
+	int prot = 0;
+
+	for (reg = regs; reg->order; reg++) {
+		if (!test_region_match(reg, addr))
+			continue;
+		if (reg->flags & SBI_DOMAIN_MEMREGION_ENF_PERMISSIONS)
+			prot |= PMP_L;
+		if (reg->flags & SBI_DOMAIN_MEMREGION_SU_READABLE)
+			prot |= PMP_R;
+		if (reg->flags & SBI_DOMAIN_MEMREGION_SU_WRITABLE)
+			prot |= PMP_W;
+		if (reg->flags & SBI_DOMAIN_MEMREGION_SU_EXECUTABLE)
+			prot |= PMP_X;
+		return prot;
+	}
+
+	return 0;
+}
+
+/* Permissions of the first matching PMP entry or -1 if none matches */
+static int test_pmp(const struct sbi_hart_pmp_plan *plan,
+		    unsigned long addr)
+{
+	unsigned long word = addr >> PMP_SHIFT, pmpaddr, ones, bottom = 0;
+	unsigned int i;
+	bool match;
+
+	for (i = 0; i < plan->count; i++) {
+		pmpaddr = plan->addr[i];
+		switch (plan->cfg[i] & PMP_A) {
+		case PMP_A_TOR:
+			match = (bottom <= word && word < pmpaddr);
+			break;
+		case PMP_A_NA4:
+			match = (word == pmpaddr);
+			break;
+		case PMP_A_NAPOT:
+			ones = __builtin_ctzl(~pmpaddr | (1UL << (__riscv_xlen - 1)));
+			if (pmpaddr == -1UL || __riscv_xlen - 2 <= ones)
+				match = true;
+			else
+				match = !((word ^ pmpaddr) >> (ones + 1));
+			break;
+		default:
+			match = false;
+			break;
+		}
+		bottom = pmpaddr;
+		if (match)
+			return plan->cfg[i] & TEST_PROT_MASK;
+	}
+
+	return -1;
+}
+
+static int test_one(unsigned long iter, const struct sbi_domain *dom,
+		    unsigned int pmp_count)
+{
+	static const unsigned long deltas[] = { -1UL, 0, 1, 4 };
+	const struct sbi_domain_memregion *reg;
+	struct sbi_hart_pmp_plan plan;
+	unsigned long addr, last;
+	unsigned int i, j;
+	int rc, exp, got;
+
+	rc = sbi_hart_pmp_plan(dom, pmp_count, 1UL << PMP_SHIFT,
+			       __riscv_xlen, &plan);
+	if (rc && rc != SBI_ENOSPC) {
+		printf("iter %lu: plan failed (error %d)\n", iter, rc);
+		return 1;
+	}
+	if (pmp_count < plan.count || plan.needed < plan.count ||
+	    (!rc && plan.needed != plan.count)) {
+		printf("iter %lu: bad plan (count %u needed %u limit %u)\n",
+		       iter, plan.count, plan.needed, pmp_count);
+		return 1;
+	}
+
+	/* Probe around the edges of every region and some random addresses */
+	for (reg = dom->regions, i = 0; reg->order || i < 64; ) {
+		if (reg->order) {
+			last = (reg->order < __riscv_xlen) ?
+			       reg->base + (1UL << reg->order) - 1 : -1UL;
+			addr = (i & 1) ? last : reg->base;
+			addr += deltas[(i >> 1) % 4];
+			if (++i == 8) {
+				i = 0;
+				reg++;
+			}
+		} else {
+			addr = (i & 1) ? test_rand() :
+			       test_rand() & ((1UL << TEST_WINDOW_ORDER) - 1);
+			i++;
+		}
+
+		for (j = 0; j < 2; j++) {
+			addr &= ~((1UL << PMP_SHIFT) - 1);
+			exp = test_expected(dom->regions, addr);
+			got = test_pmp(&plan, addr);
+
+			/* A partial plan must be correct where it matches */
+			if (rc && got < 0)
+				continue;
+			if (got < 0)
+				got = 0;
+			if (exp != got) {
+				printf("iter %lu: address 0x%lx expected "
+				       "prot 0x%x got 0x%x (limit %u)\n",
+				       iter, addr, exp, got, pmp_count);
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/* Many adjacent regions with the same permissions take one TOR pair */
+static int test_merge(struct sbi_domain *dom,
+		      struct sbi_domain_memregion *regs)
+{
+	struct sbi_hart_pmp_plan plan;
+	unsigned int i;
+	int rc;
+
+	for (i = 0; i < TEST_MAX_REGIONS; i++) {
+		regs[i].order = 12;
+		regs[i].base = (1UL << 24) + (i << 12);
+		regs[i].flags = SBI_DOMAIN_MEMREGION_SU_READABLE;
+	}
+	memset(&regs[i], 0, sizeof(regs[i]));
+
+	rc = sbi_hart_pmp_plan(dom, 8, 1UL << PMP_SHIFT, __riscv_xlen, &plan);
+	if (rc || plan.count != 2 || plan.unmerged) {
+		printf("merge: %u regions need %u PMP entries (error %d)\n",
+		       TEST_MAX_REGIONS, plan.needed, rc);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct sbi_domain_memregion regs[TEST_MAX_REGIONS + 1];
+	static const unsigned int limits[] = { PMP_COUNT, 16, 8 };
+	unsigned long iter, iters = 100000;
+	struct sbi_domain dom;
+	unsigned int i, n;
+	int fail = 0;
+
+	if (1 < argc)
+		iters = strtoul(argv[1], NULL, 0);
+	srand((2 < argc) ? strtoul(argv[2], NULL, 0) : 1);
+
+	memset(&dom, 0, sizeof(dom));
+	strcpy(dom.name, "test");
+	dom.regions = regs;
+
+	fail = test_merge(&dom, regs);
+
+	for (iter = 0; iter < iters && !fail; iter++) {
+		n = 1 + rand() % TEST_MAX_REGIONS;
+		for (i = 0; i < n; i++)
+			test_region(&regs[i]);
+		memset(&regs[n], 0, sizeof(regs[n]));
+
+		for (i = 0; i < sizeof(limits) / sizeof(limits[0]); i++) {
+			fail = test_one(iter, &dom, limits[i]);
+			if (fail)
+				break;
+		}
+	}
+
+	printf("%s: %lu iterations, %s\n", argv[0], iter,
+	       fail ? "FAILED" : "passed");
+
+	return fail;
+}
@@ -0,0 +1,68 @@
+#!/usr/bin/env bash
+
+function usage()
+{
+	echo "Usage:"
+	echo " $0 [options]"
+	echo "Options:"
+	echo "     -h                   Display help or usage"
+	echo "     -n <iterations>      Number of random domains (Optional)"
+	echo "     -s <seed>            Random seed (Optional)"
+	echo "     -c <host_cc>         Host C compiler (Optional)"
+	exit 1;
+}
+
+# Command line options
+ITERATIONS="100000"
+SEED="1"
+HOST_CC="${HOSTCC:-cc}"
+
+while getopts "hn:s:c:" o; do
+	case "${o}" in
+	h)
+		usage
+		;;
+	n)
+		ITERATIONS=${OPTARG}
+		;;
+	s)
+		SEED=${OPTARG}
+		;;
+	c)
+		HOST_CC=${OPTARG}
+		;;
+	*)
+		usage
+		;;
+	esac
+done
+
+SRC_DIR=$(cd "$(dirname "$0")/.." && pwd)
+BUILD_DIR=$(mktemp -d)
+trap 'rm -rf "${BUILD_DIR}"' EXIT
+
+SOURCES="${SRC_DIR}/scripts/pmp_plan_test.c
+	 ${SRC_DIR}/lib/sbi/sbi_hart_pmp.c
+	 ${SRC_DIR}/lib/sbi/sbi_math.c
+	 ${SRC_DIR}/lib/sbi/sbi_string.c"
+
+# Test the planner for RV64 and, if the host can build it, for RV32
+for XLEN in 64 32; do
+	CFLAGS="-O2 -fno-builtin -fno-strict-aliasing -I${SRC_DIR}/include"
+	CFLAGS="${CFLAGS} -D__riscv_xlen=${XLEN}"
+	if [ "${XLEN}" = "32" ]; then
+		CFLAGS="${CFLAGS} -m32"
+	fi
+
+	if ! ${HOST_CC} ${CFLAGS} -o "${BUILD_DIR}/pmp_plan_test${XLEN}" \
+	     ${SOURCES} 2>/dev/null; then
+		if [ "${XLEN}" = "32" ]; then
+			echo "Skipping RV32: host compiler can't build -m32"
+			continue
+		fi
+		${HOST_CC} ${CFLAGS} -o "${BUILD_DIR}/pmp_plan_test${XLEN}" \
+			${SOURCES} || exit 1
+	fi
+
+	"${BUILD_DIR}/pmp_plan_test${XLEN}" "${ITERATIONS}" "${SEED}" || exit 1
+done